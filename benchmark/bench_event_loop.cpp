@@ -14,6 +14,8 @@
  *                    [--duration 3] [--warmup 1] [--port 19300]
  *                    [--ktls]            # enable KTLS for "ktls" rows
  *                    [--cert path] [--key path]
+ *                    [--scaling [max]]   # sharded epoll tcp, 1..max shards
+ *                    [--storm]           # tcp connection storm: new conn/s
  */
 
 #include "hope-io/net/event_loop.h"
@@ -23,10 +25,12 @@
 #include "hope-io/net/tls/tcp_tls_stream.h"
 #include "hope-io/net/linux/event_loop_impl.h"
 #include "hope-io/net/linux/tls_event_loop_impl.h"
+#include "hope-io/net/linux/sharded_event_loop.h"
 #include "hope-io/net/uring/uring_tcp_event_loop.h"
 #include "hope-io/net/uring/uring_tls_event_loop.h"
 #include "hope-io/net/init.h"
 #include "hope-io/net/tls/tls_init.h"
+#include "hope-io/net/tls/ktls_enable.h"
 #include "hope-io/coredefs.h"
 
 #include <cstdio>
@@ -70,6 +74,8 @@ struct bench_config {
     int         warmup_s    = 1;
     int         port        = 19300;
     int         num_threads = 4;
+    int         max_shards  = 0;    // > 0 runs the shard scaling table
+    bool        storm       = false; // connection storm table
     bool        ktls_enable = false;
     std::string cert_path;
     std::string key_path;
@@ -83,6 +89,8 @@ struct bench_run {
     const char* label;
     const char* mode;   // "tcp", "tls", "ktls"
     el_backend  backend;
+    bool        multishot = false; // io_uring tcp: multishot accept/recv + provided buffer ring
+    bool        fixed = false;     // io_uring tcp: registered file slots + registered buffers
 };
 
 static constexpr bench_run ALL_RUNS[] = {
@@ -90,6 +98,8 @@ static constexpr bench_run ALL_RUNS[] = {
     { "epoll tls",    "tls",  el_backend::epoll    },
     { "epoll ktls",   "ktls", el_backend::epoll    },
     { "io_uring tcp",  "tcp",  el_backend::io_uring },
+    { "io_uring tcp ms", "tcp", el_backend::io_uring, true },
+    { "io_uring tcp fix", "tcp", el_backend::io_uring, false, true },
     { "io_uring tls",  "tls",  el_backend::io_uring },
     { "io_uring ktls", "ktls", el_backend::io_uring },
 };
@@ -116,12 +126,17 @@ struct alignas(64) thread_buf {
 struct run_result {
     const char* label;
     const char* mode;
+    const char* path           = "-";   // tls rows: record layer of the server side, "user", "kernel", "mixed"
     uint64_t    total_requests = 0;
     uint64_t    total_errors   = 0;
     double      rps            = 0;
     double      p50            = 0;
     double      p95            = 0;
     double      p99            = 0;
+    uint64_t    ctl_mod        = 0; // epoll tcp: EPOLL_CTL_MOD issued by the server
+    uint64_t    ctl_mod_skipped = 0;
+    uint64_t    ktls_unsupported = 0; // ktls rows: connections left in user space, cipher/protocol
+    uint64_t    ktls_refused = 0;     //            and refused by the kernel (no tls ULP, or TX after RX)
 };
 
 // ── Helpers ───────────────────────────────────────────────────────────
@@ -158,6 +173,7 @@ struct server_guard {
     std::thread thread;
     std::function<void()> stop_fn;
     std::function<void()> destroy_fn;
+    std::function<void()> on_stopped;   // after run() returned, before the loop is deleted
 
     template<typename Loop, typename Config>
     void start(Loop* l, Config cfg) {
@@ -169,17 +185,23 @@ struct server_guard {
     void stop() {
         if (stop_fn) stop_fn();
         if (thread.joinable()) thread.join();
+        if (on_stopped) on_stopped();
         if (destroy_fn) destroy_fn();
         stop_fn = {};
         destroy_fn = {};
+        on_stopped = {};
     }
 
     ~server_guard() { stop(); }
     server_guard() = default;
     server_guard(server_guard&& o) noexcept
-        : thread(std::move(o.thread)), stop_fn(std::move(o.stop_fn)), destroy_fn(std::move(o.destroy_fn)) {}
+        : thread(std::move(o.thread)), stop_fn(std::move(o.stop_fn)), destroy_fn(std::move(o.destroy_fn))
+        , on_stopped(std::move(o.on_stopped)) {}
     server_guard& operator=(server_guard&& o) noexcept {
-        if (this != &o) { stop(); thread = std::move(o.thread); stop_fn = std::move(o.stop_fn); destroy_fn = std::move(o.destroy_fn); }
+        if (this != &o) {
+            stop(); thread = std::move(o.thread); stop_fn = std::move(o.stop_fn);
+            destroy_fn = std::move(o.destroy_fn); on_stopped = std::move(o.on_stopped);
+        }
         return *this;
     }
     server_guard(const server_guard&) = delete;
@@ -400,19 +422,40 @@ static void run_tls_blocking_clients(
     for (auto& t : workers) t.join();
 }
 
-// ── Run one configuration ─────────────────────────────────────────────
+// ── Aggregate per-connection samples into a result row ───────────────
 
-static run_result run_config(const bench_config& cfg, const bench_run& run, int port) {
-    run_result result;
-    result.label = run.label;
-    result.mode = run.mode;
+static void aggregate(const bench_config& cfg, std::vector<thread_buf>& bufs, run_result& result) {
+    uint64_t total_requests = 0;
+    uint64_t total_errors   = 0;
+    for (auto& b : bufs) {
+        total_requests += b.size();
+        total_errors   += b.errors;
+    }
+
+    std::vector<int64_t> all;
+    all.reserve(total_requests);
+    for (auto& b : bufs) {
+        auto n = b.size();
+        for (uint64_t i = 0; i < n; ++i) all.push_back(b.samples[i]);
+    }
+    std::sort(all.begin(), all.end());
+
+    double elapsed = cfg.duration_s;
+    result.total_requests = total_requests;
+    result.total_errors   = total_errors;
+    result.rps            = (double)total_requests / elapsed;
+    result.p50            = percentile(all.data(), all.size(), 50);
+    result.p95            = percentile(all.data(), all.size(), 95);
+    result.p99            = percentile(all.data(), all.size(), 99);
+}
+
+// ── Start the library server of one run (echo: read -> write -> read) ──
 
+static void start_server(server_guard& server, const bench_config& cfg, const bench_run& run,
+                         int port, run_result& result) {
     bool needs_tls = (std::string(run.mode) != "tcp");
     bool ktls = (std::string(run.mode) == "ktls") && cfg.ktls_enable;
 
-    // ── Start server ──────────────────────────────────────────────
-    server_guard server;
-
     if (run.backend == el_backend::io_uring) {
         if (needs_tls) {
             auto* loop = new uring_tls_event_loop(
@@ -440,6 +483,9 @@ static run_result run_config(const bench_config& cfg, const bench_run& run, int
             ecfg.max_mutual_connections = 10000;
             ecfg.max_accepts_per_tick   = 1000;
             ecfg.epoll_temeout = 1000;
+            ecfg.uring_multishot = run.multishot;
+            ecfg.uring_fixed_files = run.fixed;
+            ecfg.uring_fixed_buffers = run.fixed;
             server.start(loop, std::move(ecfg));
         }
     } else {
@@ -469,9 +515,26 @@ static run_result run_config(const bench_config& cfg, const bench_run& run, int
             ecfg.max_mutual_connections = 10000;
             ecfg.max_accepts_per_tick   = 1000;
             ecfg.epoll_temeout = 1000;
+            server.on_stopped = [loop, &result] {
+                result.ctl_mod = loop->stats().ctl_mod;
+                result.ctl_mod_skipped = loop->stats().ctl_mod_skipped;
+            };
             server.start(loop, std::move(ecfg));
         }
     }
+}
+
+// ── Run one configuration ─────────────────────────────────────────────
+
+static run_result run_config(const bench_config& cfg, const bench_run& run, int port) {
+    run_result result;
+    result.label = run.label;
+    result.mode = run.mode;
+
+    const auto ktls_before = hope::io::ktls_stats();
+
+    server_guard server;
+    start_server(server, cfg, run, port, result);
 
     std::this_thread::sleep_for(std::chrono::milliseconds(300));
 
@@ -489,30 +552,121 @@ static run_result run_config(const bench_config& cfg, const bench_run& run, int
     }
     server.stop();
 
-    // Aggregate results
-    uint64_t total_requests = 0;
-    uint64_t total_errors   = 0;
-    for (auto& b : bufs) {
-        total_requests += b.size();
-        total_errors   += b.errors;
+    if (std::string(run.mode) != "tcp") {
+        // Only the server attempts KTLS, the blocking clients stay in user space
+        const auto ktls_after = hope::io::ktls_stats();
+        const auto kernel = ktls_after.kernel - ktls_before.kernel;
+        result.ktls_unsupported = ktls_after.unsupported - ktls_before.unsupported;
+        result.ktls_refused = (ktls_after.refused + ktls_after.broken) - (ktls_before.refused + ktls_before.broken);
+        const auto fallback = result.ktls_unsupported + result.ktls_refused;
+        result.path = kernel == 0 ? "user" : fallback == 0 ? "kernel" : "mixed";
     }
 
-    std::vector<int64_t> all;
-    all.reserve(total_requests);
-    for (auto& b : bufs) {
-        auto n = b.size();
-        for (uint64_t i = 0; i < n; ++i) all.push_back(b.samples[i]);
+    aggregate(cfg, bufs, result);
+    return result;
+}
+
+// ── Connection storm: connect, one echo, close, as fast as possible ─
+
+static void run_storm_clients(
+    const std::string& payload,
+    double warmup_end,
+    double bench_end,
+    int port,
+    std::vector<thread_buf>& bufs)
+{
+    std::vector<std::thread> workers;
+    workers.reserve(bufs.size());
+
+    for (auto& buf : bufs) {
+        workers.emplace_back([&payload, warmup_end, bench_end, port, &buf]() {
+            struct sockaddr_in server_addr{};
+            server_addr.sin_family = AF_INET;
+            server_addr.sin_port = htons(port);
+            inet_pton(AF_INET, "127.0.0.1", &server_addr.sin_addr);
+
+            std::string reply(payload.size(), '\0');
+            struct timeval timeout{ 1, 0 };
+            // RST on close: no TIME_WAIT, the ephemeral ports last the whole run
+            struct linger rst{ 1, 0 };
+
+            for (double t0 = now_sec(); t0 < bench_end; t0 = now_sec()) {
+                int fd = socket(AF_INET, SOCK_STREAM, 0);
+                bool ok = false;
+                if (fd >= 0) {
+                    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+                    ok = connect(fd, (struct sockaddr*)&server_addr, sizeof(server_addr)) == 0
+                        && send(fd, payload.data(), payload.size(), MSG_NOSIGNAL) == (ssize_t)payload.size()
+                        && recv(fd, reply.data(), reply.size(), MSG_WAITALL) == (ssize_t)reply.size();
+                    setsockopt(fd, SOL_SOCKET, SO_LINGER, &rst, sizeof(rst));
+                    close(fd);
+                }
+                if (t0 < warmup_end) continue;
+                if (ok) buf.push(elapsed_us(t0, now_sec()));
+                else buf.errors++;
+            }
+        });
     }
-    std::sort(all.begin(), all.end());
 
-    double elapsed = cfg.duration_s;
-    result.total_requests = total_requests;
-    result.total_errors   = total_errors;
-    result.rps            = (double)total_requests / elapsed;
-    result.p50            = percentile(all.data(), all.size(), 50);
-    result.p95            = percentile(all.data(), all.size(), 95);
-    result.p99            = percentile(all.data(), all.size(), 99);
+    for (auto& t : workers) t.join();
+}
+
+static run_result run_storm(const bench_config& cfg, const bench_run& run, int port) {
+    run_result result;
+    result.label = run.label;
+    result.mode = run.mode;
+
+    server_guard server;
+    start_server(server, cfg, run, port, result);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+    std::string payload(cfg.payload, 'x');
 
+    double warmup_end = now_sec() + cfg.warmup_s;
+    double bench_end  = warmup_end + cfg.duration_s;
+
+    std::vector<thread_buf> bufs(cfg.num_threads);
+    run_storm_clients(payload, warmup_end, bench_end, port, bufs);
+    server.stop();
+
+    aggregate(cfg, bufs, result);
+    return result;
+}
+
+// ── Shard scaling: sharded epoll tcp with 1..max_shards threads ───────
+
+static run_result run_sharded(const bench_config& cfg, int shards, int port) {
+    run_result result;
+    result.label = "epoll sharded";
+    result.mode = "tcp";
+
+    server_guard server;
+    auto* loop = new sharded_event_loop_t(
+        [](connection&) { return el_connection_state::read; },
+        [](connection&) { return el_connection_state::write; },
+        [](connection&) { return el_connection_state::read; },
+        [](connection&, const std::string&) { return el_connection_state::die; });
+    config ecfg;
+    ecfg.port        = port;
+    ecfg.max_mutual_connections = 10000;
+    ecfg.max_accepts_per_tick   = 1000;
+    ecfg.epoll_temeout = 1000;
+    ecfg.num_shards  = (std::size_t)shards;
+    server.start(loop, std::move(ecfg));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+    std::string payload(cfg.payload, 'x');
+
+    double warmup_end = now_sec() + cfg.warmup_s;
+    double bench_end  = warmup_end + cfg.duration_s;
+
+    std::vector<thread_buf> bufs(cfg.connections);
+    run_uring_tcp_clients(cfg, payload, warmup_end, bench_end, port, bufs);
+    server.stop();
+
+    aggregate(cfg, bufs, result);
     return result;
 }
 
@@ -544,6 +698,12 @@ int main(int argc, char** argv) {
             cfg.connections = atoi(argv[++i]);
         else if (strcmp(argv[i], "--duration") == 0 && i + 1 < argc)
             cfg.duration_s = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--scaling") == 0) {
+            cfg.max_shards = (i + 1 < argc && argv[i + 1][0] != '-')
+                ? atoi(argv[++i])
+                : (int)std::max(1u, std::thread::hardware_concurrency());
+        } else if (strcmp(argv[i], "--storm") == 0)
+            cfg.storm = true;
     }
 
     if (!find_file(cfg.cert_path, cert_name)) { fprintf(stderr, "cert not found: %s\n", cert_name); return 1; }
@@ -560,15 +720,24 @@ int main(int argc, char** argv) {
     printf("──────────────────────────────────────────────────────\n");
     printf("\n");
 
-    printf("%-20s %-8s %12s %8s %8s %6s\n", "Backend", "Mode", "RPS", "p50", "p99", "Errors");
-    printf("%-20s %-8s %12s %8s %8s %6s\n", "──────", "────", "───", "───", "───", "──────");
+    printf("%-20s %-8s %-7s %12s %8s %8s %6s\n", "Backend", "Mode", "Path", "RPS", "p50", "p99", "Errors");
+    printf("%-20s %-8s %-7s %12s %8s %8s %6s\n", "──────", "────", "────", "───", "───", "───", "──────");
 
     int port = cfg.port;
     for (int i = 0; i < NUM_RUNS; ++i) {
         auto r = run_config(cfg, ALL_RUNS[i], port++);
-        printf("%-20s %-8s %12.0f %7.0f us %7.0f us %6llu\n",
-               r.label, r.mode, r.rps, r.p50, r.p99,
+        printf("%-20s %-8s %-7s %12.0f %7.0f us %7.0f us %6llu\n",
+               r.label, r.mode, r.path, r.rps, r.p50, r.p99,
                (unsigned long long)r.total_errors);
+        if (auto changes = r.ctl_mod + r.ctl_mod_skipped; changes != 0) {
+            printf("  epoll_ctl MOD: %llu issued, %llu skipped (%.1f%% saved)\n",
+                   (unsigned long long)r.ctl_mod, (unsigned long long)r.ctl_mod_skipped,
+                   100.0 * r.ctl_mod_skipped / changes);
+        }
+        if (r.ktls_unsupported + r.ktls_refused != 0) {
+            printf("  ktls fallback: %llu unsupported cipher/protocol, %llu refused by the kernel\n",
+                   (unsigned long long)r.ktls_unsupported, (unsigned long long)r.ktls_refused);
+        }
         fflush(stdout);
         if (r.total_errors > r.total_requests) {
             fprintf(stderr, "bench: too many errors in %s\n", r.label);
@@ -576,6 +745,42 @@ int main(int argc, char** argv) {
         }
     }
 
+    if (cfg.storm) {
+        printf("\n");
+        printf("%-20s %-8s %12s %8s %8s %6s\n", "Storm", "Mode", "Conn/s", "p50", "p99", "Errors");
+        printf("%-20s %-8s %12s %8s %8s %6s\n", "─────", "────", "──────", "───", "───", "──────");
+
+        for (int i = 0; i < NUM_RUNS; ++i) {
+            if (std::string(ALL_RUNS[i].mode) != "tcp") continue;
+            auto r = run_storm(cfg, ALL_RUNS[i], port++);
+            printf("%-20s %-8s %12.0f %7.0f us %7.0f us %6llu\n",
+                   r.label, r.mode, r.rps, r.p50, r.p99,
+                   (unsigned long long)r.total_errors);
+            fflush(stdout);
+        }
+    }
+
+    if (cfg.max_shards > 0) {
+        printf("\n");
+        printf("%-20s %-8s %12s %8s %8s %6s\n", "Shards", "Mode", "RPS", "Speedup", "p99", "Errors");
+        printf("%-20s %-8s %12s %8s %8s %6s\n", "──────", "────", "───", "───────", "───", "──────");
+
+        // 1, 2, 4, ... and always the requested maximum
+        std::vector<int> shard_counts;
+        for (int shards = 1; shards < cfg.max_shards; shards *= 2) shard_counts.push_back(shards);
+        shard_counts.push_back(cfg.max_shards);
+
+        double base_rps = 0;
+        for (auto shards : shard_counts) {
+            auto r = run_sharded(cfg, shards, port++);
+            if (shards == 1) base_rps = r.rps;
+            printf("%-20d %-8s %12.0f %7.2fx %7.0f us %6llu\n",
+                   shards, r.mode, r.rps, base_rps > 0 ? r.rps / base_rps : 0.0, r.p99,
+                   (unsigned long long)r.total_errors);
+            fflush(stdout);
+        }
+    }
+
     printf("\n");
     return 0;
 }
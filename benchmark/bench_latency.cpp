@@ -16,6 +16,7 @@
 
 #include "hope-io/coredefs.h"
 #include "hope-io/net/tls/tls_init.h"
+#include "hope-io/net/tls/ktls_enable.h"
 #include <cstdio>
 #include <cstdlib>
 #include <cmath>
@@ -34,9 +35,6 @@
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <fcntl.h>
-#if PLATFORM_LINUX
-#include <linux/tls.h>
-#endif
 
 #include <openssl/ssl.h>
 #include <openssl/err.h>
@@ -134,11 +132,13 @@ static int write_all(int fd, const void* data, int len) {
     return total;
 }
 
-// Read exactly len bytes (blocking)
-static int read_all(int fd, void* data, int len) {
+// Read exactly len bytes (blocking). A KTLS socket with RX offloaded is read through
+// ktls_recv, plain read() fails on the first record that is not application data.
+static int read_all(int fd, void* data, int len, bool ktls = false) {
     int total = 0;
     while (total < len) {
-        int r = (int)::read(fd, (char*)data + total, (size_t)(len - total));
+        int r = ktls ? (int)hope::io::ktls_recv(fd, (char*)data + total, (size_t)(len - total), 0)
+                     : (int)::read(fd, (char*)data + total, (size_t)(len - total));
         if (r <= 0) return r;
         total += r;
     }
@@ -171,9 +171,8 @@ static SSL_CTX* create_ctx(bool is_server, const bench_config& cfg) {
     auto* method = is_server ? TLS_server_method() : TLS_client_method();
     auto* ctx = SSL_CTX_new(method);
     if (!ctx) { fprintf(stderr, "SSL_CTX_new failed\n"); exit(1); }
+    // Whatever the handshake settles on (TLS 1.3 with these defaults), KTLS has to take it
     SSL_CTX_set_min_proto_version(ctx, TLS1_2_VERSION);
-    SSL_CTX_set_max_proto_version(ctx, TLS1_2_VERSION);
-    SSL_CTX_set_cipher_list(ctx, "AES128-GCM-SHA256");
     if (is_server) {
         if (SSL_CTX_use_certificate_file(ctx, cfg.cert_path.c_str(), SSL_FILETYPE_PEM) <= 0)
             { fprintf(stderr, "cert failed\n"); exit(1); }
@@ -185,47 +184,12 @@ static SSL_CTX* create_ctx(bool is_server, const bench_config& cfg) {
     return ctx;
 }
 
-// ── KTLS enable (Linux only) ───────────────────────────────────────────
-#if PLATFORM_LINUX
-static void enable_ktls(SSL* ssl, int fd, bool is_server) {
-    size_t key_len = SSL_get_key_block_len(ssl);
-    std::vector<uint8_t> key_block(key_len);
-    SSL_generate_key_block(ssl, key_block.data(), key_len);
-
-    uint8_t* cw_key = key_block.data() + 0;
-    uint8_t* sw_key = key_block.data() + 16;
-    uint8_t* cw_iv  = key_block.data() + 32;
-    uint8_t* sw_iv  = key_block.data() + 36;
-
-    auto make_info = [](struct tls12_crypto_info_aes_gcm_128* info,
-                        const uint8_t* key, const uint8_t* salt) {
-        memset(info, 0, sizeof(*info));
-        info->info.version = TLS1_2_VERSION;
-        info->info.cipher_type = TLS_CIPHER_AES_GCM_128;
-        memcpy(info->key, key, 16);
-        memcpy(info->salt, salt, 4);
-    };
-
-    struct tls12_crypto_info_aes_gcm_128 tx_info, rx_info;
-    if (is_server) {
-        make_info(&tx_info, sw_key, sw_iv);
-        make_info(&rx_info, cw_key, cw_iv);
-    } else {
-        make_info(&tx_info, cw_key, cw_iv);
-        make_info(&rx_info, sw_key, sw_iv);
-    }
-
-    if (setsockopt(fd, SOL_TCP, TCP_ULP, "tls", sizeof("tls")) < 0) { perror("TCP_ULP"); throw std::runtime_error("KTLS not supported"); }
-    if (setsockopt(fd, SOL_TLS, TLS_TX, &tx_info, sizeof(tx_info)) < 0) { perror("TLS_TX"); throw std::runtime_error("KTLS TX failed"); }
-    if (setsockopt(fd, SOL_TLS, TLS_RX, &rx_info, sizeof(rx_info)) < 0) { perror("TLS_RX"); throw std::runtime_error("KTLS RX failed"); }
-}
-#endif
-
 // ── Per-configuration server/client threads ──────────────────────────
 
 struct run_result {
     const char* label;
     const char* mode;
+    const char* path      = "-";   // record layer that ran: "user", "kernel", "mixed"
     uint64_t    count     = 0;
     uint64_t    errors    = 0;
     double      avg_ns    = 0;
@@ -258,7 +222,13 @@ struct sample_buf {
     }
 };
 
-static void server_thread(int listen_fd, const bench_run& run, SSL_CTX* ctx) {
+// "ktls" rows fall back to SSL_read/SSL_write on a side where the kernel did not take
+// the connection, the row then reports which path actually ran
+static bool offload(SSL* ssl, int fd, bool is_server, const bench_run& run) {
+    return std::string(run.mode) == "ktls" && hope::io::try_enable_fd_ktls(ssl, fd, is_server);
+}
+
+static void server_thread(int listen_fd, const bench_run& run, SSL_CTX* ctx, bool& offloaded) {
     int client_fd = tcp_accept(listen_fd);
 
     SSL* ssl = nullptr;
@@ -266,34 +236,27 @@ static void server_thread(int listen_fd, const bench_run& run, SSL_CTX* ctx) {
         ssl = SSL_new(ctx);
         SSL_set_fd(ssl, client_fd);
         if (SSL_accept(ssl) <= 0) { SSL_free(ssl); close(client_fd); return; }
-
-#if PLATFORM_LINUX
-        if (std::string(run.mode) == "ktls") {
-            try {
-                enable_ktls(ssl, client_fd, true);
-                // After KTLS, raw read/write on fd
-            } catch (...) {
-                SSL_free(ssl); close(client_fd); return;
-            }
-        }
-#endif
+        offloaded = offload(ssl, client_fd, true, run);
     }
+    const bool user_tls = ssl && !offloaded;
 
     std::vector<char> buf(65536);
 
     while (true) {
         int n;
-        if (ssl && std::string(run.mode) == "tls") {
+        if (user_tls) {
             // Standard TLS — use SSL_read/SSL_write
             n = SSL_read(ssl, buf.data(), (int)buf.size());
+        } else if (offloaded) {
+            n = (int)hope::io::ktls_recv(client_fd, buf.data(), buf.size(), 0);
         } else {
-            // Raw TCP or KTLS — use read/write
+            // Raw TCP — use read/write
             n = (int)::read(client_fd, buf.data(), buf.size());
         }
         if (n <= 0) break;
 
         int written;
-        if (ssl && std::string(run.mode) == "tls") {
+        if (user_tls) {
             written = ssl_write_all(ssl, buf.data(), n);
         } else {
             written = write_all(client_fd, buf.data(), n);
@@ -319,7 +282,8 @@ static run_result run_config(const bench_config& cfg, const bench_run& run, int
     // Listen + accept
     int listen_fd = tcp_listen(port);
 
-    std::thread server(server_thread, listen_fd, run, s_ctx);
+    bool server_offloaded = false;
+    std::thread server(server_thread, listen_fd, std::cref(run), s_ctx, std::ref(server_offloaded));
     std::this_thread::sleep_for(std::chrono::milliseconds(50));
 
     // Client connect
@@ -336,22 +300,11 @@ static run_result run_config(const bench_config& cfg, const bench_run& run, int
             fprintf(stderr, "client SSL handshake failed\n");
             exit(1);
         }
-#if PLATFORM_LINUX
-        if (std::string(run.mode) == "ktls") {
-            try {
-                enable_ktls(c_ssl, client_fd, false);
-            } catch (...) {
-                SSL_free(c_ssl); SSL_CTX_free(c_ctx);
-                close(client_fd); close(listen_fd);
-                server.join();
-                result.errors = 1;
-                result.label = run.label;
-                result.mode = run.mode;
-                return result;
-            }
-        }
-#endif
     }
+    const bool client_offloaded = c_ssl && offload(c_ssl, client_fd, false, run);
+    const bool user_tls = c_ssl && !client_offloaded;
+    // A TLS 1.3 client offloads TX only, the session tickets still come through SSL_read
+    const bool ssl_reads = user_tls || (client_offloaded && !hope::io::ktls_offloads_rx(c_ssl, false));
 
     std::string payload(cfg.payload, 'x');
     std::vector<char> reply(cfg.payload);
@@ -361,12 +314,15 @@ static run_result run_config(const bench_config& cfg, const bench_run& run, int
 
     // Warmup
     for (uint64_t i = 0; i < cfg.warmup; ++i) {
-        if (c_ssl && std::string(run.mode) == "tls") {
+        if (user_tls) {
             ssl_write_all(c_ssl, payload.data(), (int)payload.size());
-            ssl_read_all(c_ssl, reply.data(), (int)reply.size());
         } else {
             write_all(client_fd, payload.data(), (int)payload.size());
-            read_all(client_fd, reply.data(), (int)reply.size());
+        }
+        if (ssl_reads) {
+            ssl_read_all(c_ssl, reply.data(), (int)reply.size());
+        } else {
+            read_all(client_fd, reply.data(), (int)reply.size(), client_offloaded);
         }
     }
 
@@ -374,12 +330,14 @@ static run_result run_config(const bench_config& cfg, const bench_run& run, int
     for (uint64_t i = 0; i < cfg.iterations; ++i) {
         int64_t t0 = now_ns();
         int r;
-        if (c_ssl && std::string(run.mode) == "tls") {
+        if (user_tls) {
             r = ssl_write_all(c_ssl, payload.data(), (int)payload.size());
-            if (r > 0) r = ssl_read_all(c_ssl, reply.data(), (int)reply.size());
         } else {
             r = write_all(client_fd, payload.data(), (int)payload.size());
-            if (r > 0) r = read_all(client_fd, reply.data(), (int)reply.size());
+        }
+        if (r > 0) {
+            r = ssl_reads ? ssl_read_all(c_ssl, reply.data(), (int)reply.size())
+                          : read_all(client_fd, reply.data(), (int)reply.size(), client_offloaded);
         }
         if (r <= 0) { buf.errors++; break; }
         buf.push(now_ns() - t0);
@@ -393,6 +351,11 @@ static run_result run_config(const bench_config& cfg, const bench_run& run, int
     server.join();
     if (s_ctx) SSL_CTX_free(s_ctx);
 
+    if (needs_tls) {
+        result.path = client_offloaded && server_offloaded ? "kernel"
+                    : client_offloaded || server_offloaded ? "mixed" : "user";
+    }
+
     // Aggregate
     uint64_t n = buf.count.load();
     result.count = n;
@@ -453,17 +416,17 @@ int main(int argc, char** argv) {
     printf("  warmup      = %llu\n",        (unsigned long long)cfg.warmup);
     printf("──────────────────────────────────────────────────────\n");
     printf("\n");
-    printf("%-20s %-8s %10s %10s %10s %10s %10s %6s\n",
-           "Backend", "Mode", "Avg", "p50", "p95", "p99", "Max", "Err");
-    printf("%-20s %-8s %10s %10s %10s %10s %10s %6s\n",
-           "──────", "────", "───", "───", "───", "───", "───", "───");
+    printf("%-20s %-8s %-7s %10s %10s %10s %10s %10s %6s\n",
+           "Backend", "Mode", "Path", "Avg", "p50", "p95", "p99", "Max", "Err");
+    printf("%-20s %-8s %-7s %10s %10s %10s %10s %10s %6s\n",
+           "──────", "────", "────", "───", "───", "───", "───", "───", "───");
 
     int port = cfg.port;
     for (int i = 0; i < NUM_RUNS; ++i) {
         auto r = run_config(cfg, ALL_RUNS[i], port++);
 
-        printf("%-20s %-8s %9.0f ns %9.0f ns %9.0f ns %9.0f ns %9.0f ns %6llu\n",
-               r.label, r.mode,
+        printf("%-20s %-8s %-7s %9.0f ns %9.0f ns %9.0f ns %9.0f ns %9.0f ns %6llu\n",
+               r.label, r.mode, r.path,
                r.avg_ns, r.p50_ns, r.p95_ns, r.p99_ns, r.max_ns,
                (unsigned long long)r.errors);
         fflush(stdout);
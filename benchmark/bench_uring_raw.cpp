@@ -8,11 +8,14 @@
  * raw sockets — no hope-io abstractions. Measures bare-metal
  * io_uring echo throughput and latency for comparison with
  * bench_event_loop's io_uring TCP results.
+ * The server runs twice: plain accept/recv/send, then with
+ * direct descriptors (accept_direct) and registered buffers
+ * (READ_FIXED / WRITE_FIXED).
  *
  * Usage:
  *   bench_uring_raw [--payload 64] [--connections 20]
  *                   [--duration 3] [--warmup 1] [--port 19400]
- *                   [--threads 4]
+ *                   [--threads 4] [--fixed | --plain]
  */
 
 #include "hope-io/coredefs.h"
@@ -56,6 +59,8 @@ struct bench_config {
     int         warmup_s    = 1;
     int         port        = 19400;
     int         threads     = 4;   // client-side io_uring threads
+    bool        only_fixed  = false;
+    bool        only_plain  = false;
 };
 
 // ── Tag encoding for io_uring user_data ──────────────────────────────
@@ -112,10 +117,21 @@ struct raw_echo_server {
     // Per-connection state: pending recv or send
     struct conn_state {
         std::string buf;
+        size_t len = 0; // fixed mode: bytes received into the registered slot
     };
     std::vector<conn_state> conns;
 
-    void start(int port) {
+    // Fixed mode: connections live in registered file slots and echo through
+    // one registered buffer per slot
+    bool fixed = false;
+    size_t slot_size = 0;
+    std::vector<char> arena;
+
+    static constexpr unsigned FIXED_SLOTS = 1024;
+
+    void start(int port, bool use_fixed = false, size_t payload = 0) {
+        fixed = use_fixed;
+        slot_size = std::max<size_t>(4096, payload);
         thread = std::thread([this, port] { run(port); });
     }
 
@@ -148,6 +164,20 @@ private:
         // Pre-allocate connection state
         conns.resize(1024);
 
+        if (fixed) {
+            arena.resize(FIXED_SLOTS * slot_size);
+            std::vector<iovec> iovs(FIXED_SLOTS);
+            for (unsigned i = 0; i < FIXED_SLOTS; ++i) {
+                iovs[i] = { arena.data() + i * slot_size, slot_size };
+            }
+            if (io_uring_register_files_sparse(&ring, FIXED_SLOTS) < 0
+                || io_uring_register_buffers(&ring, iovs.data(), FIXED_SLOTS) < 0) {
+                fprintf(stderr, "raw_srv: registration refused (RLIMIT_MEMLOCK?), running plain\n");
+                io_uring_unregister_files(&ring);
+                fixed = false;
+            }
+        }
+
         struct sockaddr_in client_addr{};
         socklen_t client_len = sizeof(client_addr);
 
@@ -195,7 +225,7 @@ private:
                 switch (op) {
                 case uring_op::accept: {
                     int client_fd = res;
-                    fcntl(client_fd, F_SETFL, fcntl(client_fd, F_GETFL) | O_NONBLOCK);
+                    if (!fixed) fcntl(client_fd, F_SETFL, fcntl(client_fd, F_GETFL) | O_NONBLOCK);
                     // Ensure state slot exists
                     if ((size_t)client_fd >= conns.size())
                         conns.resize(client_fd + 1);
@@ -207,9 +237,10 @@ private:
                     break;
                 }
                 case uring_op::recv: {
-                    if (res == 0) { close(fd); break; } // EOF
+                    if (res == 0) { close_conn(&ring, fd); break; } // EOF
                     // Echo back
-                    conns[fd].buf.resize((size_t)res);
+                    conns[fd].len = (size_t)res;
+                    if (!fixed) conns[fd].buf.resize((size_t)res);
                     submit_send(&ring, fd);
                     break;
                 }
@@ -227,32 +258,58 @@ private:
             io_uring_submit(&ring);
         }
 
-        // Cleanup connections
-        for (size_t i = 0; i < conns.size(); ++i) {
+        // Cleanup connections, ring exit releases the registered slots
+        for (size_t i = 0; !fixed && i < conns.size(); ++i) {
             if (!conns[i].buf.empty() && (int)i != m_listen_fd)
                 close((int)i);
         }
         io_uring_queue_exit(&ring);
     }
 
+    void close_conn(struct io_uring* ring, int fd) {
+        conns[fd].buf.clear();
+        if (!fixed) {
+            close(fd);
+            return;
+        }
+        struct io_uring_sqe* sqe = io_uring_get_sqe(ring);
+        if (!sqe) return;
+        io_uring_prep_close_direct(sqe, (unsigned)fd);
+        io_uring_sqe_set_data64(sqe, encode(fd, uring_op::connect)); // ignored by the switch
+    }
+
     void submit_accept(struct io_uring* ring, struct sockaddr_in* addr, socklen_t* addrlen) {
         struct io_uring_sqe* sqe = io_uring_get_sqe(ring);
         if (!sqe) return;
-        io_uring_prep_accept(sqe, m_listen_fd, (struct sockaddr*)addr, addrlen, 0);
+        if (fixed) {
+            io_uring_prep_accept_direct(sqe, m_listen_fd, (struct sockaddr*)addr, addrlen, 0, IORING_FILE_INDEX_ALLOC);
+        } else {
+            io_uring_prep_accept(sqe, m_listen_fd, (struct sockaddr*)addr, addrlen, 0);
+        }
         io_uring_sqe_set_data64(sqe, encode(m_listen_fd, uring_op::accept));
     }
 
     void submit_recv(struct io_uring* ring, int fd) {
         struct io_uring_sqe* sqe = io_uring_get_sqe(ring);
         if (!sqe) return;
-        io_uring_prep_recv(sqe, fd, conns[fd].buf.data(), conns[fd].buf.size(), 0);
+        if (fixed) {
+            io_uring_prep_read_fixed(sqe, fd, arena.data() + fd * slot_size, (unsigned)slot_size, 0, fd);
+            sqe->flags |= IOSQE_FIXED_FILE;
+        } else {
+            io_uring_prep_recv(sqe, fd, conns[fd].buf.data(), conns[fd].buf.size(), 0);
+        }
         io_uring_sqe_set_data64(sqe, encode(fd, uring_op::recv));
     }
 
     void submit_send(struct io_uring* ring, int fd) {
         struct io_uring_sqe* sqe = io_uring_get_sqe(ring);
         if (!sqe) return;
-        io_uring_prep_send(sqe, fd, conns[fd].buf.data(), conns[fd].buf.size(), 0);
+        if (fixed) {
+            io_uring_prep_write_fixed(sqe, fd, arena.data() + fd * slot_size, (unsigned)conns[fd].len, 0, fd);
+            sqe->flags |= IOSQE_FIXED_FILE;
+        } else {
+            io_uring_prep_send(sqe, fd, conns[fd].buf.data(), conns[fd].buf.size(), 0);
+        }
         io_uring_sqe_set_data64(sqe, encode(fd, uring_op::send));
     }
 };
@@ -415,10 +472,10 @@ static void run_uring_raw_clients(
 
 // ── Run one configuration ─────────────────────────────────────────────
 
-static void run_config(const bench_config& cfg, int port) {
+static void run_config(const bench_config& cfg, int port, bool fixed) {
     // Start server
     raw_echo_server server;
-    server.start(port);
+    server.start(port, fixed, (size_t)cfg.payload);
     std::this_thread::sleep_for(std::chrono::milliseconds(200));
 
     std::string payload(cfg.payload, 'x');
@@ -449,7 +506,8 @@ static void run_config(const bench_config& cfg, int port) {
 
     double elapsed = cfg.duration_s;
 
-    printf("raw io_uring  tcp       %12.0f %7.0f us %7.0f us %6llu\n",
+    printf("%-20s %-8s %12.0f %7.0f us %7.0f us %6llu\n",
+           server.fixed ? "raw io_uring fixed" : "raw io_uring", "tcp",
            (double)total_requests / elapsed,
            percentile(all.data(), all.size(), 50),
            percentile(all.data(), all.size(), 99),
@@ -476,6 +534,10 @@ int main(int argc, char** argv) {
             cfg.port = atoi(argv[++i]);
         else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
             cfg.threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--fixed") == 0)
+            cfg.only_fixed = true;
+        else if (strcmp(argv[i], "--plain") == 0)
+            cfg.only_plain = true;
     }
 
     printf("\n");
@@ -490,7 +552,8 @@ int main(int argc, char** argv) {
     printf("%-20s %-8s %12s %8s %8s %6s\n", "Backend", "Mode", "RPS", "p50", "p99", "Errors");
     printf("%-20s %-8s %12s %8s %8s %6s\n", "──────", "────", "───", "───", "───", "──────");
 
-    run_config(cfg, cfg.port);
+    if (!cfg.only_fixed) run_config(cfg, cfg.port, false);
+    if (!cfg.only_plain) run_config(cfg, cfg.port + 1, true);
 
     printf("\n");
     return 0;
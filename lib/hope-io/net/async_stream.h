@@ -0,0 +1,491 @@
+/* Copyright (C) 2026 Gleb Bezborodov - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: bezborodoff.gleb@gmail.com, or visit : https://github.com/glensand/hope-io
+ */
+
+#pragma once
+
+#include "hope-io/coredefs.h"
+#include "hope-io/net/event_loop.h"
+
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// C++20 coroutine layer over the callback event loops: protocol code is written as
+// a linear coroutine instead of a state machine spread over TOnRead/TOnWrite.
+//
+//     co::scheduler sched;
+//     auto loop = co::make_loop<event_loop_impl_t>(sched);
+//     co::spawn([](co::scheduler& s) -> co::task<> {
+//         while (true) co::spawn(echo(co_await s.accept()));
+//     }(sched));
+//     loop->run(cfg); // cfg.full_duplex = true
+//
+// The scheduler is the loop's four callbacks: it resumes the coroutine waiting on a
+// connection from that connection's callback and returns the state it needs next.
+// One scheduler per loop thread, it is not meant for sharded_event_loop_t.
+namespace hope::io::el::co {
+
+    // ── task ─────────────────────────────────────────────────────────
+
+    template<typename T = void>
+    class task;
+
+    namespace detail {
+
+        template<typename T>
+        struct task_result {
+            std::variant<std::monostate, T, std::exception_ptr> value;
+
+            template<typename U>
+            void return_value(U&& v) { value.template emplace<1>(std::forward<U>(v)); }
+            void unhandled_exception() noexcept { value.template emplace<2>(std::current_exception()); }
+
+            T take() {
+                if (value.index() == 2) std::rethrow_exception(std::get<2>(value));
+                return std::move(std::get<1>(value));
+            }
+        };
+
+        template<>
+        struct task_result<void> {
+            std::exception_ptr error;
+
+            void return_void() noexcept {}
+            void unhandled_exception() noexcept { error = std::current_exception(); }
+
+            void take() {
+                if (error) std::rethrow_exception(error);
+            }
+        };
+
+    }
+
+    // Lazy coroutine, starts when awaited and resumes its awaiter when done.
+    template<typename T>
+    class [[nodiscard]] task final {
+    public:
+        struct promise_type : detail::task_result<T> {
+            std::coroutine_handle<> continuation;
+
+            task get_return_object() noexcept {
+                return task(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+            std::suspend_always initial_suspend() noexcept { return {}; }
+
+            auto final_suspend() noexcept {
+                struct final_awaiter {
+                    bool await_ready() noexcept { return false; }
+                    std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                        auto next = h.promise().continuation;
+                        return next ? next : std::noop_coroutine();
+                    }
+                    void await_resume() noexcept {}
+                };
+                return final_awaiter{};
+            }
+        };
+
+        task(task&& rhs) noexcept : m_handle(std::exchange(rhs.m_handle, {})) {}
+        task& operator=(task&& rhs) noexcept {
+            if (this != &rhs) {
+                if (m_handle) m_handle.destroy();
+                m_handle = std::exchange(rhs.m_handle, {});
+            }
+            return *this;
+        }
+        task(const task&) = delete;
+        task& operator=(const task&) = delete;
+
+        ~task() {
+            if (m_handle) m_handle.destroy();
+        }
+
+        auto operator co_await() && noexcept {
+            struct awaiter {
+                std::coroutine_handle<promise_type> handle;
+
+                bool await_ready() noexcept { return !handle || handle.done(); }
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+                    handle.promise().continuation = awaiting;
+                    return handle;
+                }
+                T await_resume() { return handle.promise().take(); }
+            };
+            return awaiter{ m_handle };
+        }
+
+    private:
+        explicit task(std::coroutine_handle<promise_type> h) noexcept : m_handle(h) {}
+
+        std::coroutine_handle<promise_type> m_handle;
+    };
+
+    namespace detail {
+
+        struct detached final {
+            struct promise_type {
+                detached get_return_object() noexcept { return {}; }
+                std::suspend_never initial_suspend() noexcept { return {}; }
+                std::suspend_never final_suspend() noexcept { return {}; }
+                void return_void() noexcept {}
+                void unhandled_exception() noexcept {}
+            };
+        };
+
+        inline detached run_detached(task<void> t) {
+            try {
+                co_await std::move(t);
+            } catch (...) {
+                // A failed connection ends its handler, nobody is left to report it to
+            }
+        }
+
+    }
+
+    // Starts t right away and lets it run to completion on its own.
+    inline void spawn(task<void> t) {
+        detail::run_detached(std::move(t));
+    }
+
+    // ── async_stream ─────────────────────────────────────────────────
+
+    class scheduler;
+
+    // Coroutine view of one event loop connection (full duplex: rx ring in, tx ring out).
+    // Operations throw once the connection failed or was closed by the peer. The connection
+    // is closed when the last shared_ptr to the stream goes away, after the tx ring drained.
+    // A stream should be awaited from its own handler: an operation started from another
+    // connection's callback only takes effect on this connection's next event.
+    class async_stream final {
+    public:
+        async_stream(scheduler& owner, int32_t descriptor, tiered_buffer* rx, tiered_buffer* tx)
+            : m_owner(owner)
+            , m_descriptor(descriptor)
+            , m_rx(rx)
+            , m_tx(tx) {}
+
+        ~async_stream();
+
+        async_stream(const async_stream&) = delete;
+        async_stream& operator=(const async_stream&) = delete;
+
+        int32_t descriptor() const noexcept { return m_descriptor; }
+        bool is_open() const noexcept { return m_error.empty(); }
+        // Bytes received and not consumed yet
+        std::size_t available() const noexcept { return is_open() ? m_rx->count() : 0; }
+
+        // Fills out completely
+        auto read(std::span<unsigned char> out) noexcept {
+            struct awaiter {
+                async_stream& s;
+                std::span<unsigned char> out;
+
+                bool await_ready() noexcept {
+                    s.m_read_dst = out.data();
+                    s.m_read_left = out.size();
+                    return s.pump_read();
+                }
+                void await_suspend(std::coroutine_handle<> h) noexcept { s.m_reader = h; }
+                void await_resume() { s.throw_if_failed(); }
+            };
+            return awaiter{ *this, out };
+        }
+
+        // Exactly n bytes
+        auto read(std::size_t n) {
+            struct awaiter {
+                async_stream& s;
+                std::vector<unsigned char> bytes;
+
+                bool await_ready() noexcept {
+                    s.m_read_dst = bytes.data();
+                    s.m_read_left = bytes.size();
+                    return s.pump_read();
+                }
+                void await_suspend(std::coroutine_handle<> h) noexcept { s.m_reader = h; }
+                std::vector<unsigned char> await_resume() {
+                    s.throw_if_failed();
+                    return std::move(bytes);
+                }
+            };
+            return awaiter{ *this, std::vector<unsigned char>(n) };
+        }
+
+        // Completes once every byte is in the tx ring, suspends only while the ring is full.
+        // bytes must stay valid until then.
+        auto write(std::span<const unsigned char> bytes) noexcept {
+            struct awaiter {
+                async_stream& s;
+                std::span<const unsigned char> bytes;
+
+                bool await_ready() noexcept {
+                    s.m_write_src = bytes.data();
+                    s.m_write_left = bytes.size();
+                    return s.pump_write();
+                }
+                void await_suspend(std::coroutine_handle<> h) noexcept { s.m_writer = h; }
+                void await_resume() { s.throw_if_failed(); }
+            };
+            return awaiter{ *this, bytes };
+        }
+
+        auto write(std::string_view bytes) noexcept {
+            return write(std::span<const unsigned char>((const unsigned char*)bytes.data(), bytes.size()));
+        }
+
+        // Completes once the tx ring drained to the socket
+        auto flush() noexcept {
+            struct awaiter {
+                async_stream& s;
+
+                bool await_ready() noexcept { return !s.is_open() || s.m_tx->is_empty(); }
+                void await_suspend(std::coroutine_handle<> h) noexcept { s.m_flusher = h; }
+                void await_resume() { s.throw_if_failed(); }
+            };
+            return awaiter{ *this };
+        }
+
+    private:
+        friend class scheduler;
+
+        // Moves buffered input to the pending read, true when it is complete
+        bool pump_read() noexcept {
+            if (!is_open()) return true;
+            if (m_read_left != 0) {
+                auto n = m_rx->read(m_read_dst, m_read_left);
+                m_read_dst += n;
+                m_read_left -= n;
+            }
+            return m_read_left == 0;
+        }
+
+        // Moves the pending write to the tx ring, true when all of it is queued
+        bool pump_write() noexcept {
+            if (!is_open()) return true;
+            if (m_write_left != 0) {
+                auto n = m_tx->write(m_write_src, m_write_left);
+                m_write_src += n;
+                m_write_left -= n;
+            }
+            return m_write_left == 0;
+        }
+
+        void throw_if_failed() const {
+            if (!is_open()) {
+                HOPE_THROW("async_stream", m_error);
+            }
+        }
+
+        // Wakes every waiter, each of them throws
+        void fail(const std::string& what) {
+            if (!is_open()) return;
+            m_error = what.empty() ? "connection closed" : what;
+            m_read_left = m_write_left = 0;
+            for (auto* waiter : { &m_reader, &m_writer, &m_flusher }) {
+                if (auto h = std::exchange(*waiter, {})) h.resume();
+            }
+        }
+
+        scheduler& m_owner;
+        int32_t m_descriptor;
+        // Pool buffers, stable for the connection's lifetime unlike the loop's connection table
+        tiered_buffer* m_rx;
+        tiered_buffer* m_tx;
+        std::string m_error;
+
+        unsigned char* m_read_dst = nullptr;
+        std::size_t m_read_left = 0;
+        std::coroutine_handle<> m_reader;
+
+        const unsigned char* m_write_src = nullptr;
+        std::size_t m_write_left = 0;
+        std::coroutine_handle<> m_writer;
+
+        std::coroutine_handle<> m_flusher;
+    };
+
+    // ── scheduler ────────────────────────────────────────────────────
+
+    // Drives async_streams from the callbacks of one event loop (config::full_duplex required).
+    class scheduler final {
+    public:
+        scheduler() = default;
+        scheduler(const scheduler&) = delete;
+        scheduler& operator=(const scheduler&) = delete;
+
+        // Waiters would never be resumed again, let them unwind. Destroy after the loop stopped.
+        ~scheduler() {
+            shutdown();
+        }
+
+        // Next accepted connection; throws after shutdown()
+        auto accept() noexcept {
+            struct awaiter {
+                scheduler& s;
+
+                bool await_ready() noexcept { return !s.m_backlog.empty() || s.m_shutdown; }
+                void await_suspend(std::coroutine_handle<> h) noexcept { s.m_acceptor = h; }
+                std::shared_ptr<async_stream> await_resume() {
+                    if (s.m_backlog.empty()) {
+                        HOPE_THROW("async_stream", "scheduler is shut down");
+                    }
+                    auto stream = std::move(s.m_backlog.front());
+                    s.m_backlog.pop_front();
+                    return stream;
+                }
+            };
+            return awaiter{ *this };
+        }
+
+        // Fails every stream and the pending accept
+        void shutdown() {
+            m_shutdown = true;
+            m_backlog.clear();
+            for (auto& slot : m_slots) {
+                if (auto stream = slot.stream.lock()) stream->fail("scheduler is shut down");
+                slot = {};
+            }
+            if (auto h = std::exchange(m_acceptor, {})) h.resume();
+        }
+
+        // ── Event loop callbacks ─────────────────────────────────────
+        el_connection_state on_connect(connection& conn) {
+            if (!conn.tx_buffer || m_shutdown) return el_connection_state::die; // needs config::full_duplex
+            if ((std::size_t)conn.descriptor >= m_slots.size()) m_slots.resize(conn.descriptor + 1);
+            // The loop dropped the previous connection on this descriptor without telling us
+            if (auto stale = m_slots[conn.descriptor].stream.lock()) stale->fail("connection closed");
+            auto stream = std::make_shared<async_stream>(*this, conn.descriptor, conn.buffer, conn.tx_buffer);
+            m_slots[conn.descriptor] = { stream, false };
+            m_backlog.push_back(std::move(stream));
+            if (auto h = std::exchange(m_acceptor, {})) h.resume(); // handler runs until its first wait
+            return next_state(conn);
+        }
+
+        // The stream reference is dropped before next_state(): a handler that finished
+        // while being resumed must be seen as gone.
+        el_connection_state on_read(connection& conn) {
+            if (auto stream = lookup(conn)) {
+                if (stream->m_reader && stream->pump_read()) {
+                    std::exchange(stream->m_reader, {}).resume();
+                }
+            } else {
+                conn.buffer->reset(); // closing, nobody reads anymore
+            }
+            return next_state(conn);
+        }
+
+        el_connection_state on_write(connection& conn) {
+            if (auto stream = lookup(conn)) {
+                if (stream->m_writer && stream->pump_write()) {
+                    std::exchange(stream->m_writer, {}).resume();
+                }
+                if (stream->m_flusher && conn.tx()->is_empty()) {
+                    std::exchange(stream->m_flusher, {}).resume();
+                }
+            }
+            return next_state(conn);
+        }
+
+        el_connection_state on_error(connection& conn, const std::string& what) {
+            if (conn.descriptor < 0 || (std::size_t)conn.descriptor >= m_slots.size()) {
+                return el_connection_state::die;
+            }
+            auto stream = m_slots[conn.descriptor].stream.lock();
+            m_slots[conn.descriptor] = {};
+            if (stream) stream->fail(what);
+            return el_connection_state::die;
+        }
+
+    private:
+        friend class async_stream;
+
+        struct slot {
+            std::weak_ptr<async_stream> stream;
+            bool closing = false;   // stream released, flush the tx ring and die
+        };
+
+        std::shared_ptr<async_stream> lookup(const connection& conn) const {
+            if ((std::size_t)conn.descriptor >= m_slots.size()) return nullptr;
+            return m_slots[conn.descriptor].stream.lock();
+        }
+
+        // Reads stay armed so input keeps buffering, writes while anything waits for the socket
+        el_connection_state next_state(connection& conn) {
+            auto& slot = m_slots[conn.descriptor];
+            auto stream = slot.stream.lock();
+            if (!stream) {
+                if (slot.closing && !conn.tx()->is_empty()) return el_connection_state::write;
+                slot = {};
+                return el_connection_state::die;
+            }
+            if (!stream->is_open()) {
+                slot = {};
+                return el_connection_state::die;
+            }
+            auto writing = stream->m_write_left != 0 || !conn.tx()->is_empty();
+            return writing ? el_connection_state::read_write : el_connection_state::read;
+        }
+
+        void release(int32_t descriptor) noexcept {
+            if ((std::size_t)descriptor < m_slots.size() && m_slots[descriptor].stream.expired()) {
+                m_slots[descriptor].closing = true;
+            }
+        }
+
+        std::vector<slot> m_slots; // by descriptor
+        std::deque<std::shared_ptr<async_stream>> m_backlog; // accepted, not handed out yet
+        std::coroutine_handle<> m_acceptor;
+        bool m_shutdown = false;
+    };
+
+    inline async_stream::~async_stream() {
+        if (is_open()) m_owner.release(m_descriptor);
+    }
+
+    // ── Loop binding ─────────────────────────────────────────────────
+
+    struct connect_handler final {
+        scheduler* s;
+        el_connection_state operator()(connection& c) const { return s->on_connect(c); }
+    };
+
+    struct read_handler final {
+        scheduler* s;
+        el_connection_state operator()(connection& c) const { return s->on_read(c); }
+    };
+
+    struct write_handler final {
+        scheduler* s;
+        el_connection_state operator()(connection& c) const { return s->on_write(c); }
+    };
+
+    struct error_handler final {
+        scheduler* s;
+        el_connection_state operator()(connection& c, const std::string& what) const { return s->on_error(c, what); }
+    };
+
+    // e.g. co::loop_t<event_loop_impl_t> or co::loop_t<uring_tcp_event_loop>
+    template<template<typename, typename, typename, typename> class TLoop>
+    using loop_t = TLoop<read_handler, write_handler, error_handler, connect_handler>;
+
+    template<template<typename, typename, typename, typename> class TLoop>
+    std::unique_ptr<loop_t<TLoop>> make_loop(scheduler& s) {
+        return std::make_unique<loop_t<TLoop>>(
+            connect_handler{ &s }, read_handler{ &s }, write_handler{ &s }, error_handler{ &s });
+    }
+
+}
@@ -0,0 +1,148 @@
+/* Copyright (C) 2026 Gleb Bezborodov - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: bezborodoff.gleb@gmail.com, or visit : https://github.com/glensand/hope-io
+ */
+
+#pragma once
+
+#include "hope-io/coredefs.h"
+
+#if PLATFORM_LINUX || PLATFORM_APPLE
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+namespace hope::io {
+
+    // Numeric socket address, IPv4 or IPv6, ready for connect()/bind()
+    struct endpoint final {
+        sockaddr_storage storage{};
+        socklen_t size = 0;
+
+        // ip must be a literal ("10.0.0.1", "::1"), no name resolution happens here.
+        // Returns false if it is neither.
+        static bool parse(std::string_view ip, uint16_t port, endpoint& out) {
+            char text[INET6_ADDRSTRLEN];
+            if (ip.size() >= sizeof(text)) return false;
+            std::memcpy(text, ip.data(), ip.size());
+            text[ip.size()] = '\0';
+
+            out = {};
+            auto* v4 = (sockaddr_in*)&out.storage;
+            if (inet_pton(AF_INET, text, &v4->sin_addr) == 1) {
+                v4->sin_family = AF_INET;
+                v4->sin_port = htons(port);
+                out.size = sizeof(sockaddr_in);
+                return true;
+            }
+            out = {};
+            auto* v6 = (sockaddr_in6*)&out.storage;
+            if (inet_pton(AF_INET6, text, &v6->sin6_addr) == 1) {
+                v6->sin6_family = AF_INET6;
+                v6->sin6_port = htons(port);
+                out.size = sizeof(sockaddr_in6);
+                return true;
+            }
+            return false;
+        }
+
+        // Address a listener binds to: a numeric IPv4/IPv6 literal, or empty for every
+        // interface on both stacks ("::" with IPV6_V6ONLY off, see listen_socket)
+        static bool for_listen(std::string_view host, uint16_t port, endpoint& out) {
+            return parse(host.empty() ? std::string_view("::") : host, port, out);
+        }
+
+        static endpoint any_v4(uint16_t port) {
+            endpoint out;
+            parse("0.0.0.0", port, out);
+            return out;
+        }
+
+        static endpoint from(const sockaddr* addr, socklen_t size) {
+            endpoint out;
+            if (size > sizeof(out.storage)) size = sizeof(out.storage);
+            std::memcpy(&out.storage, addr, size);
+            out.size = size;
+            return out;
+        }
+
+        int family() const noexcept { return storage.ss_family; }
+        const sockaddr* addr() const noexcept { return (const sockaddr*)&storage; }
+
+        uint16_t port() const noexcept {
+            return ntohs(family() == AF_INET6 ? ((const sockaddr_in6*)&storage)->sin6_port
+                                              : ((const sockaddr_in*)&storage)->sin_port);
+        }
+
+        void set_port(uint16_t port) noexcept {
+            if (family() == AF_INET6) ((sockaddr_in6*)&storage)->sin6_port = htons(port);
+            else ((sockaddr_in*)&storage)->sin_port = htons(port);
+        }
+
+        // ::ffff:a.b.c.d form of an IPv4 address, for IPv6 sockets
+        endpoint v4_mapped() const {
+            if (family() != AF_INET) return *this;
+            endpoint out;
+            auto* v6 = (sockaddr_in6*)&out.storage;
+            v6->sin6_family = AF_INET6;
+            v6->sin6_port = ((const sockaddr_in*)&storage)->sin_port;
+            v6->sin6_addr.s6_addr[10] = 0xff;
+            v6->sin6_addr.s6_addr[11] = 0xff;
+            std::memcpy(&v6->sin6_addr.s6_addr[12], &((const sockaddr_in*)&storage)->sin_addr, 4);
+            out.size = sizeof(sockaddr_in6);
+            return out;
+        }
+
+        // 0.0.0.0 or ::
+        bool is_any() const noexcept {
+            if (family() == AF_INET6) {
+                return IN6_IS_ADDR_UNSPECIFIED(&((const sockaddr_in6*)&storage)->sin6_addr);
+            }
+            return ((const sockaddr_in*)&storage)->sin_addr.s_addr == htonl(INADDR_ANY);
+        }
+
+        // Host part as text; IPv4 peers of a dual-stack socket print as plain IPv4
+        std::string host() const {
+            char text[INET6_ADDRSTRLEN] = {};
+            if (family() == AF_INET6) {
+                auto& a6 = ((const sockaddr_in6*)&storage)->sin6_addr;
+                if (IN6_IS_ADDR_V4MAPPED(&a6)) {
+                    inet_ntop(AF_INET, &a6.s6_addr[12], text, sizeof(text));
+                } else {
+                    inet_ntop(AF_INET6, &a6, text, sizeof(text));
+                }
+            } else if (family() == AF_INET) {
+                inet_ntop(AF_INET, &((const sockaddr_in*)&storage)->sin_addr, text, sizeof(text));
+            }
+            return text;
+        }
+    };
+
+    // socket(2) for a listener on at; an IPv6 socket gets IPV6_V6ONLY = v6_only. The wildcard
+    // "::" falls back to 0.0.0.0 on hosts without IPv6 and updates at. -1 and errno on failure.
+    inline int listen_socket(endpoint& at, int type, bool v6_only) {
+        int fd = ::socket(at.family(), type, 0);
+        if (fd == -1 && at.family() == AF_INET6 && at.is_any() && errno == EAFNOSUPPORT) {
+            at = endpoint::any_v4(at.port());
+            fd = ::socket(AF_INET, type, 0);
+        }
+        if (fd != -1 && at.family() == AF_INET6) {
+            int on = v6_only ? 1 : 0;
+            setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &on, sizeof(on));
+        }
+        return fd;
+    }
+
+}
+
+#endif
@@ -15,6 +15,9 @@
 #include <array>
 #include <vector>
 #include <cstring>
+#include <memory>
+#include <new>
+#include <algorithm>
 
 #include "hope-io/net/stream.h"
 #include "hope-io/net/acceptor.h"
@@ -25,27 +28,78 @@ namespace hope::io::el {
         idle,
         read,
         write,
+        read_write, // full duplex: rx and tx in flight at once, requires config::full_duplex
         die,
     };
 
+    constexpr bool wants_read(el_connection_state state) noexcept {
+        return state == el_connection_state::read || state == el_connection_state::read_write;
+    }
+
+    constexpr bool wants_write(el_connection_state state) noexcept {
+        return state == el_connection_state::write || state == el_connection_state::read_write;
+    }
+
+    // io_uring ring setup, the epoll and kqueue loops ignore it.
+    enum class uring_profile : uint8_t {
+        standard,       // no setup flags
+        sqpoll,         // SQPOLL: a kernel thread drains the SQ, submission needs no syscall while it is awake
+        single_issuer,  // SINGLE_ISSUER | DEFER_TASKRUN: completions are posted only when the loop waits, once per tick
+        coop_taskrun,   // COOP_TASKRUN | TASKRUN_FLAG: no interrupt per completion, task work runs at the next enter
+    };
+
+    struct uring_setup final {
+        uring_profile profile = uring_profile::standard;
+        int sqpoll_cpu = -1;             // sqpoll: pin the SQ thread to this CPU, -1 = unpinned
+        unsigned sqpoll_idle_ms = 1000;  // sqpoll: SQ thread sleeps after this long without submissions
+    };
+
     struct config final {
         std::size_t max_mutual_connections = 1024;
         std::size_t max_accepts_per_tick = 128;
         std::size_t port = 9393;
-        int epoll_temeout = 1000;
+        int epoll_temeout = 1000;                       // upper bound for one wait, timers shorten it
+        int idle_timeout_ms = 0;                        // close connections without traffic for this long, 0 = never
+        bool full_duplex = false;                       // separate rx (buffer) and tx (tx_buffer) rings per connection
+        bool reuse_port = false;                        // SO_REUSEPORT on the listen socket, lets several loops share one port
+        std::size_t num_shards = 0;                     // sharded_event_loop_t only: worker threads, 0 = hardware concurrency
+        bool uring_multishot = false;                   // io_uring: multishot accept + multishot recv into a provided buffer ring
+        std::size_t uring_buf_ring_entries = 1024;      // io_uring multishot: provided buffers, power of 2, max 32768
+        std::size_t uring_buf_size = 16 * 1024;         // io_uring multishot: bytes per provided buffer
+        std::size_t zero_copy_min_size = 16 * 1024;     // send_zero_copy: smaller segments are copied by plain send
+        bool uring_fixed_files = false;                 // io_uring tcp: accept into registered file slots, connection::descriptor is then a slot, not an fd
+        bool uring_fixed_buffers = false;               // io_uring tcp: register connection rings, single-shot recv/send use READ_FIXED/WRITE_FIXED
+        uring_setup uring_ring;                         // io_uring: ring setup profile
         hope::io::acceptor* custom_acceptor = nullptr;  // If provided, this acceptor will be used instead of creating a default one
         stream_options accepted_stream_options;     // Socket options applied to each accepted connection
+        bool listen = true;                             // false: client mode, run() opens no listen socket, connections come from connect()
+        int connect_timeout_ms = 3000;                  // connect(): default deadline for the handshake, 0 = kernel default
+        stream_options outbound_stream_options;         // Socket options applied to each connect() socket
+        std::string bind_address;                       // numeric IPv4/IPv6 to listen on, empty = all interfaces, both stacks
+        bool ipv6_only = false;                         // IPV6_V6ONLY on an IPv6 listener
+        std::vector<std::string> shard_bind_addresses;  // sharded_event_loop_t only: shard i binds [i % size] instead of bind_address
     };
 
     // Ring buffer with unbounded head/tail counters (no modulo on hot path).
-    // buffer_size is a power of 2, so masking (& mask) replaces modulo (% size).
+    // Capacity is one of size_classes (all powers of 2), so masking (& mask) replaces modulo (% size).
     // Layout: [ ... used ... | ... free ... ]  or  [ ... free ... used ... ]
     // Buffer is circular, with free space wrapping around to the start when full.
     // Buffer is not overwriting old data.
-    struct fixed_size_buffer final {
-        constexpr static std::size_t buffer_size = 512 * 1024; // 512 KB = 2^19
-        constexpr static auto buffer_mask = buffer_size - 1; // for &-based wrapping
-        using buffer_impl = std::array<unsigned char, buffer_size>;
+    // Storage is tiered: a full buffer steps up one size class when more data is offered,
+    // and steps down one class after shrink_epochs drains whose peak fitted the lower class.
+    // Regions handed out by get_free_region/get_used_region stay valid only until the
+    // next call that may resize (consume_free, write, get_free_region, advance_head, read).
+    struct tiered_buffer final {
+        constexpr static std::array<std::size_t, 3> size_classes = { 4 * 1024, 64 * 1024, 512 * 1024 };
+        constexpr static std::size_t min_capacity = size_classes.front();
+        constexpr static std::size_t max_capacity = size_classes.back();
+        constexpr static std::size_t shrink_epochs = 8;
+
+        explicit tiered_buffer(std::size_t size_class = 0)
+            : m_class(std::min(size_class, size_classes.size() - 1))
+            , m_capacity(size_classes[m_class])
+            , m_mask(m_capacity - 1)
+            , m_impl(new unsigned char[m_capacity]) {}
 
         std::size_t write(const void* data, std::size_t size) noexcept {
             auto remaining = size;
@@ -74,26 +128,27 @@ namespace hope::io::el {
         // Calls fn with each contiguous free region and advances tail by the return value.
         // The lambda receives (void* data, size_t capacity) and must return the number
         // of bytes written. Returning less than capacity stops iteration.
+        // When fn fills the buffer completely, it grows to the next size class and iteration continues.
         // Returns total bytes written across all regions.
         template<typename F>
         std::size_t consume_free(F&& fn) noexcept {
-            if (m_tail - m_head == buffer_size) return 0; // full
-
-            auto cur_free_space = free_space();
             std::size_t total = 0;
-            while (cur_free_space > 0) {
-                auto h = m_head & buffer_mask;
-                auto t = m_tail & buffer_mask;
-                auto end = std::min(t + cur_free_space, buffer_size);
+            while (true) {
+                auto cur_free_space = free_space();
+                if (cur_free_space == 0) {
+                    if (!grow()) break; // full at the largest class
+                    cur_free_space = free_space();
+                }
+                auto t = m_tail & m_mask;
+                auto end = std::min(t + cur_free_space, m_capacity);
                 auto chunk_size = end - t;
-                auto consumed = fn(m_impl.data() + t, chunk_size);
+                auto consumed = fn(m_impl.get() + t, chunk_size);
                 assert(consumed <= cur_free_space);
                 total += consumed;
                 m_tail += consumed;
-                if (consumed < chunk_size) return total;
-                cur_free_space -= consumed;
+                if (consumed < chunk_size) break;
             }
-
+            note_usage();
             return total;
         }
 
@@ -108,50 +163,52 @@ namespace hope::io::el {
             auto cur_count = count();
             std::size_t total = 0;
             while (cur_count > 0) {
-                auto h = m_head & buffer_mask;
-                auto end = std::min(h + cur_count, buffer_size);
+                auto h = m_head & m_mask;
+                auto end = std::min(h + cur_count, m_capacity);
                 auto chunk_size = end - h;
-                auto consumed = fn(m_impl.data() + h, chunk_size);
+                auto consumed = fn(m_impl.get() + h, chunk_size);
                 assert(consumed <= cur_count);
                 total += consumed;
                 m_head += consumed;
-                if (consumed < chunk_size) return total;
+                if (consumed < chunk_size) break;
                 cur_count -= consumed;
             }
-
+            if (m_head == m_tail) note_drained();
             return total;
         }
 
         // ── Direct access methods (for io_uring async I/O) ────────────
 
-        // Returns first contiguous free region for async recv to write into.
-        // Returns {nullptr, 0} if buffer is full.
+        // Returns first contiguous free region for async recv to write into, growing a full buffer.
+        // Returns {nullptr, 0} if buffer is full at the largest size class.
         std::pair<void*, std::size_t> get_free_region() noexcept {
-            if (m_tail - m_head >= buffer_size) return {nullptr, 0};
-            auto h = m_head & buffer_mask;
-            auto t = m_tail & buffer_mask;
-            auto size = (h > t) ? (h - t) : (buffer_size - t);
-            return {m_impl.data() + t, size};
+            if (m_tail - m_head >= m_capacity && !grow()) return {nullptr, 0};
+            auto h = m_head & m_mask;
+            auto t = m_tail & m_mask;
+            auto size = (h > t) ? (h - t) : (m_capacity - t);
+            return {m_impl.get() + t, size};
         }
 
         // Advance tail by n bytes after successful async recv.
         void advance_tail(std::size_t n) noexcept {
             m_tail += n;
+            note_usage();
         }
 
         // Returns first contiguous used region for async send to read from.
         // Returns {nullptr, 0} if buffer is empty.
         std::pair<const void*, std::size_t> get_used_region() const noexcept {
             if (m_tail == m_head) return {nullptr, 0};
-            auto h = m_head & buffer_mask;
-            auto t = m_tail & buffer_mask;
-            auto size = (h <= t) ? (t - h) : (buffer_size - h);
-            return {m_impl.data() + h, size};
+            auto h = m_head & m_mask;
+            auto t = m_tail & m_mask;
+            auto size = (h <= t) ? (t - h) : (m_capacity - h);
+            return {m_impl.get() + h, size};
         }
 
         // Advance head by n bytes after successful async send.
         void advance_head(std::size_t n) noexcept {
             m_head += n;
+            if (m_head == m_tail) note_drained();
         }
 
         // Returns the first contiguous used region without advancing head.
@@ -165,36 +222,117 @@ namespace hope::io::el {
             m_tail = 0;
         }
 
+        // Drops to the smallest size class that holds the current content.
+        void shrink_to_fit() noexcept {
+            auto target = std::size_t(0);
+            while (size_classes[target] < count()) ++target;
+            if (target < m_class) resize(target);
+        }
+
         bool is_empty() const noexcept {
             return m_head == m_tail;
         }
 
         std::size_t count() const noexcept {
-            assert(m_tail - m_head <= buffer_size);
+            assert(m_tail - m_head <= m_capacity);
             auto c = m_tail - m_head;
             return c;
         }
 
         std::size_t free_space() const noexcept {
-            return buffer_size - count();
+            return m_capacity - count();
         }
 
-        const buffer_impl& get_buffer() const noexcept { return m_impl; }
+        std::size_t capacity() const noexcept { return m_capacity; }
+        std::size_t size_class() const noexcept { return m_class; }
+
+        // Whole backing storage and a counter bumped whenever it is replaced,
+        // lets io_uring keep the storage registered until the buffer changes size class.
+        std::pair<void*, std::size_t> storage() noexcept { return {m_impl.get(), m_capacity}; }
+        uint32_t storage_generation() const noexcept { return m_generation; }
+
+        // A pinned buffer never resizes, regions handed to in-flight async I/O stay valid.
+        void pin() noexcept { ++m_pins; }
+        void unpin() noexcept { assert(m_pins > 0); --m_pins; }
+        bool is_pinned() const noexcept { return m_pins != 0; }
 
     private:
-        buffer_impl m_impl;
-        // Unbounded counters — grow monotonically, masked on access (& buffer_mask).
+        bool grow() noexcept {
+            if (m_class + 1 == size_classes.size()) return false;
+            return resize(m_class + 1);
+        }
+
+        void note_usage() noexcept {
+            m_peak = std::max(m_peak, count());
+        }
+
+        // Called each time the buffer drains, the peak since the previous drain decides the step down.
+        void note_drained() noexcept {
+            if (m_class != 0 && m_peak <= size_classes[m_class - 1]) {
+                if (++m_low_epochs >= shrink_epochs) {
+                    resize(m_class - 1);
+                }
+            } else {
+                m_low_epochs = 0;
+            }
+            m_peak = 0;
+        }
+
+        // Moves content into storage of the given class, linearized at offset 0.
+        bool resize(std::size_t size_class) noexcept {
+            if (m_pins != 0) return false;
+            auto new_capacity = size_classes[size_class];
+            auto* storage = new (std::nothrow) unsigned char[new_capacity];
+            if (!storage) return false;
+            auto used = count();
+            assert(used <= new_capacity);
+            auto h = m_head & m_mask;
+            auto first = std::min(used, m_capacity - h);
+            std::memcpy(storage, m_impl.get() + h, first);
+            std::memcpy(storage + first, m_impl.get(), used - first);
+            m_impl.reset(storage);
+            ++m_generation;
+            m_class = size_class;
+            m_capacity = new_capacity;
+            m_mask = new_capacity - 1;
+            m_head = 0;
+            m_tail = used;
+            m_peak = used;
+            m_low_epochs = 0;
+            return true;
+        }
+
+        std::size_t m_class;
+        std::size_t m_capacity;
+        std::size_t m_mask; // for &-based wrapping
+        std::unique_ptr<unsigned char[]> m_impl;
+        // Unbounded counters — grow monotonically, masked on access (& m_mask).
         std::size_t m_tail = 0;
         std::size_t m_head = 0;
+        std::size_t m_peak = 0;
+        std::size_t m_low_epochs = 0;
+        uint32_t m_pins = 0;
+        uint32_t m_generation = 0;
     };
 
+    // Historical name, connection buffers used to be a fixed 512 KB array.
+    using fixed_size_buffer = tiered_buffer;
+
     struct connection final {
         connection() = default;
         connection(int32_t in_descriptor) {
             descriptor = in_descriptor;
         }
-        fixed_size_buffer* buffer = nullptr;
+        // rx ring; with config::full_duplex == false it also carries the reply
+        tiered_buffer* buffer = nullptr;
+        // tx ring, allocated only with config::full_duplex
+        tiered_buffer* tx_buffer = nullptr;
         int32_t descriptor = -1;
+        // Caller's tag for connections opened with connect(), 0 for accepted ones
+        uint64_t tag = 0;
+
+        // Ring the loop sends from
+        tiered_buffer* tx() const noexcept { return tx_buffer ? tx_buffer : buffer; }
 
         auto get_state() const noexcept { return state; }
 
@@ -217,24 +355,28 @@ namespace hope::io::el {
         el_connection_state state = el_connection_state::idle;
     };
 
+    // Pooled buffers always sit in the smallest size class, a new connection
+    // starts at tiered_buffer::min_capacity and grows with its traffic.
     struct buffer_pool final {
-        fixed_size_buffer* allocate() {
+        tiered_buffer* allocate() {
             if (!m_impl.empty()) {
                 auto* buf = m_impl.back();
                 m_impl.pop_back();
                 return buf;
             }
-            return new fixed_size_buffer;
+            return new tiered_buffer;
         }
 
-        void redeem(fixed_size_buffer* b) {
+        void redeem(tiered_buffer* b) {
+            assert(!b->is_pinned());
             b->reset();
+            b->shrink_to_fit();
             m_impl.emplace_back(b);
         }
 
         void prepool(std::size_t count) {
             for (auto i = 0; i < count; ++i)
-                m_impl.emplace_back(new fixed_size_buffer);
+                m_impl.emplace_back(new tiered_buffer);
         }
 
         void drain() {
@@ -242,7 +384,7 @@ namespace hope::io::el {
             m_impl.clear();
         }
     private:
-        std::vector<fixed_size_buffer*> m_impl;
+        std::vector<tiered_buffer*> m_impl;
     };
 
     template<typename TOnRead, typename TOnWrite, typename TOnError, typename TConnected>
@@ -10,7 +10,11 @@
 
 #include "hope-io/coredefs.h"
 #include "hope-io/net/event_loop.h"
+#include "hope-io/net/endpoint.h"
 #include "hope-io/net/stream_options_util.h"
+#include "hope-io/net/linux/post_queue.h"
+#include "hope-io/net/timer_wheel.h"
+#include "hope-io/net/zero_copy.h"
 
 #if PLATFORM_LINUX
 
@@ -18,12 +22,12 @@
 #include <atomic>
 #include <sys/epoll.h>
 
-#include <fcntl.h>
 #include <unistd.h>
 #include <arpa/inet.h>
 #include <sys/socket.h>
 #include <netinet/ip.h>
 #include <netinet/tcp.h>
+#include <linux/errqueue.h>
 #include <cstring>
 #include <cerrno>
 
@@ -49,32 +53,45 @@ namespace hope::io::el {
         void run(const config& cfg) override {
             THREAD_SCOPE(EVENT_LOOP_THREAD);
 
-            m_listen_socket = socket(AF_INET, SOCK_STREAM, 0);
-            if (m_listen_socket == -1) {
-                throw_bind_err();
-            }
+            if (cfg.listen) {
+                endpoint srv_addr;
+                if (!endpoint::for_listen(cfg.bind_address, (uint16_t)cfg.port, srv_addr)) {
+                    HOPE_THROW("event_loop", "bind_address is not a numeric IPv4/IPv6 address: " + cfg.bind_address);
+                }
+                m_listen_socket = listen_socket(srv_addr, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, cfg.ipv6_only);
+                if (m_listen_socket == -1) {
+                    throw_bind_err();
+                }
+
+                int reuse = 1;
+                setsockopt(m_listen_socket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+                if (cfg.reuse_port) {
+                    // Kernel load-balances incoming connections between all listeners bound with SO_REUSEPORT
+                    setsockopt(m_listen_socket, SOL_SOCKET, SO_REUSEPORT, &reuse, sizeof(reuse));
+                }
 
-            int reuse = 1;
-            setsockopt(m_listen_socket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+                if (bind(m_listen_socket, srv_addr.addr(), srv_addr.size) == -1) {
+                    throw_bind_err();
+                }
 
-            sockaddr_in srv_addr{};
-            srv_addr.sin_family = AF_INET;
-            srv_addr.sin_addr.s_addr = INADDR_ANY;
-            srv_addr.sin_port = htons(cfg.port);
-            if (bind(m_listen_socket, (struct sockaddr*)&srv_addr, sizeof(srv_addr)) == -1) {
-                throw_bind_err();
+                m_accept_options = socket_option_list(cfg.accepted_stream_options);
+                m_accept_options.take_inherited().apply(m_listen_socket);
+                listen(m_listen_socket, cfg.max_mutual_connections);
             }
-
-            auto flags = fcntl(m_listen_socket, F_GETFL, 0);
-            fcntl(m_listen_socket, F_SETFL, flags | O_NONBLOCK);
-            listen(m_listen_socket, cfg.max_mutual_connections);
+            m_connect_options = socket_option_list(cfg.outbound_stream_options);
 
             m_epfd = epoll_create(1);
-            epoll_ctl_add(m_epfd, m_listen_socket, EPOLLIN | EPOLLOUT | EPOLLET);
+            if (m_listen_socket != -1) {
+                epoll_ctl_add(m_epfd, m_listen_socket, EPOLLIN | EPOLLOUT | EPOLLET);
+            }
+            // Level triggered, stays readable until drained
+            epoll_ctl_add(m_epfd, m_posts.fd(), EPOLLIN);
 
             m_pl.prepool(cfg.max_mutual_connections);
             m_events.resize(cfg.max_mutual_connections);
             m_connections.resize(cfg.max_mutual_connections);
+            m_zc.resize(cfg.max_mutual_connections);
+            m_interest.resize(cfg.max_mutual_connections);
             m_cfg = cfg;
 
             while (m_running.load(std::memory_order_acquire)) {
@@ -82,25 +99,61 @@ namespace hope::io::el {
                 auto nfds = 0;
                 {
                     NAMED_SCOPE(Epoll);
-                    nfds = epoll_wait(m_epfd, m_events.data(), (int)m_events.size(), cfg.epoll_temeout);
+                    nfds = epoll_wait(m_epfd, m_events.data(), (int)m_events.size(),
+                                      m_accept_backlog ? 0 : m_timers.next_timeout_ms(cfg.epoll_temeout));
                 }
                 for (auto i = 0; i < nfds; i++) {
                     NAMED_SCOPE(ProcessOneEvent);
                     auto&& event = m_events[i];
                     auto sock = event.data.fd;
+                    auto events = event.events;
+                    if (is_connecting(sock)) {
+                        handle_connect_event(sock, events);
+                        continue;
+                    }
+                    // MSG_ZEROCOPY completions raise EPOLLERR without a socket error
+                    if ((events & EPOLLERR) && sock != m_listen_socket && sock != m_posts.fd()
+                        && m_zc[sock].so_zerocopy == 1 && !drain_error_queue(sock)) {
+                        events &= ~EPOLLERR;
+                    }
                     if (sock == m_listen_socket) {
                         handle_accept();
-                    } else if (event.events & EPOLLIN) {
-                        handle_read(m_connections[sock]);
-                    } else if (event.events & EPOLLOUT) {
-                        handle_write(m_connections[sock]);
-                    } else if (event.events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
-                        remove_connection(sock);
+                    } else if (sock == m_posts.fd()) {
+                        handle_posts();
+                    } else if (m_zc[sock].lingering) {
+                        // Removed connection waiting for its last MSG_ZEROCOPY notifications
+                        if (m_zc[sock].in_flight.empty()) {
+                            close_socket(sock);
+                        }
+                    } else if (events & (EPOLLIN | EPOLLOUT)) {
+                        auto& conn = m_connections[sock];
+                        if ((events & EPOLLIN) && wants_read(conn.get_state())) {
+                            handle_read(conn);
+                        }
+                        // Full duplex: the same event may carry both directions
+                        if ((events & EPOLLOUT) && conn.buffer && wants_write(conn.get_state())
+                            && (!conn.tx_buffer || has_output(conn))) {
+                            handle_write(conn);
+                        }
+                        sync_interest(conn);
+                    } else if (events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                        drop_connection(sock, "connection closed by peer");
                     }
                 }
+                if (m_accept_backlog) {
+                    handle_accept();
+                }
+                m_timers.advance(timer_wheel::clock::now());
             }
 
-            ::close(m_listen_socket);
+            for (std::size_t fd = 0; fd < m_outbound.size(); ++fd) {
+                if (m_outbound[fd].pending) ::close((int32_t)fd);
+            }
+            m_outbound.clear();
+            for (std::size_t fd = 0; fd < m_zc.size(); ++fd) {
+                if (m_zc[fd].lingering) close_socket((int32_t)fd);
+            }
+            if (m_listen_socket != -1) ::close(m_listen_socket);
             m_listen_socket = -1;
         }
 
@@ -108,6 +161,69 @@ namespace hope::io::el {
             m_running = false;
         }
 
+        struct epoll_stats {
+            uint64_t ctl_mod = 0;           // EPOLL_CTL_MOD issued
+            uint64_t ctl_mod_skipped = 0;   // state changes whose interest was already armed
+        };
+
+        // Loop thread, or after run() returned
+        const epoll_stats& stats() const noexcept { return m_stats; }
+
+        // Thread safe. Appends bytes to the connection's tx ring on the loop thread and starts
+        // sending. Half-duplex connections accept posts only while writing or with no unread
+        // input, use config::full_duplex for connections that also read. Descriptors are reused
+        // after close, producers must stop posting to a connection once on_err/die was seen.
+        void post(int32_t descriptor, std::vector<unsigned char> bytes) {
+            m_posts.push({ descriptor, std::move(bytes), {} });
+        }
+
+        // Thread safe. Runs fn on the loop thread.
+        void post(std::function<void()> fn) {
+            m_posts.push({ -1, {}, std::move(fn) });
+        }
+
+        // Loop thread only (from a callback or post(fn)). Queues buffer behind the bytes
+        // already in the tx ring and sends it straight from its memory with MSG_ZEROCOPY;
+        // buffer.owner is released once the kernel reports the pages are no longer read.
+        // Segments below config::zero_copy_min_size skip MSG_ZEROCOPY but still bypass the ring.
+        // Same half-duplex rule as post().
+        void send_zero_copy(int32_t descriptor, zc_buffer buffer) {
+            if (descriptor < 0 || (std::size_t)descriptor >= m_connections.size()) return;
+            auto& conn = m_connections[descriptor];
+            if (!conn.buffer) return;
+            if (!can_output(conn)) {
+                report_post_error(conn, "send_zero_copy: half-duplex connection holds unread input, enable config::full_duplex");
+                return;
+            }
+            if (buffer.size == 0) return;
+            m_zc[descriptor].push(std::move(buffer), conn.tx()->count());
+            start_output(conn);
+        }
+
+        // Thread safe. Opens an outbound connection to ip:port (numeric IPv4 or IPv6) from the
+        // loop thread; once established it goes through on_connect and the same state machine
+        // as an accepted one, with connection::tag == tag. A failed, refused or timed out attempt
+        // reports on_err with descriptor -1 and the tag. timeout 0 takes config::connect_timeout_ms.
+        void connect(std::string_view ip, uint16_t port, uint64_t tag = 0,
+                     std::chrono::milliseconds timeout = std::chrono::milliseconds(0)) {
+            endpoint to;
+            if (!endpoint::parse(ip, port, to)) {
+                post([this, tag] { report_connect_error(tag, "connect: not a numeric IPv4/IPv6 address"); });
+                return;
+            }
+            post([this, to, tag, timeout] { start_connect(to, tag, timeout); });
+        }
+
+        // Loop thread only (callbacks or post(fn)). fn runs once after delay.
+        timer_wheel::timer_id add_timer(std::chrono::milliseconds delay, std::function<void()> fn) {
+            return m_timers.schedule(delay, std::move(fn));
+        }
+
+        // Loop thread only. Returns false if the timer already fired.
+        bool cancel_timer(timer_wheel::timer_id id) {
+            return m_timers.cancel(id);
+        }
+
     private:
         using buffer_pool = hope::io::el::buffer_pool;
 
@@ -121,46 +237,57 @@ namespace hope::io::el {
             }
         }
 
+        static uint32_t interest_of(el_connection_state state) noexcept {
+            uint32_t events = EPOLLRDHUP | EPOLLHUP | EPOLLET;
+            if (wants_read(state)) events |= EPOLLIN;
+            if (wants_write(state)) events |= EPOLLOUT;
+            return events;
+        }
+
+        // Records the state only, the epoll interest follows once per event in sync_interest:
+        // a read -> write -> read round trip that finishes inline never touches epoll.
         void apply_state(connection& conn, el_connection_state state) {
-                    if (state == el_connection_state::die) {
-                        remove_connection(conn.descriptor);
-                        return;
-                    }
-                    conn.set_state(state);
-                    epoll_event ev;
-                    ev.events = EPOLLRDHUP | EPOLLHUP | EPOLLET;
-                    ev.data.fd = conn.descriptor;
-                    if (state == el_connection_state::read) {
-                        ev.events |= EPOLLIN;
-                    } else if (state == el_connection_state::write) {
-                        ev.events |= EPOLLOUT;
-                    }
-                    epoll_ctl(m_epfd, EPOLL_CTL_MOD, conn.descriptor, &ev);
-                }
+            if (state == el_connection_state::die) {
+                remove_connection(conn.descriptor);
+                return;
+            }
+            assert(state != el_connection_state::read_write || conn.tx_buffer);
+            conn.set_state(state);
+        }
+
+        // EPOLL_CTL_MOD only if the wanted interest differs from the armed one.
+        void sync_interest(connection& conn) {
+            if (!conn.buffer) return; // removed meanwhile
+            auto want = interest_of(conn.get_state());
+            auto& armed = m_interest[conn.descriptor];
+            if (armed == want) {
+                ++m_stats.ctl_mod_skipped;
+                return;
+            }
+            epoll_event ev;
+            ev.events = want;
+            ev.data.fd = conn.descriptor;
+            epoll_ctl(m_epfd, EPOLL_CTL_MOD, conn.descriptor, &ev);
+            armed = want;
+            ++m_stats.ctl_mod;
+        }
 
+        // The listener is edge triggered: when the per-tick budget runs out before accept4
+        // reports EAGAIN, the rest of the queue is taken on the following ticks.
         void handle_accept() {
             NAMED_SCOPE(HandleAccept);
+            m_accept_backlog = true;
             for (auto i = 0; i < m_cfg.max_accepts_per_tick; ++i) {
                 NAMED_SCOPE(AcceptOne);
-                struct sockaddr_in client_addr = {};
-                socklen_t socklen = sizeof(client_addr);
-                int sock = accept(m_listen_socket, (struct sockaddr *)&client_addr, &socklen);
-                if (sock == -1) break;
-
-                int flags = fcntl(sock, F_GETFL, 0);
-                if (flags == -1) {
-                    ::close(sock);
+                // Peer address is never used, flags spare the two fcntl calls per connection
+                int sock = accept4(m_listen_socket, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                if (sock == -1) {
+                    // EAGAIN: drained; EMFILE and friends: retrying right away would spin
+                    m_accept_backlog = errno == EINTR || errno == ECONNABORTED;
                     break;
                 }
-                flags |= O_NONBLOCK;
-                if (fcntl(sock, F_SETFL, flags) == -1) {
-                    connection dumb;
-                    m_on_err(dumb, "Cannot set flags for connection, skip this one");
-                    ::close(sock);
-                    continue;
-                }
 
-                apply_stream_options(sock, m_cfg.accepted_stream_options);
+                m_accept_options.apply(sock);
                 push_new_connection(sock);
                 auto state = m_on_connect(m_connections[sock]);
 
@@ -169,77 +296,386 @@ namespace hope::io::el {
                     continue;
                 }
                 m_connections[sock].set_state(state);
+                m_interest[sock] = interest_of(state);
+                epoll_ctl_add(m_epfd, sock, m_interest[sock]);
+                m_idle.arm(sock, std::chrono::milliseconds(m_cfg.idle_timeout_ms));
+            }
+        }
 
-                uint32_t epoll_events = EPOLLRDHUP | EPOLLHUP | EPOLLET;
-                if (state == el_connection_state::read) {
-                    epoll_events |= EPOLLIN;
-                } else if (state == el_connection_state::write) {
-                    epoll_events |= EPOLLOUT;
-                }
-                epoll_ctl_add(m_epfd, sock, epoll_events);
+        // ── Outbound connections ─────────────────────────────────────────────
+
+        struct outbound final {
+            uint64_t tag = 0;
+            bool pending = false;   // connect() in flight, the socket is not a connection yet
+        };
+
+        bool is_connecting(int32_t fd) const noexcept {
+            return (std::size_t)fd < m_outbound.size() && m_outbound[fd].pending;
+        }
+
+        void start_connect(const endpoint& to, uint64_t tag, std::chrono::milliseconds timeout) {
+            NAMED_SCOPE(StartConnect);
+            int sock = socket(to.family(), SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if (sock == -1) {
+                report_connect_error(tag, std::string("connect: socket failed: ") + strerror(errno));
+                return;
+            }
+            m_connect_options.apply(sock);
+            if (::connect(sock, to.addr(), to.size) == 0) {
+                establish(sock, tag, false);
+                return;
+            }
+            if (errno != EINPROGRESS) {
+                auto what = std::string("connect failed: ") + strerror(errno);
+                ::close(sock);
+                report_connect_error(tag, what);
+                return;
+            }
+            // Writable once the handshake is over, SO_ERROR tells how it went
+            epoll_event ev;
+            ev.events = EPOLLOUT | EPOLLET;
+            ev.data.fd = sock;
+            if (epoll_ctl(m_epfd, EPOLL_CTL_ADD, sock, &ev) == -1) {
+                auto what = std::string("connect: epoll_ctl ADD failed: ") + strerror(errno);
+                ::close(sock);
+                report_connect_error(tag, what);
+                return;
+            }
+            if ((std::size_t)sock >= m_outbound.size()) m_outbound.resize(sock + 1);
+            m_outbound[sock] = { tag, true };
+            if (timeout.count() == 0) timeout = std::chrono::milliseconds(m_cfg.connect_timeout_ms);
+            m_connect_deadlines.arm(sock, timeout);
+        }
+
+        void handle_connect_event(int32_t sock, uint32_t events) {
+            NAMED_SCOPE(HandleConnect);
+            int error = 0;
+            socklen_t len = sizeof(error);
+            if (getsockopt(sock, SOL_SOCKET, SO_ERROR, &error, &len) == -1) {
+                error = errno;
+            }
+            if (error == 0 && (events & (EPOLLERR | EPOLLHUP))) {
+                error = ECONNRESET;
+            }
+            if (error != 0) {
+                fail_connect(sock, error);
+                return;
+            }
+            m_connect_deadlines.disarm(sock);
+            m_outbound[sock].pending = false;
+            establish(sock, m_outbound[sock].tag, true);
+        }
+
+        // registered: the socket already sits in epoll with EPOLLOUT from the handshake
+        void establish(int32_t sock, uint64_t tag, bool registered) {
+            push_new_connection(sock);
+            auto& conn = m_connections[sock];
+            conn.tag = tag;
+            auto state = m_on_connect(conn);
+            if (state == el_connection_state::die) {
+                remove_connection(sock);
+                return;
+            }
+            conn.set_state(state);
+            if (registered) {
+                m_interest[sock] = EPOLLOUT | EPOLLET;
+            } else {
+                m_interest[sock] = interest_of(state);
+                epoll_ctl_add(m_epfd, sock, m_interest[sock]);
             }
+            // A fresh socket is writable, a request queued by on_connect leaves right away
+            if (wants_write(state) && has_output(conn)) {
+                handle_write(conn);
+            }
+            if (!conn.buffer) return;
+            sync_interest(conn);
+            m_idle.arm(sock, std::chrono::milliseconds(m_cfg.idle_timeout_ms));
+        }
+
+        void fail_connect(int32_t sock, int error) {
+            m_connect_deadlines.disarm(sock);
+            m_outbound[sock].pending = false;
+            epoll_ctl(m_epfd, EPOLL_CTL_DEL, sock, NULL);
+            ::close(sock);
+            report_connect_error(m_outbound[sock].tag, std::string("connect failed: ") + strerror(error));
+        }
+
+        void report_connect_error(uint64_t tag, const std::string& what) {
+            connection failed;
+            failed.tag = tag;
+            m_on_err(failed, what);
         }
 
         void handle_read(connection& conn) {
             NAMED_SCOPE(HandleRead);
-            assert(conn.get_state() == el_connection_state::read);
+            assert(wants_read(conn.get_state()));
+            m_idle.touch(conn.descriptor);
             bool error = false;
+            bool drained = false;
             conn.buffer->consume_free([&](void* data, std::size_t size) -> std::size_t {
                 auto received = ::recv(conn.descriptor, (char*)data, size, 0);
-                if (received <= 0 && errno != EAGAIN) {
+                // 0 is EOF whatever errno still says
+                if (received == 0 || (received < 0 && errno != EAGAIN)) {
                     auto err_state = m_on_err(conn, "Cannot read from socket, close connection");
                     error = true;
                     apply_state(conn, err_state);
-                    return size;
+                    return 0; // stop here, the buffer may already be back in the pool
                 } else if (received <= 0) {
+                    drained = true;
                     return 0;
                 }
+                drained = (std::size_t)received < size;
                 return (std::size_t)received;
             });
-            if (!error && !conn.buffer->is_empty()) {
+            if (error) return;
+            if (!drained) {
+                // Stopped on a full buffer with bytes left in the socket: no new edge will come,
+                // force the next sync to MOD, which re-reports the pending input
+                m_interest[conn.descriptor] = 0;
+            }
+            if (!conn.buffer->is_empty()) {
                 auto state = m_on_read(conn);
                 if (state != el_connection_state::idle) {
                     apply_state(conn, state);
                 }
+                // Reply right away: the socket is almost always writable, EPOLLOUT is only
+                // armed if this send blocks
+                if (conn.buffer && wants_write(conn.get_state()) && has_output(conn)) {
+                    handle_write(conn);
+                }
             }
         }
 
         void handle_write(connection& conn) {
             NAMED_SCOPE(HandleWrite);
-            assert(conn.get_state() == el_connection_state::write);
-            conn.buffer->consume_used([&](const void* data, std::size_t size) -> std::size_t {
-                auto op_res = send(conn.descriptor, (char*)data, size, 0);
-                if (op_res <= 0 && errno != EAGAIN) {
+            assert(wants_write(conn.get_state()));
+            m_idle.touch(conn.descriptor);
+            auto& zc = m_zc[conn.descriptor];
+            // on_write may queue more output and keep writing, send it while the socket takes it
+            while (true) {
+                auto* tx = conn.tx();
+                auto status = send_status::progress;
+                // Ring bytes and zero-copy segments go out in the order they were queued
+                while (status == send_status::progress) {
+                    auto budget = zc.ring_budget();
+                    if (budget != 0 && !tx->is_empty()) {
+                        status = send_ring(conn, budget);
+                    } else if (!zc.empty()) {
+                        status = send_segment(conn, zc);
+                    } else {
+                        break;
+                    }
+                }
+                if (status == send_status::error) {
                     auto err_state = m_on_err(conn, "Cannot write to socket, close connection");
                     apply_state(conn, err_state);
-                    return size;
-                } else if (op_res <= 0) {
-                    return 0;
+                    return;
                 }
-                return (std::size_t)op_res;
-            });
-            if (conn.buffer->is_empty()) {
+                if (!conn.buffer || !tx->is_empty() || !zc.empty()) return; // blocked, wait for EPOLLOUT
                 auto state = m_on_write(conn);
                 if (state != el_connection_state::idle) {
                     apply_state(conn, state);
                 }
+                if (!conn.buffer || !wants_write(conn.get_state()) || !has_output(conn)) return;
+            }
+        }
+
+        enum class send_status : uint8_t { progress, blocked, error };
+
+        send_status send_ring(connection& conn, std::size_t budget) {
+            auto status = send_status::progress;
+            std::size_t sent = 0;
+            conn.tx()->consume_used([&](const void* data, std::size_t size) -> std::size_t {
+                auto op_res = send(conn.descriptor, (char*)data, std::min(size, budget - sent), 0);
+                if (op_res <= 0) {
+                    status = errno == EAGAIN ? send_status::blocked : send_status::error;
+                    return 0;
+                }
+                sent += (std::size_t)op_res;
+                return (std::size_t)op_res;
+            });
+            m_zc[conn.descriptor].on_ring_sent(sent);
+            return status;
+        }
+
+        send_status send_segment(connection& conn, zc_queue& zc) {
+            auto& s = zc.pending.front();
+            auto* data = (const char*)s.buffer.data + s.offset;
+            auto size = s.buffer.size - s.offset;
+            auto zero_copy = size >= m_cfg.zero_copy_min_size && enable_zero_copy(conn.descriptor, zc);
+            auto op_res = send(conn.descriptor, data, size, zero_copy ? MSG_ZEROCOPY : 0);
+            if (op_res < 0 && zero_copy && errno == ENOBUFS) {
+                // optmem limit reached while notifications are outstanding, copy this one
+                zero_copy = false;
+                op_res = send(conn.descriptor, data, size, 0);
+            }
+            if (op_res <= 0) {
+                return errno == EAGAIN ? send_status::blocked : send_status::error;
+            }
+            if (zero_copy) {
+                // Every successful MSG_ZEROCOPY send() takes the next notification sequence
+                s.zero_copy = true;
+                s.last_seq = zc.next_seq++;
             }
+            s.offset += (std::size_t)op_res;
+            if (s.offset == s.buffer.size) {
+                zc.on_segment_sent();
+            }
+            return send_status::progress;
+        }
+
+        bool enable_zero_copy(int32_t descriptor, zc_queue& zc) {
+            if (zc.so_zerocopy == -1) {
+                int one = 1;
+                zc.so_zerocopy = setsockopt(descriptor, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one)) == 0 ? 1 : 0;
+            }
+            return zc.so_zerocopy == 1;
+        }
+
+        // Reads MSG_ZEROCOPY notifications off the error queue and releases the covered
+        // segments. Returns true if the socket also has a real error pending.
+        bool drain_error_queue(int32_t descriptor) {
+            auto& zc = m_zc[descriptor];
+            char control[128];
+            while (true) {
+                msghdr msg{};
+                msg.msg_control = control;
+                msg.msg_controllen = sizeof(control);
+                if (recvmsg(descriptor, &msg, MSG_ERRQUEUE) == -1) break;
+                for (auto* cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+                    sock_extended_err err;
+                    std::memcpy(&err, CMSG_DATA(cm), sizeof(err));
+                    if (err.ee_origin == SO_EE_ORIGIN_ZEROCOPY && err.ee_errno == 0) {
+                        // [ee_info, ee_data] is the range of completed send() calls
+                        zc.release_through(err.ee_data);
+                    }
+                }
+            }
+            int error = 0;
+            socklen_t len = sizeof(error);
+            getsockopt(descriptor, SOL_SOCKET, SO_ERROR, &error, &len);
+            return error != 0;
+        }
+
+        bool has_output(const connection& conn) const {
+            return !conn.tx()->is_empty() || !m_zc[conn.descriptor].empty();
+        }
+
+        // Half duplex shares one ring between directions, output may only start while
+        // writing or with no unread input
+        static bool can_output(const connection& conn) {
+            return conn.tx_buffer || wants_write(conn.get_state()) || conn.buffer->is_empty();
+        }
+
+        void start_output(connection& conn) {
+            if (!wants_write(conn.get_state())) {
+                apply_state(conn, conn.tx_buffer ? el_connection_state::read_write : el_connection_state::write);
+            }
+            // EPOLLOUT is edge triggered, push what the socket takes right now
+            if (conn.buffer && wants_write(conn.get_state())) {
+                handle_write(conn);
+            }
+            sync_interest(conn);
+        }
+
+        void handle_posts() {
+            NAMED_SCOPE(HandlePosts);
+            m_posts.drain([this](post_queue::task& task) {
+                if (task.fn) {
+                    task.fn();
+                } else {
+                    deliver_post(task.descriptor, task.bytes);
+                }
+            });
+        }
+
+        void deliver_post(int32_t descriptor, const std::vector<unsigned char>& bytes) {
+            if (descriptor < 0 || (std::size_t)descriptor >= m_connections.size()) return;
+            auto& conn = m_connections[descriptor];
+            if (!conn.buffer) return; // closed meanwhile
+
+            if (!can_output(conn)) {
+                report_post_error(conn, "post: half-duplex connection holds unread input, enable config::full_duplex");
+                return;
+            }
+            if (conn.tx()->write(bytes.data(), bytes.size()) != bytes.size()) {
+                report_post_error(conn, "post: tx ring overflow");
+                return;
+            }
+            start_output(conn);
+        }
+
+        void report_post_error(connection& conn, const char* what) {
+            auto state = m_on_err(conn, what);
+            if (state != el_connection_state::idle) {
+                apply_state(conn, state);
+                sync_interest(conn);
+            }
+        }
+
+        void expire_idle(int32_t descriptor) {
+            drop_connection(descriptor, "idle timeout, close connection");
+        }
+
+        // The connection is going away regardless of what on_err answers
+        void drop_connection(int32_t descriptor, const char* what) {
+            auto& conn = m_connections[descriptor];
+            if (!conn.buffer) return;
+            m_on_err(conn, what);
+            if (conn.buffer) remove_connection(descriptor);
         }
 
         void remove_connection(int32_t descriptor) {
+            m_idle.disarm(descriptor);
+            auto& conn = m_connections[descriptor];
+            m_pl.redeem(conn.buffer);
+            conn.buffer = nullptr;
+            if (conn.tx_buffer) {
+                m_pl.redeem(conn.tx_buffer);
+                conn.tx_buffer = nullptr;
+            }
+            auto& zc = m_zc[descriptor];
+            if (!zc.pending.empty() && zc.pending.front().zero_copy) {
+                // Partly handed over, the kernel already references its pages
+                zc.in_flight.push_back(std::move(zc.pending.front()));
+            }
+            zc.pending.clear();
+            if (!zc.in_flight.empty()) {
+                // The kernel may still (re)transmit from those pages and reports when it is done
+                // on the error queue only, which is gone with the socket: the owners stay and
+                // the socket stays open, shut down and watched for EPOLLERR alone, until then.
+                // The descriptor cannot be reused meanwhile.
+                ::shutdown(descriptor, SHUT_RDWR);
+                epoll_event ev{};
+                ev.events = EPOLLET;
+                ev.data.fd = descriptor;
+                epoll_ctl(m_epfd, EPOLL_CTL_MOD, descriptor, &ev);
+                m_interest[descriptor] = EPOLLET;
+                zc.lingering = true;
+                return;
+            }
+            close_socket(descriptor);
+        }
+
+        void close_socket(int32_t descriptor) {
             epoll_ctl(m_epfd, EPOLL_CTL_DEL, descriptor, NULL);
             ::close(descriptor);
-            m_pl.redeem(m_connections[descriptor].buffer);
-            m_connections[descriptor].buffer = nullptr;
+            m_zc[descriptor].clear();
         }
 
         void push_new_connection(int32_t fd) {
             NAMED_SCOPE(PushNewConnection);
             if ((std::size_t)fd >= m_connections.size()) {
                 m_connections.resize(fd + 1);
+                m_zc.resize(fd + 1);
+                m_interest.resize(fd + 1);
             }
             m_connections[fd].descriptor = fd;
+            m_connections[fd].tag = 0;
             m_connections[fd].buffer = m_pl.allocate();
+            if (m_cfg.full_duplex) {
+                m_connections[fd].tx_buffer = m_pl.allocate();
+            }
         }
 
         void throw_bind_err() {
@@ -256,12 +692,23 @@ namespace hope::io::el {
 
         std::vector<epoll_event> m_events;
         std::vector<connection> m_connections;
+        std::vector<zc_queue> m_zc; // by descriptor, parallel to m_connections
+        std::vector<uint32_t> m_interest; // armed epoll events by descriptor
+        epoll_stats m_stats;
 
         int32_t m_listen_socket = -1;
         int32_t m_epfd = -1;
+        socket_option_list m_accept_options; // what the listener does not pass on to accepted sockets
+        socket_option_list m_connect_options;
+        std::vector<outbound> m_outbound; // by descriptor
+        bool m_accept_backlog = false;
 
         config m_cfg;
         buffer_pool m_pl;
+        post_queue m_posts;
+        timer_wheel m_timers;
+        descriptor_timeouts m_idle{ m_timers, [this](int32_t fd) { expire_idle(fd); } };
+        descriptor_timeouts m_connect_deadlines{ m_timers, [this](int32_t fd) { fail_connect(fd, ETIMEDOUT); } };
         std::atomic<bool> m_running = true;
         TOnError m_on_err;
         TOnWrite m_on_write;
@@ -0,0 +1,144 @@
+/* Copyright (C) 2026 Gleb Bezborodov - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: bezborodoff.gleb@gmail.com, or visit : https://github.com/glensand/hope-io
+ */
+
+#pragma once
+
+#include "hope-io/coredefs.h"
+
+#if PLATFORM_LINUX
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+namespace hope::io::el {
+
+    // Unbounded lock-free multi-producer single-consumer queue (Vyukov's intrusive node queue).
+    // push() is wait-free for producers, try_pop() may only be called from one thread.
+    template<typename T>
+    class mpsc_queue final {
+    public:
+        mpsc_queue() = default;
+        mpsc_queue(const mpsc_queue&) = delete;
+        mpsc_queue& operator=(const mpsc_queue&) = delete;
+
+        ~mpsc_queue() {
+            T value;
+            while (try_pop(value)) {}
+        }
+
+        void push(T value) {
+            auto* n = new node;
+            n->value = std::move(value);
+            push_node(n);
+        }
+
+        // Returns false when empty, or when a producer is halfway through push(); that
+        // producer still signals after it finishes, so the item is picked up on the next wakeup.
+        bool try_pop(T& out) {
+            auto* tail = m_tail;
+            auto* next = tail->next.load(std::memory_order_acquire);
+            if (tail == &m_stub) {
+                if (!next) return false;
+                m_tail = next;
+                tail = next;
+                next = next->next.load(std::memory_order_acquire);
+            }
+            if (!next) {
+                if (tail != m_head.load(std::memory_order_acquire)) return false;
+                push_node(&m_stub);
+                next = tail->next.load(std::memory_order_acquire);
+                if (!next) return false;
+            }
+            m_tail = next;
+            out = std::move(tail->value);
+            delete tail;
+            return true;
+        }
+
+    private:
+        struct node {
+            std::atomic<node*> next{ nullptr };
+            T value;
+        };
+
+        void push_node(node* n) {
+            n->next.store(nullptr, std::memory_order_relaxed);
+            auto* prev = m_head.exchange(n, std::memory_order_acq_rel);
+            prev->next.store(n, std::memory_order_release);
+        }
+
+        node m_stub;
+        std::atomic<node*> m_head{ &m_stub };
+        node* m_tail = &m_stub;
+    };
+
+    // Cross-thread inbox of an event loop: producers push tasks from any thread, the loop
+    // watches fd() (epoll, or an eventfd read SQE on io_uring) and drains on wakeup.
+    // Only the first push after a drain touches the eventfd.
+    class post_queue final {
+    public:
+        struct task {
+            int32_t descriptor = -1;            // bytes are appended to this connection's tx ring
+            std::vector<unsigned char> bytes;
+            std::function<void()> fn;           // set: run on the loop thread instead
+        };
+
+        post_queue() {
+            m_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (m_fd == -1) {
+                HOPE_THROW_ERRNO("post_queue", "eventfd failed");
+            }
+        }
+
+        ~post_queue() {
+            ::close(m_fd);
+        }
+
+        post_queue(const post_queue&) = delete;
+        post_queue& operator=(const post_queue&) = delete;
+
+        int32_t fd() const noexcept { return m_fd; }
+
+        // Any thread
+        void push(task&& t) {
+            m_queue.push(std::move(t));
+            if (!m_signaled.exchange(true, std::memory_order_acq_rel)) {
+                uint64_t one = 1;
+                [[maybe_unused]] auto ret = ::write(m_fd, &one, sizeof(one));
+            }
+        }
+
+        // Loop thread, after fd() became readable
+        template<typename F>
+        void drain(F&& fn) {
+            // Clear the flag first: a push racing with the drain signals again
+            m_signaled.store(false, std::memory_order_release);
+            uint64_t counter;
+            [[maybe_unused]] auto ret = ::read(m_fd, &counter, sizeof(counter));
+            task t;
+            while (m_queue.try_pop(t)) {
+                fn(t);
+                t = task{};
+            }
+        }
+
+    private:
+        mpsc_queue<task> m_queue;
+        std::atomic<bool> m_signaled{ false };
+        int32_t m_fd = -1;
+    };
+
+}
+
+#endif
@@ -0,0 +1,126 @@
+/* Copyright (C) 2026 Gleb Bezborodov - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: bezborodoff.gleb@gmail.com, or visit : https://github.com/glensand/hope-io
+ */
+
+#pragma once
+
+#include "hope-io/coredefs.h"
+#include "hope-io/net/event_loop.h"
+#include "hope-io/net/linux/event_loop_impl.h"
+
+#if PLATFORM_LINUX
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <exception>
+
+namespace hope::io::el {
+
+    // Shared-nothing multi-threaded server: N independent event_loop_impl_t shards,
+    // each on its own thread with its own SO_REUSEPORT listener, epoll fd, buffer_pool
+    // and connection table. The kernel spreads incoming connections between the
+    // listeners, a connection never migrates between shards.
+    // Every shard gets its own copy of the callbacks, so callbacks run without locks,
+    // but state captured by reference is shared between threads and must be synchronized.
+    template<typename TOnRead, typename TOnWrite, typename TOnError, typename TConnected>
+    class sharded_event_loop_t final
+        : public event_loop<TOnRead, TOnWrite, TOnError, TConnected> {
+    public:
+        using base = event_loop<TOnRead, TOnWrite, TOnError, TConnected>;
+        using shard_t = event_loop_impl_t<TOnRead, TOnWrite, TOnError, TConnected>;
+
+        static_assert(std::is_copy_constructible_v<TOnRead> && std::is_copy_constructible_v<TOnWrite>
+                      && std::is_copy_constructible_v<TOnError> && std::is_copy_constructible_v<TConnected>,
+                      "sharded_event_loop_t copies callbacks into every shard");
+
+        sharded_event_loop_t(TConnected&& on_connect, TOnRead&& on_read, TOnWrite&& on_write, TOnError&& on_error)
+            : m_on_connect(std::move(on_connect))
+            , m_on_read(std::move(on_read))
+            , m_on_write(std::move(on_write))
+            , m_on_err(std::move(on_error)) {}
+
+        // Blocks until stop() is called or any shard fails; the first shard error is rethrown.
+        void run(const config& cfg) override {
+            THREAD_SCOPE(SHARDED_EVENT_LOOP_THREAD);
+
+            auto count = cfg.num_shards;
+            if (count == 0) {
+                count = std::max(1u, std::thread::hardware_concurrency());
+            }
+
+            std::vector<config> shard_cfgs(count, cfg);
+            for (std::size_t i = 0; i < count; ++i) {
+                auto& shard_cfg = shard_cfgs[i];
+                shard_cfg.reuse_port = true;
+                // Every shard owns its own pool, split the connection budget between them
+                shard_cfg.max_mutual_connections = std::max<std::size_t>(1, cfg.max_mutual_connections / count);
+                // Shards pinned to their own NIC / address instead of all of them sharing the wildcard
+                if (!cfg.shard_bind_addresses.empty()) {
+                    shard_cfg.bind_address = cfg.shard_bind_addresses[i % cfg.shard_bind_addresses.size()];
+                }
+            }
+
+            {
+                std::lock_guard lock(m_lock);
+                if (!m_running) return;
+                m_errors.resize(count);
+                for (std::size_t i = 0; i < count; ++i) {
+                    m_shards.emplace_back(std::make_unique<shard_t>(
+                        TConnected(m_on_connect), TOnRead(m_on_read), TOnWrite(m_on_write), TOnError(m_on_err)));
+                }
+            }
+
+            std::vector<std::thread> workers;
+            workers.reserve(count);
+            for (std::size_t i = 0; i < count; ++i) {
+                workers.emplace_back([this, i, &shard_cfgs] {
+                    try {
+                        m_shards[i]->run(shard_cfgs[i]);
+                    } catch (...) {
+                        m_errors[i] = std::current_exception();
+                        stop();
+                    }
+                });
+            }
+
+            for (auto& worker : workers) {
+                worker.join();
+            }
+
+            std::lock_guard lock(m_lock);
+            m_shards.clear();
+            for (auto& err : m_errors) {
+                if (err) std::rethrow_exception(err);
+            }
+        }
+
+        void stop() override {
+            std::lock_guard lock(m_lock);
+            m_running = false;
+            for (auto& shard : m_shards) {
+                shard->stop();
+            }
+        }
+
+    private:
+        std::mutex m_lock;
+        std::vector<std::unique_ptr<shard_t>> m_shards;
+        std::vector<std::exception_ptr> m_errors;
+        bool m_running = true;
+
+        TConnected m_on_connect;
+        TOnRead m_on_read;
+        TOnWrite m_on_write;
+        TOnError m_on_err;
+    };
+
+}
+
+#endif
@@ -11,7 +11,10 @@
 #include "hope-io/coredefs.h"
 #include "hope-io/net/tls_event_loop.h"
 #include "hope-io/net/event_loop.h"
+#include "hope-io/net/endpoint.h"
 #include "hope-io/net/linux/event_loop_impl.h"
+#include "hope-io/net/linux/tls_key_offload.h"
+#include "hope-io/net/timer_wheel.h"
 #include "hope-io/net/stream_options_util.h"
 #include "hope-io/net/tls/ktls_enable.h"
 #include "hope-io/net/init.h"
@@ -21,11 +24,10 @@
 #include "openssl/ssl.h"
 #include "openssl/err.h"
 
-#include <unordered_set>
 #include <atomic>
+#include <memory>
 #include <vector>
 #include <sys/epoll.h>
-#include <fcntl.h>
 #include <unistd.h>
 #include <arpa/inet.h>
 #include <sys/socket.h>
@@ -90,7 +92,13 @@ namespace hope::io::el {
                 "ECDHE-RSA-AES256-GCM-SHA384");
             SSL_CTX_set1_curves_list(m_ctx, "X25519:prime256v1:secp384r1");
 
-            m_listen_socket = socket(AF_INET, SOCK_STREAM, 0);
+            endpoint srv_addr;
+            if (!endpoint::for_listen(cfg.bind_address, (uint16_t)cfg.port, srv_addr)) {
+                SSL_CTX_free(m_ctx);
+                m_ctx = nullptr;
+                HOPE_THROW("tls_event_loop", "bind_address is not a numeric IPv4/IPv6 address: " + cfg.bind_address);
+            }
+            m_listen_socket = listen_socket(srv_addr, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, cfg.ipv6_only);
             if (m_listen_socket == -1) {
                 SSL_CTX_free(m_ctx);
                 m_ctx = nullptr;
@@ -100,16 +108,12 @@ namespace hope::io::el {
             int reuse = 1;
             setsockopt(m_listen_socket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
 
-            sockaddr_in srv_addr{};
-            srv_addr.sin_family = AF_INET;
-            srv_addr.sin_addr.s_addr = INADDR_ANY;
-            srv_addr.sin_port = htons(cfg.port);
-            if (bind(m_listen_socket, (struct sockaddr*)&srv_addr, sizeof(srv_addr)) == -1) {
+            if (bind(m_listen_socket, srv_addr.addr(), srv_addr.size) == -1) {
                 throw_bind_err();
             }
 
-            auto flags = fcntl(m_listen_socket, F_GETFL, 0);
-            fcntl(m_listen_socket, F_SETFL, flags | O_NONBLOCK);
+            m_accept_options = socket_option_list(cfg.accepted_stream_options);
+            m_accept_options.take_inherited().apply(m_listen_socket);
             listen(m_listen_socket, cfg.max_mutual_connections);
 
             m_epfd = epoll_create(1);
@@ -124,6 +128,15 @@ namespace hope::io::el {
                 epoll_ctl(m_epfd, EPOLL_CTL_ADD, m_listen_socket, &ev);
             }
 
+            if (cfg.handshake_workers > 0) {
+                m_key_offload = std::make_unique<tls_key_offload>(SSL_CTX_get0_privatekey(m_ctx), cfg.handshake_workers);
+                m_key_offload->install(m_ctx);
+                epoll_event ev;
+                ev.events = EPOLLIN | EPOLLET;
+                ev.data.fd = m_key_offload->fd();
+                epoll_ctl(m_epfd, EPOLL_CTL_ADD, m_key_offload->fd(), &ev);
+            }
+
             m_cfg = cfg;
             m_pl.prepool(cfg.max_mutual_connections);
             m_events.resize(cfg.max_mutual_connections);
@@ -135,7 +148,8 @@ namespace hope::io::el {
                 auto nfds = 0;
                 {
                     NAMED_SCOPE(TlsEpoll);
-                    nfds = epoll_wait(m_epfd, m_events.data(), (int)m_events.size(), cfg.epoll_timeout);
+                    nfds = epoll_wait(m_epfd, m_events.data(), (int)m_events.size(),
+                                      m_accept_backlog ? 0 : m_timers.next_timeout_ms(cfg.epoll_timeout));
                 }
 
                 for (auto i = 0; i < nfds; ++i) {
@@ -145,9 +159,11 @@ namespace hope::io::el {
 
                     if (sock == m_listen_socket) {
                         handle_accept();
+                    } else if (m_key_offload && sock == m_key_offload->fd()) {
+                        resume_signed_handshakes();
                     } else if (event.events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
                         remove_connection(sock);
-                    } else if (m_pending_handshakes.count(sock)) {
+                    } else if (m_tls_states[sock].handshake != handshake_wait::none) {
                         retry_handshake(sock);
                     } else if (event.events & EPOLLIN) {
                         handle_read(m_connections[sock]);
@@ -155,6 +171,10 @@ namespace hope::io::el {
                         handle_write(m_connections[sock]);
                     }
                 }
+                if (m_accept_backlog) {
+                    handle_accept();
+                }
+                m_timers.advance(timer_wheel::clock::now());
             }
 
             // Cleanup all remaining connections
@@ -170,7 +190,8 @@ namespace hope::io::el {
                     conn.buffer = nullptr;
                 }
             }
-            m_pending_handshakes.clear();
+            // Jobs hang off the SSLs, so the workers go after them
+            m_key_offload.reset();
 
             close(m_listen_socket);
             close(m_epfd);
@@ -181,9 +202,18 @@ namespace hope::io::el {
         }
 
     private:
+        // What a handshake in progress waits for, none once it is done (or never started)
+        enum class handshake_wait : uint8_t {
+            none,
+            read,
+            write,
+            key,    // private key operation on a tls_key_offload worker
+        };
+
         struct tls_per_conn {
             SSL* ssl = nullptr;
             bool ktls_active = false;
+            handshake_wait handshake = handshake_wait::none;
         };
 
 
@@ -205,29 +235,19 @@ namespace hope::io::el {
                     epoll_ctl(m_epfd, EPOLL_CTL_MOD, conn.descriptor, &ev);
                 }
 
+        // Edge triggered listener, same budget carry-over as the tcp loop
         void handle_accept() {
             NAMED_SCOPE(TlsHandleAccept);
+            m_accept_backlog = true;
             for (auto i = 0; i < m_cfg.max_accepts_per_tick; ++i) {
                 NAMED_SCOPE(TlsAcceptOne);
-                struct sockaddr_in client_addr{};
-                socklen_t socklen = sizeof(client_addr);
-                int sock = accept(m_listen_socket, (struct sockaddr*)&client_addr, &socklen);
-                if (sock == -1) break;
-
-                int flags = fcntl(sock, F_GETFL, 0);
-                if (flags == -1) {
-                    ::close(sock);
+                int sock = accept4(m_listen_socket, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                if (sock == -1) {
+                    m_accept_backlog = errno == EINTR || errno == ECONNABORTED;
                     break;
                 }
-                flags |= O_NONBLOCK;
-                if (fcntl(sock, F_SETFL, flags) == -1) {
-                    connection dumb;
-                    m_on_err(dumb, "tls_event_loop: cannot set nonblock");
-                    ::close(sock);
-                    continue;
-                }
 
-                apply_stream_options(sock, m_cfg.accepted_stream_options);
+                m_accept_options.apply(sock);
 
                 SSL* ssl = SSL_new(m_ctx);
                 if (!ssl) {
@@ -261,6 +281,7 @@ namespace hope::io::el {
                         remove_connection(sock);
                         continue;
                     }
+                    m_timeouts.arm(sock, std::chrono::milliseconds(m_cfg.idle_timeout_ms));
                     apply_state(conn, state);
 
                     // Drain any application data that arrived during the handshake
@@ -269,14 +290,10 @@ namespace hope::io::el {
                         handle_read(conn);
                     }
                 } else {
-                    int err = SSL_get_error(ssl, ret);
-                    if (err == SSL_ERROR_WANT_READ) {
-                        epoll_event ev;
-                        ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLHUP | EPOLLET;
-                        ev.data.fd = sock;
-                        epoll_ctl(m_epfd, EPOLL_CTL_ADD, sock, &ev);
-                        m_pending_handshakes.insert(sock);
-                        auto& tls = m_tls_states[sock];
+                    auto& tls = m_tls_states[sock];
+                    if (park_handshake(sock, tls, SSL_get_error(ssl, ret), EPOLL_CTL_ADD)) {
+                        // One deadline for the whole handshake, progress does not extend it
+                        m_timeouts.arm(sock, std::chrono::milliseconds(m_cfg.handshake_timeout_ms));
                         tls.ssl = ssl;
                         connection_for_fd(sock).descriptor = sock;
                     } else {
@@ -292,7 +309,8 @@ namespace hope::io::el {
             auto& tls = m_tls_states[sock];
             int ret = SSL_do_handshake(tls.ssl);
             if (ret == 1) {
-                m_pending_handshakes.erase(sock);
+                tls.handshake = handshake_wait::none;
+                m_timeouts.disarm(sock);
                 register_connection(sock, tls.ssl);
                 if (m_cfg.enable_ktls) {
                     tls.ktls_active = try_enable_fd_ktls(tls.ssl, sock, true);
@@ -304,6 +322,7 @@ namespace hope::io::el {
                     remove_connection(sock);
                     return;
                 }
+                m_timeouts.arm(sock, std::chrono::milliseconds(m_cfg.idle_timeout_ms));
                 apply_state(conn, state);
 
                 // Drain any application data that arrived during the deferred handshake
@@ -311,11 +330,12 @@ namespace hope::io::el {
                     handle_read(conn);
                 }
             } else {
-                int err = SSL_get_error(tls.ssl, ret);
-                if (err != SSL_ERROR_WANT_READ) {
+                if (!park_handshake(sock, tls, SSL_get_error(tls.ssl, ret), EPOLL_CTL_MOD)) {
+                    epoll_ctl(m_epfd, EPOLL_CTL_DEL, sock, nullptr);
                     SSL_free(tls.ssl);
                     tls.ssl = nullptr;
-                    m_pending_handshakes.erase(sock);
+                    tls.handshake = handshake_wait::none;
+                    m_timeouts.disarm(sock);
                     ::close(sock);
                     connection dumb;
                     m_on_err(dumb, "tls_event_loop: handshake failed");
@@ -323,10 +343,49 @@ namespace hope::io::el {
             }
         }
 
+        // Waits for exactly what SSL asked for: EPOLLIN for the client's next flight, EPOLLOUT
+        // when the server flight did not fit the send buffer, nothing but hangups while a worker
+        // signs. Edge triggered, so an event always means progress is possible.
+        bool park_handshake(int32_t sock, tls_per_conn& tls, int err, int op) {
+            epoll_event ev;
+            ev.events = EPOLLRDHUP | EPOLLHUP | EPOLLET;
+            ev.data.fd = sock;
+            switch (err) {
+                case SSL_ERROR_WANT_READ:
+                    tls.handshake = handshake_wait::read;
+                    ev.events |= EPOLLIN;
+                    break;
+                case SSL_ERROR_WANT_WRITE:
+                    tls.handshake = handshake_wait::write;
+                    ev.events |= EPOLLOUT;
+                    break;
+                case SSL_ERROR_WANT_PRIVATE_KEY_OPERATION:
+                    tls.handshake = handshake_wait::key;
+                    break;
+                default:
+                    return false;
+            }
+            epoll_ctl(m_epfd, op, sock, &ev);
+            return true;
+        }
+
+        // Workers finished signing: SSL_do_handshake takes the signature and sends the flight.
+        // The connection may have died meanwhile, its fd even reused by a newer handshake.
+        void resume_signed_handshakes() {
+            NAMED_SCOPE(TlsResumeSigned);
+            m_key_offload->drain([this](SSL* ssl) {
+                const auto sock = SSL_get_fd(ssl);
+                if (sock >= 0 && (std::size_t)sock < m_tls_states.size()
+                    && m_tls_states[sock].ssl == ssl && m_tls_states[sock].handshake == handshake_wait::key) {
+                    retry_handshake(sock);
+                }
+            });
+        }
+
         void register_connection(int32_t sock, SSL* ssl) {
             NAMED_SCOPE(TlsRegisterConn);
             auto& tls = m_tls_states[sock];
-            // ssl may already be set if the handshake was deferred (SSL_ERROR_WANT_READ in handle_accept).
+            // ssl may already be set if the handshake was parked in handle_accept.
             if (!tls.ssl) {
                 tls.ssl = ssl;
             }
@@ -348,17 +407,18 @@ namespace hope::io::el {
         void handle_read(connection& conn) {
             NAMED_SCOPE(TlsHandleRead);
             if (conn.get_state() != el_connection_state::read) return;
+            m_timeouts.touch(conn.descriptor);
 
             auto& tls = m_tls_states[conn.descriptor];
             bool error = false;
             bool got_data = false;
 
             if (tls.ktls_active) {
-                // KTLS path: raw recv() — kernel handles decryption.
+                // KTLS path: the kernel decrypts, ktls_recv fails on a KeyUpdate it cannot follow.
                 // Branch predicted well since all connections share the same mode.
                 while (true) {
                     auto consumed = conn.buffer->consume_free([&](void* data, std::size_t size) -> std::size_t {
-                        auto received = ::recv(conn.descriptor, (char*)data, size, 0);
+                        auto received = ktls_recv(conn.descriptor, data, size, 0);
                         if (received > 0) {
                             got_data = true;
                             return (std::size_t)received;
@@ -409,6 +469,7 @@ namespace hope::io::el {
         void handle_write(connection& conn) {
             NAMED_SCOPE(TlsHandleWrite);
             if (conn.get_state() != el_connection_state::write) return;
+            m_timeouts.touch(conn.descriptor);
 
             auto& tls = m_tls_states[conn.descriptor];
 
@@ -448,8 +509,23 @@ namespace hope::io::el {
             }
         }
 
+        // Handshake deadline or idle timeout
+        void expire(int32_t descriptor) {
+            if (m_tls_states[descriptor].handshake != handshake_wait::none) {
+                remove_connection(descriptor);
+                connection dumb;
+                m_on_err(dumb, "tls_event_loop: handshake timeout");
+                return;
+            }
+            auto& conn = m_connections[descriptor];
+            if (!conn.buffer) return;
+            m_on_err(conn, "tls_event_loop: idle timeout, close connection");
+            if (conn.buffer) remove_connection(descriptor);
+        }
+
         void remove_connection(int32_t descriptor) {
             NAMED_SCOPE(TlsRemoveConn);
+            m_timeouts.disarm(descriptor);
             epoll_ctl(m_epfd, EPOLL_CTL_DEL, descriptor, nullptr);
 
             auto& tls = m_tls_states[descriptor];
@@ -457,7 +533,7 @@ namespace hope::io::el {
                 SSL_free(tls.ssl);
                 tls.ssl = nullptr;
             }
-            m_pending_handshakes.erase(descriptor);
+            tls.handshake = handshake_wait::none;
 
             close(descriptor);
 
@@ -490,14 +566,18 @@ namespace hope::io::el {
 
         int32_t m_listen_socket = -1;
         int32_t m_epfd = -1;
+        socket_option_list m_accept_options;
+        bool m_accept_backlog = false;
         SSL_CTX* m_ctx = nullptr;
+        std::unique_ptr<tls_key_offload> m_key_offload;
 
         tls_config m_cfg;
         std::vector<epoll_event> m_events;
         std::vector<connection> m_connections;
         std::vector<tls_per_conn> m_tls_states;
-        std::unordered_set<int32_t> m_pending_handshakes;
         buffer_pool m_pl;
+        timer_wheel m_timers;
+        descriptor_timeouts m_timeouts{ m_timers, [this](int32_t fd) { expire(fd); } };
         std::atomic<bool> m_running = true;
         TOnError m_on_err;
         TOnWrite m_on_write;
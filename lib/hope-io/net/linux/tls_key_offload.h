@@ -0,0 +1,337 @@
+/* Copyright (C) 2026 Gleb Bezborodov - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: bezborodoff.gleb@gmail.com, or visit : https://github.com/glensand/hope-io
+ */
+
+#pragma once
+
+#include "hope-io/coredefs.h"
+
+#if PLATFORM_LINUX
+
+#include "openssl/ssl.h"
+#include "openssl/evp.h"
+#include "openssl/rsa.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+namespace hope::io::el {
+
+    // Private key operations of server handshakes on worker threads. Installed on an SSL_CTX
+    // as its SSL_PRIVATE_KEY_METHOD, SSL_do_handshake then returns
+    // SSL_ERROR_WANT_PRIVATE_KEY_OPERATION instead of signing on the loop thread. A worker
+    // signs, the loop watches fd() (epoll, or an eventfd read SQE on io_uring) and resumes the
+    // handshakes drain() hands back. Workers take everything queued (up to max_batch) per
+    // wakeup and a batch signals the loop once, so a burst of handshakes costs the loop one
+    // eventfd read and no RSA at all.
+    // Jobs belong to their SSL: SSL_free of a connection with a job in flight drops the job,
+    // so the pool has to outlive every SSL made from the contexts it is installed on.
+    class tls_key_offload final {
+    public:
+        struct stats final {
+            uint64_t operations = 0;
+            uint64_t batches = 0;
+            uint64_t failures = 0;
+        };
+
+        tls_key_offload(EVP_PKEY* key, std::size_t workers, std::size_t max_batch = 32)
+            : m_key(key)
+            , m_max_batch(max_batch == 0 ? 1 : max_batch) {
+            if (m_key == nullptr) {
+                HOPE_THROW("tls_key_offload", "no private key");
+            }
+            EVP_PKEY_up_ref(m_key);
+            m_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (m_fd == -1) {
+                EVP_PKEY_free(m_key);
+                HOPE_THROW_ERRNO("tls_key_offload", "eventfd failed");
+            }
+            ssl_index(); // before any SSL_free can look for it
+            for (std::size_t i = 0; i < (workers == 0 ? 1 : workers); ++i) {
+                m_workers.emplace_back([this] { work(); });
+            }
+        }
+
+        ~tls_key_offload() {
+            {
+                std::lock_guard lock(m_lock);
+                m_stop = true;
+            }
+            m_wake.notify_all();
+            for (auto& w : m_workers) {
+                w.join();
+            }
+            for (auto* j : m_queue) delete j;
+            for (auto* j : m_done) delete j;
+            ::close(m_fd);
+            EVP_PKEY_free(m_key);
+        }
+
+        tls_key_offload(const tls_key_offload&) = delete;
+        tls_key_offload& operator=(const tls_key_offload&) = delete;
+
+        // Routes the private key operations of SSLs made from ctx through this pool.
+        // The key loaded into ctx stays, it only has to be the same one.
+        void install(SSL_CTX* ctx) {
+            static const SSL_PRIVATE_KEY_METHOD method = {
+                &tls_key_offload::on_sign,
+                &tls_key_offload::on_decrypt,
+                &tls_key_offload::on_complete,
+            };
+            SSL_CTX_set_ex_data(ctx, ctx_index(), this);
+            SSL_CTX_set_private_key_method(ctx, &method);
+        }
+
+        int32_t fd() const noexcept { return m_fd; }
+
+        // Loop thread, after fd() became readable: fn(SSL*) for every handshake whose key
+        // operation finished, SSL_do_handshake picks the result up
+        template<typename F>
+        void drain(F&& fn) {
+            std::vector<job*> done;
+            {
+                std::lock_guard lock(m_lock);
+                // Cleared under the lock: a batch finishing right after signals again
+                m_signaled = false;
+                uint64_t counter;
+                [[maybe_unused]] auto ret = ::read(m_fd, &counter, sizeof(counter));
+                done.swap(m_done);
+                for (auto* j : done) {
+                    j->state = job_state::delivered;
+                }
+            }
+            // fn may free SSLs, which deletes their delivered jobs: take the SSLs first
+            std::vector<SSL*> ready;
+            ready.reserve(done.size());
+            for (auto* j : done) {
+                if (j->cancelled) {
+                    delete j;
+                } else {
+                    ready.push_back(j->ssl);
+                }
+            }
+            for (auto* ssl : ready) {
+                fn(ssl);
+            }
+        }
+
+        stats get_stats() const {
+            std::lock_guard lock(m_lock);
+            return m_stats;
+        }
+
+        // ── SSL_PRIVATE_KEY_METHOD steps, loop thread ───────────────────────
+
+        ssl_private_key_result_t start(SSL* ssl, bool sign, uint16_t signature_algorithm,
+                                       const uint8_t* in, std::size_t in_len) {
+            auto* j = new job;
+            j->ssl = ssl;
+            j->owner = this;
+            j->sign = sign;
+            j->signature_algorithm = signature_algorithm;
+            j->in.assign(in, in + in_len);
+            if (!SSL_set_ex_data(ssl, ssl_index(), j)) {
+                delete j;
+                return ssl_private_key_failure;
+            }
+            {
+                std::lock_guard lock(m_lock);
+                m_queue.push_back(j);
+            }
+            m_wake.notify_one();
+            return ssl_private_key_retry;
+        }
+
+        ssl_private_key_result_t complete(SSL* ssl, uint8_t* out, std::size_t* out_len, std::size_t max_out) {
+            auto* j = static_cast<job*>(SSL_get_ex_data(ssl, ssl_index()));
+            if (j == nullptr) return ssl_private_key_failure;
+            {
+                std::lock_guard lock(m_lock);
+                if (j->state != job_state::delivered) return ssl_private_key_retry;
+            }
+            SSL_set_ex_data(ssl, ssl_index(), nullptr);
+            const bool ok = !j->failed && j->out.size() <= max_out;
+            if (ok) {
+                std::memcpy(out, j->out.data(), j->out.size());
+                *out_len = j->out.size();
+            }
+            delete j;
+            return ok ? ssl_private_key_success : ssl_private_key_failure;
+        }
+
+    private:
+        enum class job_state : uint8_t { queued, running, done, delivered };
+
+        struct job final {
+            SSL* ssl = nullptr;
+            tls_key_offload* owner = nullptr;
+            std::vector<uint8_t> in;
+            std::vector<uint8_t> out;
+            uint16_t signature_algorithm = 0;
+            job_state state = job_state::queued;
+            bool sign = true;           // false: RSA decrypt of a TLS 1.2 RSA key exchange
+            bool failed = false;
+            bool cancelled = false;     // its SSL is gone, whoever holds the job deletes it
+        };
+
+        static int ctx_index() {
+            static const int index = SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+            return index;
+        }
+
+        static int ssl_index() {
+            static const int index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, &tls_key_offload::on_ssl_free);
+            return index;
+        }
+
+        static tls_key_offload* owner_of(SSL* ssl) {
+            return static_cast<tls_key_offload*>(SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), ctx_index()));
+        }
+
+        static ssl_private_key_result_t on_sign(SSL* ssl, uint8_t* /*out*/, size_t* /*out_len*/, size_t /*max_out*/,
+                                                uint16_t signature_algorithm, const uint8_t* in, size_t in_len) {
+            auto* self = owner_of(ssl);
+            return self ? self->start(ssl, true, signature_algorithm, in, in_len) : ssl_private_key_failure;
+        }
+
+        static ssl_private_key_result_t on_decrypt(SSL* ssl, uint8_t* /*out*/, size_t* /*out_len*/, size_t /*max_out*/,
+                                                   const uint8_t* in, size_t in_len) {
+            auto* self = owner_of(ssl);
+            return self ? self->start(ssl, false, 0, in, in_len) : ssl_private_key_failure;
+        }
+
+        static ssl_private_key_result_t on_complete(SSL* ssl, uint8_t* out, size_t* out_len, size_t max_out) {
+            auto* self = owner_of(ssl);
+            return self ? self->complete(ssl, out, out_len, max_out) : ssl_private_key_failure;
+        }
+
+        // SSL_free with a job still attached
+        static void on_ssl_free(void* /*parent*/, void* ptr, CRYPTO_EX_DATA* /*ad*/, int /*index*/,
+                                long /*argl*/, void* /*argp*/) {
+            auto* j = static_cast<job*>(ptr);
+            if (j == nullptr) return;
+            std::unique_lock lock(j->owner->m_lock);
+            if (j->state == job_state::delivered) {
+                lock.unlock();
+                delete j;
+            } else {
+                j->cancelled = true;
+            }
+        }
+
+        void work() {
+            std::vector<job*> batch;
+            batch.reserve(m_max_batch);
+            while (true) {
+                {
+                    std::unique_lock lock(m_lock);
+                    m_wake.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+                    if (m_stop) return;
+                    while (!m_queue.empty() && batch.size() < m_max_batch) {
+                        auto* j = m_queue.front();
+                        m_queue.pop_front();
+                        if (j->cancelled) {
+                            delete j;
+                            continue;
+                        }
+                        j->state = job_state::running;
+                        batch.push_back(j);
+                    }
+                }
+
+                for (auto* j : batch) {
+                    j->failed = !(j->sign ? sign(*j) : decrypt(*j));
+                }
+
+                bool signal = false;
+                {
+                    std::lock_guard lock(m_lock);
+                    for (auto* j : batch) {
+                        m_stats.failures += j->failed ? 1 : 0;
+                        if (j->cancelled) {
+                            delete j;
+                            continue;
+                        }
+                        j->state = job_state::done;
+                        m_done.push_back(j);
+                    }
+                    m_stats.operations += batch.size();
+                    ++m_stats.batches;
+                    signal = !m_signaled && !m_done.empty();
+                    m_signaled = m_signaled || signal;
+                }
+                if (signal) {
+                    uint64_t one = 1;
+                    [[maybe_unused]] auto ret = ::write(m_fd, &one, sizeof(one));
+                }
+                batch.clear();
+            }
+        }
+
+        bool sign(job& j) const {
+            EVP_MD_CTX* ctx = EVP_MD_CTX_new();
+            EVP_PKEY_CTX* pctx = nullptr;
+            // Ed25519 has no separate digest, SSL_get_signature_algorithm_digest gives nullptr
+            bool ok = ctx != nullptr
+                && EVP_DigestSignInit(ctx, &pctx, SSL_get_signature_algorithm_digest(j.signature_algorithm), nullptr, m_key);
+            if (ok && SSL_is_signature_algorithm_rsa_pss(j.signature_algorithm)) {
+                ok = EVP_PKEY_CTX_set_rsa_padding(pctx, RSA_PKCS1_PSS_PADDING)
+                    && EVP_PKEY_CTX_set_rsa_pss_saltlen(pctx, -1); // salt as long as the digest
+            }
+            std::size_t len = 0;
+            ok = ok && EVP_DigestSign(ctx, nullptr, &len, j.in.data(), j.in.size());
+            if (ok) {
+                j.out.resize(len);
+                ok = EVP_DigestSign(ctx, j.out.data(), &len, j.in.data(), j.in.size());
+                j.out.resize(len);
+            }
+            EVP_MD_CTX_free(ctx);
+            return ok;
+        }
+
+        // Raw RSA, the TLS layer checks the PKCS#1 padding itself
+        bool decrypt(job& j) const {
+            EVP_PKEY_CTX* pctx = EVP_PKEY_CTX_new(m_key, nullptr);
+            std::size_t len = 0;
+            bool ok = pctx != nullptr
+                && EVP_PKEY_decrypt_init(pctx) > 0
+                && EVP_PKEY_CTX_set_rsa_padding(pctx, RSA_NO_PADDING) > 0
+                && EVP_PKEY_decrypt(pctx, nullptr, &len, j.in.data(), j.in.size()) > 0;
+            if (ok) {
+                j.out.resize(len);
+                ok = EVP_PKEY_decrypt(pctx, j.out.data(), &len, j.in.data(), j.in.size()) > 0;
+                j.out.resize(len);
+            }
+            EVP_PKEY_CTX_free(pctx);
+            return ok;
+        }
+
+        EVP_PKEY* m_key = nullptr;
+        std::size_t m_max_batch;
+        int32_t m_fd = -1;
+        std::vector<std::thread> m_workers;
+        std::deque<job*> m_queue;
+        std::vector<job*> m_done;
+        stats m_stats;
+        mutable std::mutex m_lock;
+        std::condition_variable m_wake;
+        bool m_signaled = false;
+        bool m_stop = false;
+    };
+
+}
+
+#endif
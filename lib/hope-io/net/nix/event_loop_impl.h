@@ -56,7 +56,10 @@ namespace hope::io::el {
                 m_acceptor = cfg.custom_acceptor;
                 m_owns_acceptor = false;
             } else {
-                m_acceptor = new hope::io::tcp_acceptor;
+                stream_options listen_opt;
+                listen_opt.bind_address = cfg.bind_address;
+                listen_opt.ipv6_only = cfg.ipv6_only;
+                m_acceptor = new hope::io::tcp_acceptor(listen_opt);
                 m_acceptor->open(cfg.port);
                 m_owns_acceptor = true;
             }
@@ -171,7 +174,7 @@ namespace hope::io::el {
             NAMED_SCOPE(HandleAccept);
             for (auto i = 0; i < m_cfg.max_accepts_per_tick; ++i) {
                 NAMED_SCOPE(AcceptOne);
-                struct sockaddr_in client_addr = {};
+                struct sockaddr_storage client_addr = {};
                 socklen_t socklen = sizeof(client_addr);
                 int sock = accept(m_acceptor->raw(), (struct sockaddr *)&client_addr, &socklen);
                 if (sock == -1) break;
@@ -225,7 +228,7 @@ namespace hope::io::el {
                     auto err_state = m_on_err(conn, "Cannot read from socket, close connection");
                     error = true;
                     apply_state(conn, err_state);
-                    return size;
+                    return 0; // stop here, the buffer may already be back in the pool
                 } else if (received <= 0) {
                     return 0;
                 }
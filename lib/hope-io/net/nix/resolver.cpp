@@ -0,0 +1,250 @@
+/* Copyright (C) 2026 Gleb Bezborodov - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: bezborodoff.gleb@gmail.com, or visit : https://github.com/glensand/hope-io
+ */
+
+#include "hope-io/coredefs.h"
+
+#if PLATFORM_LINUX || PLATFORM_APPLE
+
+#include "hope-io/net/resolver.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+
+#include <netdb.h>
+
+namespace hope::io {
+
+    namespace {
+        // DNS names are case-insensitive, "host." and "host" are the same name
+        std::string normalize(std::string_view host) {
+            std::string key(host);
+            std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+            if (!key.empty() && key.back() == '.') key.pop_back();
+            return key;
+        }
+
+        // Says nothing about the name: the next lookup may well succeed
+        bool transient(int error) {
+            return error == EAI_AGAIN || error == EAI_MEMORY || error == EAI_SYSTEM;
+        }
+    }
+
+    bool resolver::result::pick(int family, endpoint& out) const {
+        for (auto& a : addresses) {
+            if (family == AF_UNSPEC || a.family() == family) {
+                out = a;
+                return true;
+            }
+        }
+        if (family == AF_INET6 && !addresses.empty()) {
+            out = addresses.front().v4_mapped();
+            return true;
+        }
+        return false;
+    }
+
+    resolver::resolver(resolver_options options)
+        : m_options(std::move(options)) {
+        if (!m_options.hosts_file.empty()) {
+            load_hosts_file();
+        }
+    }
+
+    resolver::~resolver() {
+        {
+            std::lock_guard lock(m_lock);
+            m_stopping = true;
+        }
+        m_wake.notify_all();
+        for (auto& w : m_workers) {
+            w.join();
+        }
+        // Lookups still queued never run, their callers hear so instead of waiting forever
+        entry cancelled;
+        cancelled.error = EAI_AGAIN;
+        for (auto& [host, waiters] : m_in_flight) {
+            for (auto& w : waiters) {
+                w.cb(with_port(cancelled, w.port));
+            }
+        }
+    }
+
+    resolver& resolver::shared() {
+        static resolver instance;
+        return instance;
+    }
+
+    resolver::result resolver::resolve(std::string_view host, uint16_t port) {
+        result out;
+        endpoint numeric;
+        if (endpoint::parse(host, port, numeric)) {
+            out.addresses.push_back(numeric);
+            return out;
+        }
+        auto key = normalize(host);
+        {
+            std::lock_guard lock(m_lock);
+            if (find(key, port, out)) return out;
+            ++m_stats.misses;
+        }
+        auto e = lookup(key);
+        out = with_port(e, port);
+        std::lock_guard lock(m_lock);
+        store(key, std::move(e));
+        return out;
+    }
+
+    void resolver::resolve_async(std::string_view host, uint16_t port, callback cb) {
+        endpoint numeric;
+        if (endpoint::parse(host, port, numeric)) {
+            result out;
+            out.addresses.push_back(numeric);
+            cb(out);
+            return;
+        }
+        auto key = normalize(host);
+        std::unique_lock lock(m_lock);
+        result out;
+        if (find(key, port, out)) {
+            lock.unlock();
+            cb(out);
+            return;
+        }
+        auto& waiters = m_in_flight[key];
+        waiters.push_back({ port, std::move(cb) });
+        if (waiters.size() > 1) return; // the lookup is already queued
+        ++m_stats.misses;
+        m_queue.push_back(std::move(key));
+        if (m_workers.empty()) {
+            for (std::size_t i = 0; i < std::max<std::size_t>(1, m_options.workers); ++i) {
+                m_workers.emplace_back([this] { worker(); });
+            }
+        }
+        lock.unlock();
+        m_wake.notify_one();
+    }
+
+    void resolver::clear() {
+        std::lock_guard lock(m_lock);
+        m_cache.clear();
+    }
+
+    resolver::stats resolver::get_stats() const {
+        std::lock_guard lock(m_lock);
+        return m_stats;
+    }
+
+    resolver::result resolver::with_port(const entry& e, uint16_t port) {
+        result out;
+        out.error = e.error;
+        out.addresses = e.addresses;
+        for (auto& a : out.addresses) {
+            a.set_port(port);
+        }
+        return out;
+    }
+
+    resolver::entry resolver::lookup(const std::string& host) {
+        entry e;
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM; // one result per address instead of one per socket type
+        hints.ai_flags = AI_ADDRCONFIG;
+        addrinfo* res = nullptr;
+        e.error = getaddrinfo(host.c_str(), nullptr, &hints, &res);
+        if (e.error != 0) return e;
+        for (auto* ai = res; ai != nullptr; ai = ai->ai_next) {
+            if (ai->ai_family == AF_INET || ai->ai_family == AF_INET6) {
+                e.addresses.push_back(endpoint::from(ai->ai_addr, ai->ai_addrlen));
+            }
+        }
+        freeaddrinfo(res);
+        if (e.addresses.empty()) e.error = EAI_NONAME;
+        return e;
+    }
+
+    // m_lock held
+    bool resolver::find(const std::string& host, uint16_t port, result& out) {
+        if (auto it = m_hosts.find(host); it != m_hosts.end()) {
+            ++m_stats.hits;
+            out = with_port(it->second, port);
+            return true;
+        }
+        auto it = m_cache.find(host);
+        if (it == m_cache.end()) return false;
+        if (it->second.expires <= std::chrono::steady_clock::now()) {
+            m_cache.erase(it);
+            return false;
+        }
+        ++(it->second.error != 0 ? m_stats.negative_hits : m_stats.hits);
+        out = with_port(it->second, port);
+        return true;
+    }
+
+    // m_lock held
+    void resolver::store(const std::string& host, entry e) {
+        if (transient(e.error)) return;
+        auto now = std::chrono::steady_clock::now();
+        e.expires = now + (e.error != 0 ? m_options.negative_ttl : m_options.ttl);
+        if (m_cache.size() >= m_options.max_entries && m_cache.find(host) == m_cache.end()) {
+            std::erase_if(m_cache, [now](const auto& kv) { return kv.second.expires <= now; });
+            if (m_cache.size() >= m_options.max_entries) {
+                m_cache.erase(m_cache.begin());
+            }
+        }
+        m_cache[host] = std::move(e);
+    }
+
+    void resolver::load_hosts_file() {
+        std::ifstream in(m_options.hosts_file);
+        if (!in) HOPE_THROW("resolver", "cannot open hosts file: " + m_options.hosts_file);
+        std::string line;
+        while (std::getline(in, line)) {
+            line = line.substr(0, line.find('#'));
+            std::istringstream tokens(line);
+            std::string address;
+            if (!(tokens >> address)) continue;
+            endpoint ep;
+            if (!endpoint::parse(address, 0, ep)) continue;
+            std::string name;
+            while (tokens >> name) {
+                m_hosts[normalize(name)].addresses.push_back(ep);
+            }
+        }
+    }
+
+    void resolver::worker() {
+        std::unique_lock lock(m_lock);
+        while (true) {
+            m_wake.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+            if (m_stopping) return;
+            auto host = std::move(m_queue.front());
+            m_queue.pop_front();
+
+            lock.unlock();
+            auto e = lookup(host);
+            lock.lock();
+
+            auto waiters = std::move(m_in_flight[host]);
+            m_in_flight.erase(host);
+            auto answer = e;
+            store(host, std::move(e));
+
+            lock.unlock();
+            for (auto& w : waiters) {
+                w.cb(with_port(answer, w.port));
+            }
+            lock.lock();
+        }
+    }
+
+}
+
+#endif
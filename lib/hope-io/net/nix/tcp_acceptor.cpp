@@ -15,6 +15,7 @@
 #include "hope-io/net/nix/tcp_acceptor.h"
 #include "hope-io/net/nix/tcp_stream.h"
 #include "hope-io/net/stream.h"
+#include "hope-io/net/endpoint.h"
 #include "hope-io/net/init.h"
 
 #include <sys/types.h>
@@ -37,8 +38,8 @@ namespace hope::io {
 
     stream* tcp_acceptor::accept() {
         int client_socket;
-        struct sockaddr_in client_sockaddr{};
-        unsigned int sin_size = sizeof(struct sockaddr);
+        struct sockaddr_storage client_sockaddr{};
+        socklen_t sin_size = sizeof(client_sockaddr);
         if ((client_socket = ::accept(m_socket, (struct sockaddr *)&client_sockaddr, &sin_size)) == -1) {
             HOPE_THROW_ERRNO("tcp_acceptor", "cannot accept connection");
         }
@@ -47,7 +48,11 @@ namespace hope::io {
 
     void tcp_acceptor::open(std::size_t port) {
         HOPE_ASSERT(m_socket == -1, "tcp_acceptor: open() called on already-open acceptor");
-        if ((m_socket = socket(AF_INET, SOCK_STREAM, 0)) == -1) {
+        endpoint server_addr;
+        if (!endpoint::for_listen(m_options.bind_address, (uint16_t)port, server_addr)) {
+            HOPE_THROW("tcp_acceptor", "bind_address is not a numeric IPv4/IPv6 address: " + m_options.bind_address);
+        }
+        if ((m_socket = listen_socket(server_addr, SOCK_STREAM, m_options.ipv6_only)) == -1) {
             HOPE_THROW_ERRNO("tcp_acceptor", "cannot create socket");
         }
 
@@ -86,13 +91,7 @@ namespace hope::io {
         if (m_options.recv_buffer_size > 0)
             setsockopt(m_socket, SOL_SOCKET, SO_RCVBUF, &m_options.recv_buffer_size, sizeof(m_options.recv_buffer_size));
 
-        struct sockaddr_in server_sockaddr{};
-        server_sockaddr.sin_family = AF_INET;
-        server_sockaddr.sin_port = htons(port);
-        server_sockaddr.sin_addr.s_addr = INADDR_ANY;
-        memset(&(server_sockaddr.sin_zero), 0, 8);
-
-        if ((bind(m_socket, (struct sockaddr *)&server_sockaddr, sizeof(struct sockaddr))) == -1) {
+        if (bind(m_socket, server_addr.addr(), server_addr.size) == -1) {
             HOPE_THROW_ERRNO("tcp_acceptor",
                 "cannot bind socket port:" + std::to_string(port));
         }
@@ -4,6 +4,8 @@
 #include "hope-io/coredefs.h"
 #if PLATFORM_LINUX || PLATFORM_APPLE
 #include "hope-io/net/nix/tcp_stream.h"
+#include "hope-io/net/endpoint.h"
+#include "hope-io/net/resolver.h"
 #include <array>
 #include <cassert>
 #include <stdexcept>
@@ -15,10 +17,17 @@
 #include <sys/socket.h>
 #include <sys/uio.h>
 #include <fcntl.h>
+#if PLATFORM_LINUX
+#include <sys/sendfile.h>
+#endif
 #include <arpa/inet.h>
 #include <poll.h>
 #include <time.h>
 #include <sys/time.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
 
 namespace hope::io {
     tcp_stream::tcp_stream(unsigned long long in_socket, const stream_options& opts)
@@ -33,39 +42,142 @@ namespace hope::io {
     }
     tcp_stream::~tcp_stream() { disconnect(); }
     std::string tcp_stream::get_endpoint() const {
-        struct sockaddr_in remote_sin{};
-        socklen_t remote_sinlen = sizeof(remote_sin);
-        getpeername(m_socket, (struct sockaddr*)&remote_sin, &remote_sinlen);
-        char *peeraddrpresn = inet_ntoa(remote_sin.sin_addr);
-        return peeraddrpresn;
+        struct sockaddr_storage remote{};
+        socklen_t remote_len = sizeof(remote);
+        getpeername(m_socket, (struct sockaddr*)&remote, &remote_len);
+        return endpoint::from((struct sockaddr*)&remote, remote_len).host();
     }
     int32_t tcp_stream::platform_socket() const { return (int32_t)m_socket; }
+    namespace {
+        // RFC 8305 "Connection Attempt Delay": the next address starts while the previous
+        // attempt is still pending, a dead address costs this much instead of a SYN timeout
+        constexpr int attempt_delay_ms = 250;
+
+        using steady = std::chrono::steady_clock;
+
+        int open_nonblocking(int family) {
+#ifdef SOCK_NONBLOCK
+            return socket(family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+#else
+            int fd = socket(family, SOCK_STREAM, 0);
+            if (fd != -1) {
+                fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+                fcntl(fd, F_SETFD, FD_CLOEXEC);
+            }
+            return fd;
+#endif
+        }
+
+        // Resolver order with families interleaved, preferred family first
+        std::vector<const endpoint*> interleave(const std::vector<endpoint>& list) {
+            std::vector<const endpoint*> first, second;
+            for (auto& ep : list) {
+                (first.empty() || ep.family() == first.front()->family() ? first : second).push_back(&ep);
+            }
+            std::vector<const endpoint*> ordered;
+            ordered.reserve(first.size() + second.size());
+            for (std::size_t i = 0; i < std::max(first.size(), second.size()); ++i) {
+                if (i < first.size()) ordered.push_back(first[i]);
+                if (i < second.size()) ordered.push_back(second[i]);
+            }
+            return ordered;
+        }
+    }
+
     void tcp_stream::connect(std::string_view ip, std::size_t port) {
         HOPE_ASSERT(m_socket == -1, "tcp_stream: connect() called without prior disconnect()");
-        struct addrinfo hints{};
-        hints.ai_family = AF_INET;
-        hints.ai_socktype = SOCK_STREAM;
-        struct addrinfo* res;
-        int err = getaddrinfo(ip.data(), nullptr, &hints, &res);
-        if (err != 0) HOPE_THROW_ERRNO("tcp_stream", "cannot resolve ip");
-        struct sockaddr_in serv_addr{};
-        serv_addr.sin_family = AF_INET;
-        serv_addr.sin_port = htons(port);
-        auto* ipv4 = (struct sockaddr_in*)res->ai_addr;
-        serv_addr.sin_addr = ipv4->sin_addr;
-        freeaddrinfo(res);
-        if ((m_socket = socket(AF_INET, SOCK_STREAM, 0)) == -1) HOPE_THROW_ERRNO("tcp_stream", "cannot create socket");
-
-        // Apply pre-connect socket options (TCP_NODELAY, buffer sizes, keepalive, etc.)
-        apply_constructor_options();
-
-        if (::connect(m_socket, (struct sockaddr *)&serv_addr, sizeof(struct sockaddr)) == -1) HOPE_THROW_ERRNO("tcp_stream", "cannot connect to host");
-
-        // non_block_mode applied post-connect (blocking connect needs to complete first)
-        if (m_options.non_block_mode) {
+        const std::string host(ip);
+        const auto service = std::to_string(port);
+        // Cached, a reconnect to the same name does not go back to DNS
+        const auto resolved = resolver::shared().resolve(host, (uint16_t)port);
+        if (resolved.addresses.empty()) HOPE_THROW("tcp_stream", "cannot resolve " + host + ": " + gai_strerror(resolved.error));
+        const auto candidates = interleave(resolved.addresses);
+
+        // Happy eyeballs: non-blocking attempts staggered by attempt_delay_ms, the first
+        // socket to connect wins, a refused attempt hands over to the next address at once.
+        // connection_timeout bounds the whole race, 0 leaves it to the kernel.
+        const auto deadline = steady::now() + std::chrono::milliseconds(m_options.connection_timeout);
+        std::vector<pollfd> pending;
+        std::size_t next = 0;
+        int winner = -1;
+        int last_error = ETIMEDOUT;
+        auto next_attempt = steady::now();
+        while (winner == -1) {
+            auto now = steady::now();
+            if (m_options.connection_timeout != 0 && now >= deadline) {
+                last_error = ETIMEDOUT;
+                break;
+            }
+            if (next < candidates.size() && (pending.empty() || now >= next_attempt)) {
+                auto* ep = candidates[next++];
+                int fd = open_nonblocking(ep->family());
+                if (fd == -1) {
+                    last_error = errno;
+                    continue;
+                }
+                // Pre-connect socket options (TCP_NODELAY, buffer sizes, keepalive, etc.)
+                apply_constructor_options(fd);
+                if (::connect(fd, ep->addr(), ep->size) == 0) {
+                    winner = fd;
+                    break;
+                }
+                if (errno != EINPROGRESS) {
+                    last_error = errno;
+                    close(fd);
+                    continue;
+                }
+                pending.push_back({ fd, POLLOUT, 0 });
+                next_attempt = now + std::chrono::milliseconds(attempt_delay_ms);
+            }
+            if (pending.empty()) {
+                if (next == candidates.size()) break; // every address failed
+                continue;
+            }
+
+            auto wait = -1;
+            if (next < candidates.size()) {
+                wait = (int)std::chrono::ceil<std::chrono::milliseconds>(next_attempt - now).count();
+            }
+            if (m_options.connection_timeout != 0) {
+                auto left = (int)std::chrono::ceil<std::chrono::milliseconds>(deadline - now).count();
+                wait = wait < 0 ? left : std::min(wait, left);
+            }
+            if (poll(pending.data(), pending.size(), wait) < 0 && errno != EINTR) {
+                last_error = errno;
+                break;
+            }
+            for (std::size_t i = 0; i < pending.size() && winner == -1;) {
+                if (pending[i].revents == 0) {
+                    ++i;
+                    continue;
+                }
+                int error = 0;
+                socklen_t len = sizeof(error);
+                if (getsockopt(pending[i].fd, SOL_SOCKET, SO_ERROR, &error, &len) == -1) error = errno;
+                if (error == 0) {
+                    winner = pending[i].fd;
+                } else {
+                    last_error = error;
+                    close(pending[i].fd);
+                    // The next address goes out right away
+                    next_attempt = steady::now();
+                }
+                pending.erase(pending.begin() + (std::ptrdiff_t)i);
+            }
+        }
+        for (auto& p : pending) close(p.fd);
+
+        if (winner == -1) {
+            errno = last_error;
+            HOPE_THROW_ERRNO("tcp_stream", "cannot connect to " + host + ":" + service);
+        }
+        m_socket = winner;
+
+        // Blocking I/O unless non_block_mode asks otherwise
+        if (!m_options.non_block_mode) {
             auto flags = fcntl(m_socket, F_GETFL, 0);
             if (flags != -1) {
-                fcntl(m_socket, F_SETFL, flags | O_NONBLOCK);
+                fcntl(m_socket, F_SETFL, flags & ~O_NONBLOCK);
             }
         }
     }
@@ -102,6 +214,37 @@ namespace hope::io {
             }
         }
     }
+    void tcp_stream::write_file(const std::string& path, uint64_t offset, uint64_t length) {
+        struct file final {
+            int fd;
+            ~file() { if (fd != -1) close(fd); }
+        } in{ open(path.c_str(), O_RDONLY | O_CLOEXEC) };
+        if (in.fd == -1) HOPE_THROW_ERRNO("tcp_stream", "cannot open " + path);
+
+        // Page cache straight to the socket, the data never enters user space
+        constexpr uint64_t max_chunk = 1ull << 30; // Linux caps a single call just below 2 GB
+        while (length > 0) {
+            const auto chunk = std::min(length, max_chunk);
+#if PLATFORM_LINUX
+            off_t at = (off_t)offset;
+            auto sent = sendfile(m_socket, in.fd, &at, (std::size_t)chunk);
+            if (sent == -1) {
+                if (errno == EINTR) continue;
+                HOPE_THROW_ERRNO("tcp_stream", "sendfile failed");
+            }
+#else
+            // Darwin: sendfile(file, socket, offset, &len, ...), len reports progress on EINTR/EAGAIN too
+            off_t sent = (off_t)chunk;
+            if (sendfile(in.fd, m_socket, (off_t)offset, &sent, nullptr, 0) == -1) {
+                if (errno != EINTR && errno != EAGAIN) HOPE_THROW_ERRNO("tcp_stream", "sendfile failed");
+                if (sent == 0) continue;
+            }
+#endif
+            if (sent == 0) HOPE_THROW("tcp_stream", "file is shorter than requested: " + path);
+            offset += (uint64_t)sent;
+            length -= (uint64_t)sent;
+        }
+    }
     size_t tcp_stream::read(void* data, std::size_t length) {
         std::size_t recv_bytes = 0;
         while (recv_bytes != length) {
@@ -117,17 +260,29 @@ namespace hope::io {
         if (received < 0) return 0;
         return (std::size_t)received;
     }
-    void tcp_stream::stream_in(std::string& buffer) { assert(false && "Not implemented"); }
+    void tcp_stream::stream_in(std::string& buffer) {
+        // Everything up to the peer's close
+        char chunk[16 * 1024];
+        while (true) {
+            auto received = recv(m_socket, chunk, sizeof(chunk), 0);
+            if (received == 0) break;
+            if (received == -1) {
+                if (errno == EINTR) continue;
+                HOPE_THROW_ERRNO("tcp_stream", "cannot read from stream");
+            }
+            buffer.append(chunk, (std::size_t)received);
+        }
+    }
 
-    void tcp_stream::apply_constructor_options() {
+    void tcp_stream::apply_constructor_options(int fd) const {
         // ── IPPROTO_TCP ────────────────────────────────────────
         if (m_options.tcp_nodelay) {
             int on = 1;
-            setsockopt(m_socket, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
         }
 #ifdef TCP_USER_TIMEOUT
         if (m_options.tcp_user_timeout >= 0) {
-            setsockopt(m_socket, IPPROTO_TCP, TCP_USER_TIMEOUT,
+            setsockopt(fd, IPPROTO_TCP, TCP_USER_TIMEOUT,
                        &m_options.tcp_user_timeout, sizeof(m_options.tcp_user_timeout));
         }
 #endif
@@ -135,63 +290,63 @@ namespace hope::io {
         // ── Keepalive ──────────────────────────────────────────
         if (m_options.keepalive) {
             int on = 1;
-            setsockopt(m_socket, SOL_SOCKET, SO_KEEPALIVE, &on, sizeof(on));
+            setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &on, sizeof(on));
         }
 #ifdef TCP_KEEPIDLE
         if (m_options.keepidle >= 0)
-            setsockopt(m_socket, IPPROTO_TCP, TCP_KEEPIDLE, &m_options.keepidle, sizeof(m_options.keepidle));
+            setsockopt(fd, IPPROTO_TCP, TCP_KEEPIDLE, &m_options.keepidle, sizeof(m_options.keepidle));
 #endif
 #ifdef TCP_KEEPINTVL
         if (m_options.keepintvl >= 0)
-            setsockopt(m_socket, IPPROTO_TCP, TCP_KEEPINTVL, &m_options.keepintvl, sizeof(m_options.keepintvl));
+            setsockopt(fd, IPPROTO_TCP, TCP_KEEPINTVL, &m_options.keepintvl, sizeof(m_options.keepintvl));
 #endif
 #ifdef TCP_KEEPCNT
         if (m_options.keepcnt >= 0)
-            setsockopt(m_socket, IPPROTO_TCP, TCP_KEEPCNT, &m_options.keepcnt, sizeof(m_options.keepcnt));
+            setsockopt(fd, IPPROTO_TCP, TCP_KEEPCNT, &m_options.keepcnt, sizeof(m_options.keepcnt));
 #endif
 
         // ── Socket buffer ──────────────────────────────────────
         if (m_options.send_buffer_size > 0)
-            setsockopt(m_socket, SOL_SOCKET, SO_SNDBUF, &m_options.send_buffer_size, sizeof(m_options.send_buffer_size));
+            setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &m_options.send_buffer_size, sizeof(m_options.send_buffer_size));
         if (m_options.recv_buffer_size > 0)
-            setsockopt(m_socket, SOL_SOCKET, SO_RCVBUF, &m_options.recv_buffer_size, sizeof(m_options.recv_buffer_size));
+            setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &m_options.recv_buffer_size, sizeof(m_options.recv_buffer_size));
 
         // ── Socket behavior ────────────────────────────────────
         if (m_options.reuse_address) {
             int on = 1;
-            setsockopt(m_socket, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
         }
 #ifdef SO_REUSEPORT
         if (m_options.reuse_port) {
             int on = 1;
-            setsockopt(m_socket, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on));
+            setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on));
         }
 #endif
         if (m_options.linger_on) {
             struct linger l;
             l.l_onoff = m_options.linger_on;
             l.l_linger = m_options.linger_seconds;
-            setsockopt(m_socket, SOL_SOCKET, SO_LINGER, &l, sizeof(l));
+            setsockopt(fd, SOL_SOCKET, SO_LINGER, &l, sizeof(l));
         }
 #ifdef SO_PRIORITY
         if (m_options.priority >= 0)
-            setsockopt(m_socket, SOL_SOCKET, SO_PRIORITY, &m_options.priority, sizeof(m_options.priority));
+            setsockopt(fd, SOL_SOCKET, SO_PRIORITY, &m_options.priority, sizeof(m_options.priority));
 #endif
 
         // ── IP-level ───────────────────────────────────────────
         if (m_options.ttl >= 0)
-            setsockopt(m_socket, IPPROTO_IP, IP_TTL, &m_options.ttl, sizeof(m_options.ttl));
+            setsockopt(fd, IPPROTO_IP, IP_TTL, &m_options.ttl, sizeof(m_options.ttl));
 #ifdef IP_TOS
         if (m_options.tos >= 0)
-            setsockopt(m_socket, IPPROTO_IP, IP_TOS, &m_options.tos, sizeof(m_options.tos));
+            setsockopt(fd, IPPROTO_IP, IP_TOS, &m_options.tos, sizeof(m_options.tos));
 #endif
 #ifdef SO_MARK
         if (m_options.mark >= 0)
-            setsockopt(m_socket, SOL_SOCKET, SO_MARK, &m_options.mark, sizeof(m_options.mark));
+            setsockopt(fd, SOL_SOCKET, SO_MARK, &m_options.mark, sizeof(m_options.mark));
 #endif
 #ifdef SO_BINDTODEVICE
         if (!m_options.bind_device.empty())
-            setsockopt(m_socket, SOL_SOCKET, SO_BINDTODEVICE,
+            setsockopt(fd, SOL_SOCKET, SO_BINDTODEVICE,
                        m_options.bind_device.c_str(), m_options.bind_device.size());
 #endif
 
@@ -199,16 +354,16 @@ namespace hope::io {
         struct timeval tv;
         tv.tv_sec = m_options.read_timeout / 1000;
         tv.tv_usec = (m_options.read_timeout % 1000) * 1000;
-        setsockopt(m_socket, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
         tv.tv_sec = m_options.write_timeout / 1000;
         tv.tv_usec = (m_options.write_timeout % 1000) * 1000;
-        setsockopt(m_socket, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
     }
 
     void tcp_stream::set_options(const hope::io::stream_options& opt) {
         HOPE_ASSERT(m_socket >= 0, "tcp_stream: set_options() called before connect()");
         m_options = opt;
-        apply_constructor_options();
+        apply_constructor_options(m_socket);
         // Re-apply non_block_mode
         int flags = fcntl(m_socket, F_GETFL, 0);
         if (flags == -1) {
@@ -30,6 +30,7 @@ namespace hope::io {
 
         void write(const void *data, std::size_t length) override;
         void write_v(std::span<const std::span<const char>> buffers) override;
+        void write_file(const std::string& path, uint64_t offset, uint64_t length) override;
 
         size_t read(void *data, std::size_t length) override;
         size_t read_once(void* data, std::size_t length) override;
@@ -40,7 +41,7 @@ namespace hope::io {
         using stream::read;
 
     private:
-        void apply_constructor_options();
+        void apply_constructor_options(int fd) const;
 
         int m_socket{ -1 };
         stream_options m_options;
@@ -11,6 +11,7 @@
 #include "hope-io/coredefs.h"
 #include "hope-io/net/tls_event_loop.h"
 #include "hope-io/net/event_loop.h"
+#include "hope-io/net/endpoint.h"
 #include "hope-io/net/stream_options_util.h"
 #include "hope-io/net/init.h"
 
@@ -58,7 +59,7 @@ namespace hope::io::el {
                 if (tls.ssl) SSL_free(tls.ssl);
             }
             m_tls_states.clear();
-            std::vector<fixed_size_buffer*> bufs;
+            std::vector<tiered_buffer*> bufs;
             for (const auto& conn : m_connections) {
                 if (conn.buffer) {
                     bufs.push_back(conn.buffer);
@@ -95,7 +96,13 @@ namespace hope::io::el {
             SSL_CTX_set_session_cache_mode(m_ctx, SSL_SESS_CACHE_SERVER);
             SSL_CTX_sess_set_cache_size(m_ctx, 128);
 
-            m_listen_socket = socket(AF_INET, SOCK_STREAM, 0);
+            endpoint srv_addr;
+            if (!endpoint::for_listen(cfg.bind_address, (uint16_t)cfg.port, srv_addr)) {
+                SSL_CTX_free(m_ctx);
+                m_ctx = nullptr;
+                HOPE_THROW("tls_event_loop", "bind_address is not a numeric IPv4/IPv6 address: " + cfg.bind_address);
+            }
+            m_listen_socket = listen_socket(srv_addr, SOCK_STREAM, cfg.ipv6_only);
             if (m_listen_socket == -1) {
                 SSL_CTX_free(m_ctx);
                 m_ctx = nullptr;
@@ -105,11 +112,7 @@ namespace hope::io::el {
             int reuse = 1;
             setsockopt(m_listen_socket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
 
-            sockaddr_in srv_addr{};
-            srv_addr.sin_family = AF_INET;
-            srv_addr.sin_addr.s_addr = INADDR_ANY;
-            srv_addr.sin_port = htons(cfg.port);
-            if (bind(m_listen_socket, (struct sockaddr*)&srv_addr, sizeof(srv_addr)) == -1) {
+            if (bind(m_listen_socket, srv_addr.addr(), srv_addr.size) == -1) {
                 throw_bind_err();
             }
 
@@ -214,7 +217,7 @@ namespace hope::io::el {
             NAMED_SCOPE(TlsKqHandleAccept);
             for (auto i = 0; i < m_cfg.max_accepts_per_tick; ++i) {
                 NAMED_SCOPE(TlsKqAcceptOne);
-                struct sockaddr_in client_addr{};
+                struct sockaddr_storage client_addr{};
                 socklen_t socklen = sizeof(client_addr);
                 int sock = accept(m_listen_socket, (struct sockaddr*)&client_addr, &socklen);
                 if (sock == -1) break;
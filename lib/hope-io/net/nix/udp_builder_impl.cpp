@@ -11,6 +11,7 @@
 #if PLATFORM_LINUX || PLATFORM_APPLE
 
 #include "hope-io/net/nix/udp_builder_impl.h"
+#include "hope-io/net/endpoint.h"
 
 #include <exception>
 #include <stdexcept>
@@ -26,19 +27,16 @@ namespace hope::io {
     }
 
     void udp_builder_impl::init(std::size_t port) {
-        if ((m_socket = socket(AF_INET, SOCK_DGRAM, 0)) == -1) {
+        // Every interface on both stacks
+        endpoint local;
+        endpoint::for_listen({}, (uint16_t)port, local);
+        if ((m_socket = listen_socket(local, SOCK_DGRAM, false)) == -1) {
             throw std::runtime_error("hope-io/udp_builder_impl: cannot create socket");
         }
         int no_delay = 1;
         setsockopt(m_socket, SOL_SOCKET, SO_REUSEADDR, &no_delay, sizeof(no_delay));
 
-        struct sockaddr_in server_sockaddr{};
-        server_sockaddr.sin_family = AF_INET;
-        server_sockaddr.sin_port = htons(port);
-        server_sockaddr.sin_addr.s_addr = INADDR_ANY;
-        memset(&(server_sockaddr.sin_zero), 0, 8);
-
-        if ((bind(m_socket, (struct sockaddr *)&server_sockaddr, sizeof(struct sockaddr))) == -1) {
+        if (bind(m_socket, local.addr(), local.size) == -1) {
             throw std::runtime_error("hope-io/udp_builder_impl: cannot bind socket");
         }
     }
@@ -11,6 +11,8 @@
 #if PLATFORM_LINUX || PLATFORM_APPLE
 
 #include "hope-io/net/nix/udp_receiver_impl.h"
+#include "hope-io/net/endpoint.h"
+#include "hope-io/net/resolver.h"
 
 #include <cstdlib>
 #include <cstring>
@@ -38,21 +40,23 @@ namespace hope::io {
     }
 
     void udp_receiver_impl::connect(const std::string_view ip, std::size_t port) {
-        struct hostent *host;
-        if ((host = gethostbyname(ip.data())) == nullptr) {
+        // A socket handed in (udp_builder) fixes the family, IPv4 hosts reach a dual-stack one mapped
+        int family = AF_UNSPEC;
+        if (m_socket) {
+            sockaddr_storage local{};
+            socklen_t len = sizeof(local);
+            if (getsockname(m_socket, (struct sockaddr*)&local, &len) == 0) family = local.ss_family;
+        }
+        auto resolved = resolver::shared().resolve(ip, (uint16_t)port);
+        if (!resolved.pick(family, m_peer)) {
             throw std::runtime_error("hope-io/udp_receiver_impl: cannot resolve ip: " +
-                                     std::string(strerror(errno)));
+                                     std::string(gai_strerror(resolved.error != 0 ? resolved.error : EAI_FAMILY)));
         }
 
-        if (!m_socket && (m_socket = socket(AF_INET, SOCK_DGRAM, 0)) == -1) {
+        if (!m_socket && (m_socket = socket(m_peer.family(), SOCK_DGRAM, 0)) == -1) {
             throw std::runtime_error("hope-io/udp_receiver_impl: cannot create socket: " +
                                      std::string(strerror(errno)));
         }
-
-        serv_addr.sin_family = AF_INET;
-        serv_addr.sin_port = htons(port);
-        serv_addr.sin_addr = *((struct in_addr *)host->h_addr);
-        bzero(&(serv_addr.sin_zero), 8);
     }
 
     void udp_receiver_impl::disconnect() {
@@ -63,9 +67,9 @@ namespace hope::io {
     }
 
     size_t udp_receiver_impl::read(void* data, std::size_t length) {
-        socklen_t len = sizeof(serv_addr);
+        m_peer.size = sizeof(m_peer.storage);
         auto recv_bytes = recvfrom(m_socket, (char*)data, length, 0,
-                                   (struct sockaddr *)&serv_addr, &len);
+                                   (struct sockaddr *)&m_peer.storage, &m_peer.size);
         if (recv_bytes == -1) {
             throw std::runtime_error("hope-io/udp_receiver_impl: failed to read data: " +
                                      std::string(strerror(errno)));
@@ -12,7 +12,7 @@
 
 #if PLATFORM_LINUX || PLATFORM_APPLE
 
-#include <netinet/in.h>
+#include "hope-io/net/endpoint.h"
 
 namespace hope::io {
 
@@ -30,7 +30,7 @@ namespace hope::io {
 
     private:
         int m_socket{ 0 };
-        struct sockaddr_in serv_addr{};
+        endpoint m_peer;
     };
 
 }
@@ -0,0 +1,116 @@
+/* Copyright (C) 2026 Gleb Bezborodov - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: bezborodoff.gleb@gmail.com, or visit : https://github.com/glensand/hope-io
+ */
+
+#pragma once
+
+#include "hope-io/coredefs.h"
+
+#if PLATFORM_LINUX || PLATFORM_APPLE
+
+#include "hope-io/net/endpoint.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace hope::io {
+
+    struct resolver_options final {
+        // getaddrinfo does not report record TTLs, answers are kept for a fixed time
+        std::chrono::milliseconds ttl = std::chrono::seconds(30);
+        std::chrono::milliseconds negative_ttl = std::chrono::seconds(5); // failed lookups, EAI_AGAIN is not cached
+        std::size_t max_entries = 1024;
+        std::size_t workers = 2;            // resolve_async threads, started on first use
+        std::string hosts_file;             // /etc/hosts format; names found there never reach DNS
+    };
+
+    // Thread-safe name cache in front of getaddrinfo. Numeric addresses skip it entirely.
+    class resolver final {
+    public:
+        struct result final {
+            std::vector<endpoint> addresses;    // getaddrinfo order, port filled in
+            int error = 0;                      // EAI_* when addresses is empty
+
+            // First address of family (AF_UNSPEC: any). An IPv6 socket reaches
+            // IPv4-only names through their v4-mapped form.
+            bool pick(int family, endpoint& out) const;
+        };
+
+        struct stats final {
+            uint64_t hits = 0;
+            uint64_t negative_hits = 0;
+            uint64_t misses = 0;                // lookups that went to getaddrinfo
+        };
+
+        using callback = std::function<void(const result&)>;
+
+        explicit resolver(resolver_options options = {});
+        ~resolver();
+
+        resolver(const resolver&) = delete;
+        resolver& operator=(const resolver&) = delete;
+
+        // Blocking on a miss
+        result resolve(std::string_view host, uint16_t port);
+
+        // Never blocks. Cache hits call cb right away on the calling thread, misses call it
+        // from a worker thread (cb must not throw); concurrent misses for one name share a single lookup.
+        // Lookups not yet started when the resolver is destroyed complete with EAI_AGAIN.
+        // From an event loop, hand the answer back with post(fn):
+        //     res.resolve_async(name, port, [&loop](const resolver::result& r) { loop.post([r] { ... }); });
+        void resolve_async(std::string_view host, uint16_t port, callback cb);
+
+        void clear();
+        stats get_stats() const;
+
+        // Process-wide instance behind tcp_stream and the UDP sender/receiver
+        static resolver& shared();
+
+    private:
+        struct entry final {
+            std::vector<endpoint> addresses;    // port 0
+            int error = 0;
+            std::chrono::steady_clock::time_point expires;
+        };
+
+        struct waiter final {
+            uint16_t port;
+            callback cb;
+        };
+
+        static result with_port(const entry& e, uint16_t port);
+        static entry lookup(const std::string& host);
+
+        bool find(const std::string& host, uint16_t port, result& out);
+        void store(const std::string& host, entry e);
+        void load_hosts_file();
+        void worker();
+
+        resolver_options m_options;
+        std::unordered_map<std::string, entry> m_hosts;     // hosts_file, never expires
+        std::unordered_map<std::string, entry> m_cache;
+        std::unordered_map<std::string, std::vector<waiter>> m_in_flight;
+        std::deque<std::string> m_queue;
+        std::vector<std::thread> m_workers;
+        mutable std::mutex m_lock;
+        std::condition_variable m_wake;
+        stats m_stats;
+        bool m_stopping = false;
+    };
+
+}
+
+#endif
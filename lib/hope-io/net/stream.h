@@ -8,8 +8,12 @@
 
 #pragma once
 
+#include <algorithm>
 #include <memory>
 #include <cassert>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
 #include <string>
 #include <span>
 #include <type_traits>
@@ -49,10 +53,13 @@ namespace hope::io {
         int    tos                  = -1;      // IP_TOS / DSCP field (-1=leave default)
         int    mark                 = -1;      // SO_MARK — socket mark for policy routing
         std::string bind_device;               // SO_BINDTODEVICE — bind to interface name
+
+        // ── Listen address (acceptors) ─────────────────────────
+        std::string bind_address;              // numeric IPv4/IPv6, empty = all interfaces, both stacks
+        bool   ipv6_only            = false;   // IPV6_V6ONLY on an IPv6 listener
     };
 
-    // TODO:: need to split streams somehow, add sync/async versions
-    // async version should have program side store buffer, and possibility to submit buffer data with single batch
+    // Blocking stream; the coroutine counterpart driven by an event loop is el::co::async_stream (async_stream.h)
     class stream {
     public:
         virtual ~stream() = default;
@@ -71,6 +78,25 @@ namespace hope::io {
         /// Falls back to sequential write() on platforms that do not support scatter-gather.
         virtual void write_v(std::span<const std::span<const char>> buffers) = 0;
 
+        /// Send length bytes of the file at path, starting at offset. This default reads the file
+        /// through a heap buffer into write(); socket streams override it so the kernel moves the
+        /// pages (sendfile) without a user-space copy.
+        virtual void write_file(const std::string& path, uint64_t offset, uint64_t length) {
+            std::ifstream in(path, std::ios::binary);
+            if (!in || !in.seekg((std::streamoff)offset)) {
+                throw std::runtime_error("hope-io/stream: cannot open file: " + path);
+            }
+            constexpr std::size_t buffer_size = 256 * 1024;
+            auto buffer = std::make_unique<char[]>(buffer_size);
+            while (length > 0) {
+                in.read(buffer.get(), (std::streamsize)std::min<uint64_t>(buffer_size, length));
+                const auto got = (std::size_t)in.gcount();
+                if (got == 0) throw std::runtime_error("hope-io/stream: file is shorter than requested: " + path);
+                write(buffer.get(), got);
+                length -= got;
+            }
+        }
+
         virtual size_t read(void *data, std::size_t length) = 0;
         virtual size_t read_once(void* data, std::size_t length) = 0;
 
@@ -15,6 +15,10 @@
 #include "hope-io/net/stream.h"
 #include "hope-io/coredefs.h"
 
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
 #if PLATFORM_LINUX || PLATFORM_APPLE
 #include <netinet/ip.h>
 #include <netinet/tcp.h>
@@ -23,73 +27,114 @@
 
 namespace hope::io {
 
-inline void apply_stream_options(int fd, const stream_options& opt) {
-    if (opt.tcp_nodelay) {
-        int on = 1;
-        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
-    }
+// stream_options compiled once into the setsockopt calls they stand for, so accepting
+// a connection walks a short flat list instead of re-checking every field.
+class socket_option_list final {
+public:
+    socket_option_list() = default;
 
+    explicit socket_option_list(const stream_options& opt) {
+        if (opt.tcp_nodelay) {
+            add(IPPROTO_TCP, TCP_NODELAY, 1);
+        }
 #ifdef TCP_USER_TIMEOUT
-    if (opt.tcp_user_timeout >= 0) {
-        setsockopt(fd, IPPROTO_TCP, TCP_USER_TIMEOUT, &opt.tcp_user_timeout, sizeof(opt.tcp_user_timeout));
-    }
+        if (opt.tcp_user_timeout >= 0) {
+            add(IPPROTO_TCP, TCP_USER_TIMEOUT, opt.tcp_user_timeout);
+        }
 #endif
-
-    if (opt.keepalive) {
-        int on = 1;
-        setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &on, sizeof(on));
-    }
-
+        if (opt.keepalive) {
+            add(SOL_SOCKET, SO_KEEPALIVE, 1);
+        }
 #ifdef TCP_KEEPIDLE
-    if (opt.keepidle >= 0) {
-        setsockopt(fd, IPPROTO_TCP, TCP_KEEPIDLE, &opt.keepidle, sizeof(opt.keepidle));
-    }
+        if (opt.keepidle >= 0) {
+            add(IPPROTO_TCP, TCP_KEEPIDLE, opt.keepidle);
+        }
 #endif
-
 #ifdef TCP_KEEPINTVL
-    if (opt.keepintvl >= 0) {
-        setsockopt(fd, IPPROTO_TCP, TCP_KEEPINTVL, &opt.keepintvl, sizeof(opt.keepintvl));
-    }
+        if (opt.keepintvl >= 0) {
+            add(IPPROTO_TCP, TCP_KEEPINTVL, opt.keepintvl);
+        }
 #endif
-
 #ifdef TCP_KEEPCNT
-    if (opt.keepcnt >= 0) {
-        setsockopt(fd, IPPROTO_TCP, TCP_KEEPCNT, &opt.keepcnt, sizeof(opt.keepcnt));
-    }
+        if (opt.keepcnt >= 0) {
+            add(IPPROTO_TCP, TCP_KEEPCNT, opt.keepcnt);
+        }
+#endif
+        if (opt.send_buffer_size >= 0) {
+            add(SOL_SOCKET, SO_SNDBUF, opt.send_buffer_size);
+        }
+        if (opt.recv_buffer_size >= 0) {
+            add(SOL_SOCKET, SO_RCVBUF, opt.recv_buffer_size);
+        }
+        if (opt.linger_on) {
+            struct linger l;
+            l.l_onoff = opt.linger_on;
+            l.l_linger = opt.linger_seconds;
+            add(SOL_SOCKET, SO_LINGER, l);
+        }
+#ifdef IP_TTL
+        if (opt.ttl >= 0) {
+            add(IPPROTO_IP, IP_TTL, opt.ttl);
+        }
+#endif
+#ifdef IP_TOS
+        if (opt.tos >= 0) {
+            // Not inherited: with net.ipv4.tcp_reflect_tos the child takes the SYN's TOS
+            add(IPPROTO_IP, IP_TOS, opt.tos, false);
+        }
+#endif
+#ifdef SO_MARK
+        if (opt.mark >= 0) {
+            add(SOL_SOCKET, SO_MARK, opt.mark);
+        }
 #endif
-
-    if (opt.send_buffer_size >= 0) {
-        setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &opt.send_buffer_size, sizeof(opt.send_buffer_size));
     }
 
-    if (opt.recv_buffer_size >= 0) {
-        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &opt.recv_buffer_size, sizeof(opt.recv_buffer_size));
+    void apply(int fd) const noexcept {
+        for (auto& e : m_entries) {
+            setsockopt(fd, e.level, e.name, e.value, e.size);
+        }
     }
 
-    if (opt.linger_on) {
-        struct linger l;
-        l.l_onoff = opt.linger_on;
-        l.l_linger = opt.linger_seconds;
-        setsockopt(fd, SOL_SOCKET, SO_LINGER, &l, sizeof(l));
+    // Moves out the options a listening socket hands down to every connection it accepts:
+    // Linux clones the listener's socket, so setting them once on the listener replaces
+    // a setsockopt per accept. What remains has to be applied to each accepted socket.
+    socket_option_list take_inherited() {
+        socket_option_list inherited;
+#if PLATFORM_LINUX
+        auto it = std::stable_partition(m_entries.begin(), m_entries.end(),
+                                        [](const entry& e) { return !e.inherited; });
+        inherited.m_entries.assign(it, m_entries.end());
+        m_entries.erase(it, m_entries.end());
+#endif
+        return inherited;
     }
 
-#ifdef IP_TTL
-    if (opt.ttl >= 0) {
-        setsockopt(fd, IPPROTO_IP, IP_TTL, &opt.ttl, sizeof(opt.ttl));
+    bool empty() const noexcept { return m_entries.empty(); }
+    std::size_t size() const noexcept { return m_entries.size(); }
+
+private:
+    struct entry {
+        int level;
+        int name;
+        socklen_t size;
+        bool inherited;
+        alignas(struct linger) unsigned char value[sizeof(struct linger)];
+    };
+
+    template<typename T>
+    void add(int level, int name, const T& value, bool inherited = true) {
+        static_assert(sizeof(T) <= sizeof(entry::value));
+        entry e{ level, name, (socklen_t)sizeof(T), inherited, {} };
+        std::memcpy(e.value, &value, sizeof(T));
+        m_entries.push_back(e);
     }
-#endif
 
-#ifdef IP_TOS
-    if (opt.tos >= 0) {
-        setsockopt(fd, IPPROTO_IP, IP_TOS, &opt.tos, sizeof(opt.tos));
-    }
-#endif
+    std::vector<entry> m_entries;
+};
 
-#ifdef SO_MARK
-    if (opt.mark >= 0) {
-        setsockopt(fd, SOL_SOCKET, SO_MARK, &opt.mark, sizeof(opt.mark));
-    }
-#endif
+inline void apply_stream_options(int fd, const stream_options& opt) {
+    socket_option_list(opt).apply(fd);
 }
 
 } // namespace hope::io
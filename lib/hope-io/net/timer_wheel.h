@@ -0,0 +1,256 @@
+/* Copyright (C) 2026 Gleb Bezborodov - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: bezborodoff.gleb@gmail.com, or visit : https://github.com/glensand/hope-io
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+namespace hope::io::el {
+
+    // Hierarchical timing wheel: 4 levels x 64 slots, one tick = resolution.
+    // schedule/cancel are O(1) (slab node + intrusive list), a timer further away than
+    // the level it sits on is cascaded down when the lower level wraps.
+    // Single threaded, owned and driven by one event loop: the loop waits at most
+    // next_timeout_ms() and calls advance(now) once per tick.
+    class timer_wheel final {
+    public:
+        using clock = std::chrono::steady_clock;
+        using timer_id = uint64_t; // 0 is never a valid id
+
+        constexpr static unsigned slot_bits = 6;
+        constexpr static unsigned slots = 1u << slot_bits;
+        constexpr static unsigned levels = 4;
+
+        explicit timer_wheel(std::chrono::milliseconds resolution = std::chrono::milliseconds(1))
+            : m_resolution(std::max<int64_t>(1, resolution.count()))
+            , m_start(clock::now()) {
+            m_heads.fill(npos);
+        }
+
+        timer_id schedule(std::chrono::milliseconds delay, std::function<void()> fn) {
+            auto ticks = (uint64_t)std::max<int64_t>(0, (delay.count() + m_resolution - 1) / m_resolution);
+            auto index = allocate_node();
+            auto& n = m_nodes[index];
+            n.when = m_now + std::max<uint64_t>(1, ticks);
+            n.fn = std::move(fn);
+            link(index);
+            ++m_count;
+            return (uint64_t(n.generation) << 32) | (index + 1);
+        }
+
+        // Returns false if the timer already fired or was cancelled.
+        bool cancel(timer_id id) {
+            if (id == 0) return false;
+            auto index = uint32_t(id & 0xffffffffu) - 1;
+            if (index >= m_nodes.size()) return false;
+            auto& n = m_nodes[index];
+            if (!n.active || n.generation != uint32_t(id >> 32)) return false;
+            unlink(index);
+            release_node(index);
+            --m_count;
+            return true;
+        }
+
+        // Fires every timer due at or before now, callbacks may schedule and cancel.
+        void advance(clock::time_point now) {
+            auto target = uint64_t(std::chrono::duration_cast<std::chrono::milliseconds>(now - m_start).count()) / m_resolution;
+            if (m_count == 0) {
+                if (target > m_now) m_now = target;
+                return;
+            }
+            while (m_now < target) {
+                ++m_now;
+                cascade();
+                auto slot = m_now & (slots - 1);
+                while (m_heads[slot] != npos) {
+                    auto index = m_heads[slot];
+                    unlink(index);
+                    auto fn = std::move(m_nodes[index].fn);
+                    release_node(index);
+                    --m_count;
+                    fn();
+                }
+                if (m_count == 0 && m_now < target) m_now = target;
+            }
+        }
+
+        // Milliseconds the owner may sleep, never more than cap.
+        int next_timeout_ms(int cap) const {
+            if (m_count == 0) return cap;
+            uint64_t ticks = slots - (m_now & (slots - 1)); // next level 1 cascade
+            for (uint64_t i = 1; i < ticks; ++i) {
+                if (m_heads[(m_now + i) & (slots - 1)] != npos) {
+                    ticks = i;
+                    break;
+                }
+            }
+            auto elapsed = uint64_t(std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - m_start).count());
+            auto due = (m_now + ticks) * m_resolution;
+            if (due <= elapsed) return 0;
+            return (int)std::min<uint64_t>(due - elapsed, cap < 0 ? std::numeric_limits<int>::max() : (uint64_t)cap);
+        }
+
+        // Current tick, a cheap timestamp for activity tracking.
+        uint64_t now_tick() const noexcept { return m_now; }
+        int64_t resolution_ms() const noexcept { return m_resolution; }
+        std::size_t size() const noexcept { return m_count; }
+
+    private:
+        constexpr static uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+        struct node {
+            uint64_t when = 0;
+            std::function<void()> fn;
+            uint32_t prev = npos;
+            uint32_t next = npos;
+            uint32_t slot = npos;
+            uint32_t generation = 1;
+            bool active = false;
+        };
+
+        uint32_t slot_of(uint64_t when) const noexcept {
+            auto delta = when - m_now;
+            for (unsigned level = 0; level < levels; ++level) {
+                if (delta < (uint64_t(1) << (slot_bits * (level + 1)))) {
+                    return level * slots + uint32_t((when >> (slot_bits * level)) & (slots - 1));
+                }
+            }
+            // Beyond the wheel span: park on the top level, re-cascaded until it fits
+            auto level = levels - 1;
+            auto parked = m_now + ((uint64_t(1) << (slot_bits * levels)) - 1);
+            return level * slots + uint32_t((parked >> (slot_bits * level)) & (slots - 1));
+        }
+
+        // Re-files the timers of every higher level slot whose lower levels just wrapped.
+        void cascade() {
+            unsigned top = 0;
+            while (top + 1 < levels && (m_now & ((uint64_t(1) << (slot_bits * (top + 1))) - 1)) == 0) {
+                ++top;
+            }
+            for (unsigned level = top; level > 0; --level) {
+                auto slot = level * slots + uint32_t((m_now >> (slot_bits * level)) & (slots - 1));
+                while (m_heads[slot] != npos) {
+                    auto index = m_heads[slot];
+                    unlink(index);
+                    link(index);
+                }
+            }
+        }
+
+        void link(uint32_t index) {
+            auto& n = m_nodes[index];
+            n.slot = slot_of(std::max(n.when, m_now)); // due now: current level 0 slot, fired right after cascade()
+            n.prev = npos;
+            n.next = m_heads[n.slot];
+            if (n.next != npos) m_nodes[n.next].prev = index;
+            m_heads[n.slot] = index;
+        }
+
+        void unlink(uint32_t index) {
+            auto& n = m_nodes[index];
+            if (n.prev != npos) m_nodes[n.prev].next = n.next;
+            else m_heads[n.slot] = n.next;
+            if (n.next != npos) m_nodes[n.next].prev = n.prev;
+            n.prev = n.next = n.slot = npos;
+        }
+
+        uint32_t allocate_node() {
+            uint32_t index;
+            if (!m_free.empty()) {
+                index = m_free.back();
+                m_free.pop_back();
+            } else {
+                index = (uint32_t)m_nodes.size();
+                m_nodes.emplace_back();
+            }
+            m_nodes[index].active = true;
+            return index;
+        }
+
+        void release_node(uint32_t index) {
+            auto& n = m_nodes[index];
+            n.active = false;
+            n.fn = nullptr;
+            ++n.generation;
+            m_free.push_back(index);
+        }
+
+        int64_t m_resolution;
+        clock::time_point m_start;
+        uint64_t m_now = 0;
+        std::size_t m_count = 0;
+        std::array<uint32_t, levels * slots> m_heads;
+        std::vector<node> m_nodes;
+        std::vector<uint32_t> m_free;
+    };
+
+    // One lazily refreshed timeout per descriptor (idle timeouts, handshake deadlines).
+    // touch() only stamps the current tick; when the timer fires early because of
+    // activity it re-arms for the remainder instead of being rescheduled on every read.
+    class descriptor_timeouts final {
+    public:
+        descriptor_timeouts(timer_wheel& wheel, std::function<void(int32_t)> on_expire)
+            : m_wheel(wheel)
+            , m_on_expire(std::move(on_expire)) {}
+
+        void arm(int32_t fd, std::chrono::milliseconds timeout) {
+            if (timeout.count() <= 0) return;
+            if ((std::size_t)fd >= m_entries.size()) m_entries.resize(fd + 1);
+            auto& e = m_entries[fd];
+            m_wheel.cancel(e.id);
+            e.timeout_ticks = uint64_t(timeout.count() + m_wheel.resolution_ms() - 1) / m_wheel.resolution_ms();
+            e.last_tick = m_wheel.now_tick();
+            e.id = m_wheel.schedule(timeout, [this, fd] { on_timer(fd); });
+        }
+
+        void touch(int32_t fd) noexcept {
+            if ((std::size_t)fd < m_entries.size()) m_entries[fd].last_tick = m_wheel.now_tick();
+        }
+
+        void disarm(int32_t fd) {
+            if ((std::size_t)fd >= m_entries.size()) return;
+            auto& e = m_entries[fd];
+            m_wheel.cancel(e.id);
+            e.id = 0;
+        }
+
+        bool is_armed(int32_t fd) const noexcept {
+            return (std::size_t)fd < m_entries.size() && m_entries[fd].id != 0;
+        }
+
+    private:
+        struct entry {
+            timer_wheel::timer_id id = 0;
+            uint64_t last_tick = 0;
+            uint64_t timeout_ticks = 0;
+        };
+
+        void on_timer(int32_t fd) {
+            auto& e = m_entries[fd];
+            e.id = 0;
+            auto idle = m_wheel.now_tick() - e.last_tick;
+            if (idle < e.timeout_ticks) {
+                auto rest = std::chrono::milliseconds((e.timeout_ticks - idle) * m_wheel.resolution_ms());
+                e.id = m_wheel.schedule(rest, [this, fd] { on_timer(fd); });
+                return;
+            }
+            m_on_expire(fd);
+        }
+
+        timer_wheel& m_wheel;
+        std::function<void(int32_t)> m_on_expire;
+        std::vector<entry> m_entries;
+    };
+
+}
@@ -8,72 +8,295 @@
 
 #include "hope-io/net/tls/ktls_enable.h"
 
+#include "openssl/hmac.h"
+#include "openssl/crypto.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <string_view>
+
+namespace hope::io {
+
+namespace {
+    std::atomic<uint64_t> g_kernel{ 0 };
+    std::atomic<uint64_t> g_unsupported{ 0 };
+    std::atomic<uint64_t> g_refused{ 0 };
+    std::atomic<uint64_t> g_broken{ 0 };
+
+    // HKDF-Expand-Label(secret, label, "", out.size()). Keys and IVs are never longer than
+    // the hash, so the first HKDF block T(1) is all of it.
+    bool expand_label(const EVP_MD* digest, std::span<const uint8_t> secret,
+                      std::string_view label, std::span<uint8_t> out) {
+        constexpr std::string_view prefix = "tls13 ";
+        if (digest == nullptr || out.size() > (std::size_t)EVP_MD_size(digest)) return false;
+
+        uint8_t info[2 + 1 + 32 + 1 + 1];
+        std::size_t n = 0;
+        info[n++] = (uint8_t)(out.size() >> 8);
+        info[n++] = (uint8_t)out.size();
+        info[n++] = (uint8_t)(prefix.size() + label.size());
+        std::memcpy(info + n, prefix.data(), prefix.size());
+        n += prefix.size();
+        std::memcpy(info + n, label.data(), label.size());
+        n += label.size();
+        info[n++] = 0;  // empty context
+        info[n++] = 1;  // HKDF block counter
+
+        uint8_t block[EVP_MAX_MD_SIZE];
+        unsigned int block_len = 0;
+        if (HMAC(digest, secret.data(), secret.size(), info, n, block, &block_len) == nullptr) return false;
+        std::memcpy(out.data(), block, out.size());
+        OPENSSL_cleanse(block, sizeof(block));
+        return true;
+    }
+}
+
+bool derive_tls13_traffic_keys(const EVP_MD* digest, std::span<const uint8_t> secret,
+                               std::span<uint8_t> key, std::span<uint8_t> iv) {
+    return expand_label(digest, secret, "key", key) && expand_label(digest, secret, "iv", iv);
+}
+
+bool ktls_offloads_rx(const SSL* ssl, bool is_server) {
+    return is_server || SSL_version(ssl) != TLS1_3_VERSION;
+}
+
+bool ktls_reply_dropped(SSL* ssl) {
+    return BIO_ctrl_pending(SSL_get_wbio(ssl)) > 0;
+}
+
+ktls_counters ktls_stats() {
+    ktls_counters c;
+    c.kernel = g_kernel.load(std::memory_order_relaxed);
+    c.unsupported = g_unsupported.load(std::memory_order_relaxed);
+    c.refused = g_refused.load(std::memory_order_relaxed);
+    c.broken = g_broken.load(std::memory_order_relaxed);
+    return c;
+}
+
+}
+
 #if defined(__linux__)
 
 #include <linux/tls.h>
 #include <sys/socket.h>
 #include <netinet/tcp.h>
-#include <cstring>
-#include <vector>
 
 namespace hope::io {
 
-bool try_enable_fd_ktls(SSL* ssl, int fd, bool is_server) {
-    if (!ssl || fd < 0) return false;
+namespace {
+    enum class outcome : uint8_t { kernel, unsupported, refused, broken };
 
-    const SSL_CIPHER* cipher = SSL_get_current_cipher(ssl);
-    if (!cipher) return false;
-
-    size_t key_len = SSL_get_key_block_len(ssl);
-    if (key_len == 0) return false;
-
-    std::vector<uint8_t> key_block(key_len);
-    SSL_generate_key_block(ssl, key_block.data(), key_len);
-
-    // TLS 1.2 key block layout for AES-128-GCM (RFC 5246 §6.3):
-    //   client_write_key (16) | server_write_key (16) |
-    //   client_write_IV  (4)  | server_write_IV  (4)
-    uint8_t* cw_key = key_block.data() + 0;
-    uint8_t* sw_key = key_block.data() + 16;
-    uint8_t* cw_iv  = key_block.data() + 32;
-    uint8_t* sw_iv  = key_block.data() + 36;
-
-    struct tls12_crypto_info_aes_gcm_128 tx_info, rx_info;
-    std::memset(&tx_info, 0, sizeof(tx_info));
-    std::memset(&rx_info, 0, sizeof(rx_info));
-
-    auto make_info = [](struct tls12_crypto_info_aes_gcm_128* info,
-                        const uint8_t* key, const uint8_t* salt)
-    {
-        info->info.version = TLS_1_2_VERSION;
-        info->info.cipher_type = TLS_CIPHER_AES_GCM_128;
-        std::memcpy(info->key, key, 16);
-        std::memcpy(info->salt, salt, 4);
+    struct aead final {
+        uint16_t cipher_type;
+        std::size_t key_len;
+        std::size_t fixed_iv_len;   // TLS 1.2 key block IV: GCM salt or the whole ChaCha20 nonce
     };
 
-    if (is_server) {
-        // Server: TX = server_write, RX = client_write
-        make_info(&tx_info, sw_key, sw_iv);
-        make_info(&rx_info, cw_key, cw_iv);
-    } else {
-        // Client: TX = client_write, RX = server_write
-        make_info(&tx_info, cw_key, cw_iv);
-        make_info(&rx_info, sw_key, sw_iv);
+    bool aead_of(const SSL_CIPHER* cipher, aead& out) {
+        switch (SSL_CIPHER_get_cipher_nid(cipher)) {
+        case NID_aes_128_gcm:
+            out = { TLS_CIPHER_AES_GCM_128, 16, 4 };
+            return true;
+        case NID_aes_256_gcm:
+            out = { TLS_CIPHER_AES_GCM_256, 32, 4 };
+            return true;
+#ifdef TLS_CIPHER_CHACHA20_POLY1305
+        case NID_chacha20_poly1305:
+            out = { TLS_CIPHER_CHACHA20_POLY1305, 32, 12 };
+            return true;
+#endif
+        default:
+            return false;
+        }
     }
 
-    if (setsockopt(fd, SOL_TCP, TCP_ULP, "tls", sizeof("tls")) < 0) {
-        return false;
+    // One direction as setsockopt(SOL_TLS, TLS_TX/TLS_RX) takes it
+    struct crypto_info final {
+        union {
+            tls12_crypto_info_aes_gcm_128 aes128;
+            tls12_crypto_info_aes_gcm_256 aes256;
+#ifdef TLS_CIPHER_CHACHA20_POLY1305
+            tls12_crypto_info_chacha20_poly1305 chacha;
+#endif
+        } u;
+        socklen_t size = 0;
+
+        crypto_info() { std::memset(&u, 0, sizeof(u)); }
+        ~crypto_info() { OPENSSL_cleanse(&u, sizeof(u)); }
+    };
+
+    // nonce is the 12 byte AEAD nonce before the sequence number is mixed in: the GCM salt
+    // is its head and the kernel keeps the rest (TLS 1.2: the explicit part) next to rec_seq
+    template <typename TInfo>
+    socklen_t fill(TInfo& info, uint16_t version, uint16_t cipher_type,
+                   const uint8_t* key, const uint8_t* nonce, uint64_t seq) {
+        info.info.version = version;
+        info.info.cipher_type = cipher_type;
+        std::memcpy(info.key, key, sizeof(info.key));
+        std::memcpy(info.salt, nonce, sizeof(info.salt));
+        std::memcpy(info.iv, nonce + sizeof(info.salt), sizeof(info.iv));
+        for (std::size_t i = 0; i < sizeof(info.rec_seq); ++i) {
+            info.rec_seq[i] = (uint8_t)(seq >> (8 * (sizeof(info.rec_seq) - 1 - i)));
+        }
+        return (socklen_t)sizeof(info);
     }
 
-    if (setsockopt(fd, SOL_TLS, TLS_TX, &tx_info, sizeof(tx_info)) < 0) {
-        return false;
+    void make_info(crypto_info& out, uint16_t version, const aead& a,
+                   const uint8_t* key, const uint8_t* nonce, uint64_t seq) {
+        switch (a.cipher_type) {
+        case TLS_CIPHER_AES_GCM_128:
+            out.size = fill(out.u.aes128, version, a.cipher_type, key, nonce, seq);
+            break;
+        case TLS_CIPHER_AES_GCM_256:
+            out.size = fill(out.u.aes256, version, a.cipher_type, key, nonce, seq);
+            break;
+#ifdef TLS_CIPHER_CHACHA20_POLY1305
+        case TLS_CIPHER_CHACHA20_POLY1305:
+            out.size = fill(out.u.chacha, version, a.cipher_type, key, nonce, seq);
+            break;
+#endif
+        }
+    }
+
+    void put_be64(uint8_t* out, uint64_t v) {
+        for (int i = 7; i >= 0; --i, v >>= 8) out[i] = (uint8_t)v;
+    }
+
+    outcome enable(SSL* ssl, int fd, bool is_server) {
+        const SSL_CIPHER* cipher = SSL_get_current_cipher(ssl);
+        aead a{};
+        if (!cipher || !aead_of(cipher, a)) return outcome::unsupported;
+
+        // Records SSL already pulled off the socket would never reach the kernel
+        const bool offload_rx = ktls_offloads_rx(ssl, is_server);
+        if (offload_rx && SSL_has_pending(ssl)) return outcome::unsupported;
+
+        // Whatever the handshake sent or received under these keys already counts:
+        // TLS 1.2 Finished, TLS 1.3 session tickets written by the server
+        const uint64_t tx_seq = SSL_get_write_sequence(ssl);
+        const uint64_t rx_seq = SSL_get_read_sequence(ssl);
+
+        crypto_info tx, rx;
+        const auto version = SSL_version(ssl);
+        if (version == TLS1_3_VERSION) {
+            bssl::Span<const uint8_t> read_secret, write_secret;
+            if (!bssl::SSL_get_traffic_secrets(ssl, &read_secret, &write_secret)) return outcome::unsupported;
+            const EVP_MD* digest = SSL_CIPHER_get_handshake_digest(cipher);
+            uint8_t key[32], nonce[12];
+            const std::span<uint8_t> key_span(key, a.key_len);
+            if (!derive_tls13_traffic_keys(digest, { write_secret.data(), write_secret.size() }, key_span, nonce)) {
+                return outcome::unsupported;
+            }
+            make_info(tx, TLS_1_3_VERSION, a, key, nonce, tx_seq);
+            if (!derive_tls13_traffic_keys(digest, { read_secret.data(), read_secret.size() }, key_span, nonce)) {
+                return outcome::unsupported;
+            }
+            make_info(rx, TLS_1_3_VERSION, a, key, nonce, rx_seq);
+            OPENSSL_cleanse(key, sizeof(key));
+            OPENSSL_cleanse(nonce, sizeof(nonce));
+        } else if (version == TLS1_2_VERSION) {
+            // AEAD key block (RFC 5246 6.3, RFC 5288, RFC 7905), no MAC keys:
+            //   client_write_key | server_write_key | client_write_IV | server_write_IV
+            const std::size_t key_len = SSL_get_key_block_len(ssl);
+            if (key_len != 2 * (a.key_len + a.fixed_iv_len)) return outcome::unsupported;
+            uint8_t key_block[2 * (32 + 12)];
+            if (!SSL_generate_key_block(ssl, key_block, key_len)) return outcome::unsupported;
+            const uint8_t* cw_key = key_block;
+            const uint8_t* sw_key = key_block + a.key_len;
+            const uint8_t* cw_iv = key_block + 2 * a.key_len;
+            const uint8_t* sw_iv = cw_iv + a.fixed_iv_len;
+
+            // GCM nonce: 4 byte salt | 8 byte explicit nonce, which BoringSSL sets to the
+            // sequence number. ChaCha20 takes the 12 byte IV, the kernel XORs the sequence in.
+            auto nonce_of = [&](const uint8_t* iv, uint64_t seq, uint8_t* nonce) {
+                std::memcpy(nonce, iv, a.fixed_iv_len);
+                if (a.fixed_iv_len == 4) put_be64(nonce + 4, seq);
+            };
+            uint8_t tx_nonce[12], rx_nonce[12];
+            nonce_of(is_server ? sw_iv : cw_iv, tx_seq, tx_nonce);
+            nonce_of(is_server ? cw_iv : sw_iv, rx_seq, rx_nonce);
+            make_info(tx, TLS_1_2_VERSION, a, is_server ? sw_key : cw_key, tx_nonce, tx_seq);
+            make_info(rx, TLS_1_2_VERSION, a, is_server ? cw_key : sw_key, rx_nonce, rx_seq);
+            OPENSSL_cleanse(key_block, sizeof(key_block));
+        } else {
+            return outcome::unsupported;
+        }
+
+        if (setsockopt(fd, SOL_TCP, TCP_ULP, "tls", sizeof("tls")) < 0) {
+            return outcome::refused;
+        }
+        if (!offload_rx) {
+            if (setsockopt(fd, SOL_TLS, TLS_TX, &tx.u, tx.size) < 0) {
+                return outcome::refused;
+            }
+            // SSL still reads and may answer (a requested KeyUpdate, close_notify) under keys
+            // the socket no longer uses: those writes land here, ktls_reply_dropped sees them
+            SSL_set0_wbio(ssl, BIO_new(BIO_s_mem()));
+            return outcome::kernel;
+        }
+        // RX first: kernels with TX-only offload refuse it before any key is installed,
+        // and once both are in SSL_read/SSL_write must not touch the socket again
+        if (setsockopt(fd, SOL_TLS, TLS_RX, &rx.u, rx.size) < 0) {
+            return outcome::refused;
+        }
+        if (setsockopt(fd, SOL_TLS, TLS_TX, &tx.u, tx.size) < 0) {
+            // The kernel already decrypts what arrives, SSL would be fed plaintext and no
+            // key can be taken back out of the socket
+            return outcome::broken;
+        }
+        return outcome::kernel;
     }
+}
 
-    if (setsockopt(fd, SOL_TLS, TLS_RX, &rx_info, sizeof(rx_info)) < 0) {
+bool try_enable_fd_ktls(SSL* ssl, int fd, bool is_server) {
+    if (!ssl || fd < 0) return false;
+
+    switch (enable(ssl, fd, is_server)) {
+    case outcome::kernel:
+        g_kernel.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    case outcome::unsupported:
+        g_unsupported.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    case outcome::refused:
+        g_refused.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    case outcome::broken:
+        g_broken.fetch_add(1, std::memory_order_relaxed);
+        // Neither record layer can carry the connection: the caller's next read sees EOF,
+        // its next write fails, and it closes the connection like any dropped peer
+        ::shutdown(fd, SHUT_RDWR);
         return false;
     }
+    return false;
+}
 
-    return true;
+int64_t ktls_recv(int fd, void* data, std::size_t length, int flags) {
+    char control[CMSG_SPACE(sizeof(unsigned char))];
+    iovec iov{ data, length };
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    const auto received = ::recvmsg(fd, &msg, flags);
+    if (received <= 0) return received;
+
+    const auto* cmsg = CMSG_FIRSTHDR(&msg);
+    if (cmsg == nullptr || cmsg->cmsg_level != SOL_TLS || cmsg->cmsg_type != TLS_GET_RECORD_TYPE) {
+        return received;
+    }
+    switch (*CMSG_DATA(cmsg)) {
+    case 23:    // application_data
+        return received;
+    case 21:    // alert: close_notify or fatal, nothing follows either way
+        return 0;
+    default:    // handshake: tickets only go to clients, which keep RX in SSL, so a KeyUpdate
+        errno = EPROTO;
+        return -1;
+    }
 }
 
 }
@@ -85,5 +308,9 @@ bool try_enable_fd_ktls(SSL* /*ssl*/, int /*fd*/, bool /*is_server*/) {
     return false;
 }
 
+int64_t ktls_recv(int /*fd*/, void* /*data*/, std::size_t /*length*/, int /*flags*/) {
+    return -1;
+}
+
 }
 #endif
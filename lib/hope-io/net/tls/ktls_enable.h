@@ -10,6 +10,10 @@
 
 #include "openssl/ssl.h"
 
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
 namespace hope::io {
 
 /// Try to enable kernel TLS (KTLS) on a connected fd after a successful TLS handshake.
@@ -18,8 +22,46 @@ namespace hope::io {
 /// @param is_server  true if called on the server side (affects TX/RX key ordering).
 /// Returns true if KTLS was enabled successfully, false on unsupported kernels/ciphers.
 /// Only meaningful on Linux with TCP_ULP support.
+/// TLS 1.2 and TLS 1.3 with AES-128-GCM, AES-256-GCM and ChaCha20-Poly1305 are offloaded,
+/// the record sequence numbers continue where the handshake left them.
+/// RX is installed before TX. If the kernel then refuses TX the socket is half offloaded and
+/// SSL cannot take over again: it is shut down and false is returned, the connection ends.
+/// A TLS 1.3 client gets TX only (see ktls_offloads_rx): SSL_read goes on reading the
+/// socket, and SSL's own writes go to a memory BIO instead of behind the kernel's back.
 bool try_enable_fd_ktls(SSL* ssl, int fd, bool is_server);
 
+/// Whether try_enable_fd_ktls hands RX to the kernel as well. Not on a TLS 1.3 client: the
+/// NewSessionTicket comes after the handshake and only SSL can turn it into a session to
+/// resume, so a client reads through SSL_read and only writes through the socket.
+bool ktls_offloads_rx(const SSL* ssl, bool is_server);
+
+/// recv() on a KTLS socket with RX offloaded. An alert ends the stream like EOF. A handshake
+/// record after the handshake can only be a KeyUpdate, the kernel keeps the old key and
+/// could not decrypt anything after it: the read fails with EPROTO.
+/// Returns what recv() would.
+int64_t ktls_recv(int fd, void* data, std::size_t length, int flags);
+
+/// A TX only KTLS socket read through SSL: true if SSL wanted to write something in
+/// response (a KeyUpdate the peer requested), which cannot reach the peer under the
+/// kernel's key. The connection cannot go on then.
+bool ktls_reply_dropped(SSL* ssl);
+
+/// Outcomes of try_enable_fd_ktls in this process, so a caller (or a benchmark)
+/// can tell which record layer actually carried its connections.
+struct ktls_counters final {
+    uint64_t kernel = 0;        // offloaded
+    uint64_t unsupported = 0;   // protocol or cipher the kernel cannot take, or unread records in SSL
+    uint64_t refused = 0;       // the kernel refused: no tls ULP, cipher not built in
+    uint64_t broken = 0;        // RX installed but TX refused, the connection was shut down
+};
+
+ktls_counters ktls_stats();
+
+/// TLS 1.3 record key and IV from a traffic secret (RFC 8446 7.3), key.size() and iv.size()
+/// as the AEAD needs them. Returns false if the digest cannot expand that much.
+bool derive_tls13_traffic_keys(const EVP_MD* digest, std::span<const uint8_t> secret,
+                               std::span<uint8_t> key, std::span<uint8_t> iv);
+
 /// Returns true if the platform supports KTLS at compile time.
 constexpr bool is_ktls_supported() {
 #if defined(__linux__)
@@ -12,9 +12,13 @@
 
 #if PLATFORM_LINUX || PLATFORM_APPLE
 #include "hope-io/net/nix/tcp_stream.h"
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/select.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
 #include <sys/uio.h>
+#include <unistd.h>
 #elif PLATFORM_WINDOWS
 #include "hope-io/net/win/tcp_stream.h"
 #include <winsock2.h>
@@ -118,19 +122,66 @@ namespace hope::io {
         }
     }
 
-    size_t base_tls_stream::read(void *data, std::size_t length) {
+    void base_tls_stream::write_file(const std::string& path, uint64_t offset, uint64_t length) {
 #if PLATFORM_LINUX
         if (m_ktls_enabled) {
+            // The kernel encrypts, sendfile works exactly as on plain TCP
+            m_tcp_stream->write_file(path, offset, length);
+            return;
+        }
+#endif
+#if PLATFORM_LINUX || PLATFORM_APPLE
+        struct file final {
+            int fd;
+            ~file() { if (fd != -1) close(fd); }
+        } in{ open(path.c_str(), O_RDONLY | O_CLOEXEC) };
+        if (in.fd == -1) HOPE_THROW_ERRNO("tls_stream", "cannot open " + path);
+        struct stat st{};
+        if (fstat(in.fd, &st) == -1) HOPE_THROW_ERRNO("tls_stream", "cannot stat " + path);
+        // Touching a mapping past the end of the file is SIGBUS, not an error code
+        if (offset > (uint64_t)st.st_size || length > (uint64_t)st.st_size - offset) {
+            HOPE_THROW("tls_stream", "file is shorter than requested: " + path);
+        }
+
+        // SSL_write encrypts straight from the page cache, there is no read() copy. The file is
+        // mapped a window at a time so a multi-GB upload does not need the address space at once.
+        constexpr uint64_t window = 16 * 1024 * 1024;
+        const auto page = (uint64_t)sysconf(_SC_PAGESIZE);
+        while (length > 0) {
+            const auto aligned = offset - offset % page;
+            const auto skip = (std::size_t)(offset - aligned);
+            const auto chunk = (std::size_t)std::min(length, window);
+            auto* map = mmap(nullptr, skip + chunk, PROT_READ, MAP_PRIVATE, in.fd, (off_t)aligned);
+            if (map == MAP_FAILED) HOPE_THROW_ERRNO("tls_stream", "cannot mmap " + path);
+            madvise(map, skip + chunk, MADV_SEQUENTIAL);
+            try {
+                write((const char*)map + skip, chunk);
+            } catch (...) {
+                munmap(map, skip + chunk);
+                throw;
+            }
+            munmap(map, skip + chunk);
+            offset += chunk;
+            length -= chunk;
+        }
+#else
+        stream::write_file(path, offset, length);
+#endif
+    }
+
+    size_t base_tls_stream::read(void *data, std::size_t length) {
+#if PLATFORM_LINUX
+        if (m_ktls_rx) {
             std::size_t total = 0;
             while (total < length) {
-                auto received = ::recv(m_tcp_stream->platform_socket(),
+                auto received = ktls_recv(m_tcp_stream->platform_socket(),
                                        (char*)data + total, length - total, 0);
                 if (received > 0) {
                     total += received;
                 } else if (received == 0) {
                     HOPE_THROW("tls_stream", "KTLS read: connection closed by peer");
                 } else {
-                    HOPE_THROW("tls_stream", "KTLS read failed");
+                    HOPE_THROW_ERRNO("tls_stream", "KTLS read failed");
                 }
             }
             return total;
@@ -139,6 +190,7 @@ namespace hope::io {
         std::size_t total = 0;
         while (total < length) {
             const auto received = SSL_read(m_ssl, (char*)data + total, (int)(length - total));
+            check_ktls_reply();
             if (received > 0) {
                 total += received;
             } else if (received == 0) {
@@ -152,13 +204,14 @@ namespace hope::io {
 
     size_t base_tls_stream::read_once(void* data, std::size_t length) {
 #if PLATFORM_LINUX
-        if (m_ktls_enabled) {
-            auto received = ::recv(m_tcp_stream->platform_socket(), (char*)data, length, 0);
+        if (m_ktls_rx) {
+            auto received = ktls_recv(m_tcp_stream->platform_socket(), (char*)data, length, 0);
             if (received < 0) return 0;
             return (std::size_t)received;
         }
 #endif
         const auto received = SSL_read(m_ssl, (char*)data, (int)length);
+        check_ktls_reply();
         if (received > 0) return received;
         if (received == 0) return 0;
         auto err = SSL_get_error(m_ssl, received);
@@ -169,11 +222,11 @@ namespace hope::io {
 
     void base_tls_stream::stream_in(std::string& out_stream) {
 #if PLATFORM_LINUX
-        if (m_ktls_enabled) {
+        if (m_ktls_rx) {
             constexpr static std::size_t BufferSize{ 1024 };
             char buffer[BufferSize];
             while (true) {
-                auto bytes_read = ::recv(m_tcp_stream->platform_socket(), buffer, BufferSize, 0);
+                auto bytes_read = ktls_recv(m_tcp_stream->platform_socket(), buffer, BufferSize, 0);
                 if (bytes_read > 0) {
                     out_stream.append(buffer, bytes_read);
                 } else if (bytes_read == 0) {
@@ -189,6 +242,7 @@ namespace hope::io {
         char buffer[BufferSize];
         while (true) {
             auto bytes_read = SSL_read(m_ssl, buffer, BufferSize);
+            check_ktls_reply();
             if (bytes_read > 0) {
                 out_stream.append(buffer, bytes_read);
             } else if (bytes_read == 0) {
@@ -214,17 +268,26 @@ namespace hope::io {
         m_tcp_stream->set_options(opt);
     }
 
-    void base_tls_stream::try_enable_ktls() {
+    void base_tls_stream::try_enable_ktls(bool is_server) {
 #if PLATFORM_LINUX
         if (!m_ktls_enabled || !m_ssl) return;
         int fd = m_tcp_stream->platform_socket();
         if (fd < 0) return;
-        m_ktls_enabled = try_enable_fd_ktls(m_ssl, fd, false);
+        m_ktls_enabled = try_enable_fd_ktls(m_ssl, fd, is_server);
+        m_ktls_rx = m_ktls_enabled && ktls_offloads_rx(m_ssl, is_server);
 #else
         m_ktls_enabled = false;
 #endif
     }
 
+    void base_tls_stream::check_ktls_reply() {
+        // TX only: SSL answered something (a requested KeyUpdate) with keys the kernel
+        // does not send under, the peer would wait for it forever
+        if (m_ktls_enabled && !m_ktls_rx && ktls_reply_dropped(m_ssl)) {
+            HOPE_THROW("tls_stream", "kTLS: KeyUpdate not supported");
+        }
+    }
+
     bool base_tls_stream::wait_for_ssl(int ssl_error, int timeout_ms) {
         auto fd = m_tcp_stream->platform_socket();
         fd_set fds;
@@ -260,6 +323,16 @@ namespace hope::io {
 
 namespace hope::io {
 
+    // New session from the handshake (TLS 1.2) or a post-handshake ticket (TLS 1.3, may come
+    // with any SSL_read); goes to the stream's cache under its host:port
+    int on_new_client_session(SSL* ssl, SSL_SESSION* session) {
+        auto* stream = static_cast<tcp_tls_stream*>(SSL_get_app_data(ssl));
+        if (stream != nullptr && stream->m_cache != nullptr) {
+            stream->m_cache->put(stream->m_endpoint, session);
+        }
+        return 0; // the cache took its own reference
+    }
+
     // Shared SSL_CTX for all client connections.
     ssl_ctx_st* init_client_tls_context() {
         static ssl_ctx_st* ctx = [] {
@@ -270,6 +343,7 @@ namespace hope::io {
                 SSL_CTX_set_session_cache_mode(c,
                     SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL);
                 SSL_CTX_sess_set_cache_size(c, 128);
+                SSL_CTX_sess_set_new_cb(c, on_new_client_session);
 
                 // Optimise for speed: prefer ECDHE over DHE, prefer X25519
                 // TLS 1.3 ciphers are always enabled in BoringSSL.
@@ -285,7 +359,7 @@ namespace hope::io {
         return ctx;
     }
 
-    void tcp_tls_stream::connect(std::string_view ip, std::size_t port) {
+    void tcp_tls_stream::start_handshake(std::string_view ip, std::size_t port, bool early_data) {
         m_tcp_stream->connect(ip, port);
 
         m_context = init_client_tls_context();
@@ -295,16 +369,77 @@ namespace hope::io {
 
         m_ssl = SSL_new(m_context);
         SSL_set_fd(m_ssl, (int32_t)m_tcp_stream->platform_socket());
-
-        SSL_set_tlsext_host_name(m_ssl, ip.data());
+        SSL_set_app_data(m_ssl, this);
+
+        const std::string host(ip);
+        SSL_set_tlsext_host_name(m_ssl, host.c_str());
+        m_endpoint = tls_session_cache::endpoint(ip, port);
+        if (m_resume != nullptr) {
+            SSL_set_session(m_ssl, m_resume);
+        } else if (m_cache != nullptr) {
+            if (auto* cached = m_cache->take(m_endpoint)) {
+                SSL_set_session(m_ssl, cached);
+                SSL_SESSION_free(cached);
+            }
+        }
+        if (early_data) {
+            SSL_set_early_data_enabled(m_ssl, 1);
+        }
 
         if (SSL_connect(m_ssl) <= 0) {
             throw std::runtime_error("hope-io/tcp_tls_stream: cannot establish connection");
         }
+    }
+
+    void tcp_tls_stream::connect(std::string_view ip, std::size_t port) {
+        start_handshake(ip, port, false);
 
         // Attempt KTLS after successful handshake
         if (m_ktls_enabled) {
-            try_enable_ktls();
+            try_enable_ktls(false);
+        }
+    }
+
+    bool tcp_tls_stream::connect_early(std::string_view ip, std::size_t port, std::span<const char> early) {
+        start_handshake(ip, port, !early.empty());
+
+        // With a 0-RTT capable session SSL_connect returns before the server's Finished,
+        // writes then go out as early data
+        bool accepted = false;
+        if (SSL_in_early_data(m_ssl)) {
+            std::size_t sent = 0;
+            int rc = 1;
+            while (sent < early.size() && (rc = SSL_write(m_ssl, early.data() + sent, (int)(early.size() - sent))) > 0) {
+                sent += (std::size_t)rc;
+            }
+            if (rc > 0) {
+                rc = SSL_do_handshake(m_ssl);
+            }
+            if (rc <= 0) {
+                if (SSL_get_error(m_ssl, rc) != SSL_ERROR_EARLY_DATA_REJECTED) {
+                    throw std::runtime_error("hope-io/tcp_tls_stream: cannot establish connection");
+                }
+                // Nothing of it reached the application, finish a full handshake and resend
+                SSL_reset_early_data_reject(m_ssl);
+                if (SSL_do_handshake(m_ssl) <= 0) {
+                    throw std::runtime_error("hope-io/tcp_tls_stream: cannot establish connection");
+                }
+            }
+            accepted = SSL_early_data_accepted(m_ssl);
+        }
+
+        if (m_ktls_enabled) {
+            try_enable_ktls(false);
+        }
+        if (!accepted && !early.empty()) {
+            write(early.data(), early.size());
+        }
+        return accepted;
+    }
+
+    tcp_tls_stream::~tcp_tls_stream() {
+        if (m_resume != nullptr) {
+            SSL_SESSION_free(m_resume);
         }
     }
 
@@ -313,4 +448,22 @@ namespace hope::io {
         m_context = nullptr;
     }
 
+    void tcp_tls_stream::set_session(SSL_SESSION* session) {
+        if (session != nullptr) {
+            SSL_SESSION_up_ref(session);
+        }
+        if (m_resume != nullptr) {
+            SSL_SESSION_free(m_resume);
+        }
+        m_resume = session;
+    }
+
+    SSL_SESSION* tcp_tls_stream::get_session() const {
+        return m_ssl != nullptr ? SSL_get1_session(m_ssl) : nullptr;
+    }
+
+    bool tcp_tls_stream::session_reused() const {
+        return m_ssl != nullptr && SSL_session_reused(m_ssl);
+    }
+
 }
@@ -9,15 +9,49 @@
 #pragma once
 
 #include "hope-io/net/tls/tls_stream.h"
+#include "hope-io/net/tls/tls_session_cache.h"
+
+#include <span>
+#include <string>
 
 namespace hope::io {
 
     class tcp_tls_stream final : public base_tls_stream {
     public:
         using base_tls_stream::base_tls_stream;
+        ~tcp_tls_stream() override;
 
+        // Resumes with a session of tls_session_cache for ip:port when there is one
         void connect(std::string_view ip, std::size_t port) override;
         void disconnect() override;
+
+        // connect() plus early as TLS 1.3 early data (0-RTT) when the cached session allows it,
+        // which saves a round trip. Early data can be replayed by an attacker, send only
+        // requests that are safe to repeat. Returns true if the server took it as 0-RTT;
+        // otherwise early went out normally after the full handshake.
+        bool connect_early(std::string_view ip, std::size_t port, std::span<const char> early);
+
+        // Sessions are looked up and stored here; nullptr turns caching off for this stream
+        void set_session_cache(tls_session_cache* cache) { m_cache = cache; }
+
+        // Offered on every following connect() instead of a cached one; a server that still
+        // knows it skips the full handshake. The stream takes its own reference, nullptr
+        // stops offering one.
+        void set_session(SSL_SESSION* session);
+
+        // Session of the live connection with a new reference (SSL_SESSION_free), or nullptr.
+        // With TLS 1.3 the ticket arrives after the handshake, ask once a response was read.
+        [[nodiscard]] SSL_SESSION* get_session() const;
+        [[nodiscard]] bool session_reused() const;
+
+    private:
+        friend int on_new_client_session(SSL* ssl, SSL_SESSION* session);
+
+        void start_handshake(std::string_view ip, std::size_t port, bool early_data);
+
+        SSL_SESSION* m_resume{ nullptr };
+        tls_session_cache* m_cache{ &tls_session_cache::shared() };
+        std::string m_endpoint;     // host:port key of m_cache
     };
 
 }
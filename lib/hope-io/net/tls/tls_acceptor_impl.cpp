@@ -50,7 +50,7 @@ namespace hope::io {
 
         // Attempt KTLS after successful handshake
         if (m_ktls_enabled) {
-            try_enable_ktls();
+            try_enable_ktls(true);
         }
     }
 
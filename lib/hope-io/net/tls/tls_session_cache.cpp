@@ -0,0 +1,116 @@
+/* Copyright (C) 2026 Gleb Bezborodov - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: bezborodoff.gleb@gmail.com, or visit : https://github.com/glensand/hope-io
+ */
+
+#include "hope-io/net/tls/tls_session_cache.h"
+
+#include <cstdint>
+#include <ctime>
+
+namespace hope::io {
+
+    namespace {
+        bool expired(const SSL_SESSION* s, uint64_t now) {
+            return (uint64_t)SSL_SESSION_get_time(s) + (uint64_t)SSL_SESSION_get_timeout(s) <= now;
+        }
+    }
+
+    tls_session_cache::tls_session_cache(std::size_t max_per_endpoint, std::size_t max_endpoints)
+        : m_max_per_endpoint(max_per_endpoint == 0 ? 1 : max_per_endpoint)
+        , m_max_endpoints(max_endpoints == 0 ? 1 : max_endpoints) {
+    }
+
+    tls_session_cache::~tls_session_cache() {
+        clear();
+    }
+
+    tls_session_cache& tls_session_cache::shared() {
+        static tls_session_cache instance;
+        return instance;
+    }
+
+    std::string tls_session_cache::endpoint(std::string_view host, std::size_t port) {
+        std::string key(host);
+        key += ':';
+        key += std::to_string(port);
+        return key;
+    }
+
+    SSL_SESSION* tls_session_cache::take(const std::string& endpoint) {
+        std::lock_guard lock(m_lock);
+        auto it = m_sessions.find(endpoint);
+        if (it == m_sessions.end()) return nullptr;
+        auto& list = it->second;
+        const auto now = (uint64_t)std::time(nullptr);
+        while (!list.empty()) {
+            auto* s = list.back();
+            if (expired(s, now)) {
+                list.pop_back();
+                SSL_SESSION_free(s);
+                continue;
+            }
+            if (SSL_SESSION_get_protocol_version(s) >= TLS1_3_VERSION) {
+                list.pop_back(); // single use, the caller gets our reference
+            } else {
+                SSL_SESSION_up_ref(s);
+            }
+            if (list.empty()) m_sessions.erase(it);
+            return s;
+        }
+        m_sessions.erase(it);
+        return nullptr;
+    }
+
+    void tls_session_cache::put(const std::string& endpoint, SSL_SESSION* session) {
+        if (session == nullptr || !SSL_SESSION_is_resumable(session)) return;
+        SSL_SESSION_up_ref(session);
+        std::deque<SSL_SESSION*> evicted;
+        {
+            std::lock_guard lock(m_lock);
+            auto it = m_sessions.find(endpoint);
+            if (it == m_sessions.end()) {
+                if (m_sessions.size() >= m_max_endpoints) {
+                    evicted = std::move(m_sessions.begin()->second);
+                    m_sessions.erase(m_sessions.begin());
+                }
+                it = m_sessions.emplace(endpoint, std::deque<SSL_SESSION*>{}).first;
+            }
+            auto& list = it->second;
+            list.push_back(session);
+            while (list.size() > m_max_per_endpoint) {
+                evicted.push_back(list.front());
+                list.pop_front();
+            }
+        }
+        for (auto* s : evicted) {
+            SSL_SESSION_free(s);
+        }
+    }
+
+    void tls_session_cache::clear() {
+        std::unordered_map<std::string, std::deque<SSL_SESSION*>> dropped;
+        {
+            std::lock_guard lock(m_lock);
+            dropped.swap(m_sessions);
+        }
+        for (auto& [_, list] : dropped) {
+            for (auto* s : list) {
+                SSL_SESSION_free(s);
+            }
+        }
+    }
+
+    std::size_t tls_session_cache::size() const {
+        std::lock_guard lock(m_lock);
+        std::size_t n = 0;
+        for (auto& [_, list] : m_sessions) {
+            n += list.size();
+        }
+        return n;
+    }
+
+}
@@ -0,0 +1,54 @@
+/* Copyright (C) 2026 Gleb Bezborodov - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: bezborodoff.gleb@gmail.com, or visit : https://github.com/glensand/hope-io
+ */
+
+#pragma once
+
+#include "openssl/ssl.h"
+
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace hope::io {
+
+    // Client sessions (TLS 1.2 session ids/tickets, TLS 1.3 PSK tickets) per host:port,
+    // filled by the new-session callback of tcp_tls_stream and consulted by its connect().
+    // TLS 1.3 tickets are handed out once (RFC 8446 C.4), TLS 1.2 sessions until they expire.
+    class tls_session_cache final {
+    public:
+        explicit tls_session_cache(std::size_t max_per_endpoint = 4, std::size_t max_endpoints = 1024);
+        ~tls_session_cache();
+
+        tls_session_cache(const tls_session_cache&) = delete;
+        tls_session_cache& operator=(const tls_session_cache&) = delete;
+
+        // Newest usable session with a new reference (SSL_SESSION_free), nullptr if none
+        [[nodiscard]] SSL_SESSION* take(const std::string& endpoint);
+
+        // Takes its own reference, the caller keeps theirs
+        void put(const std::string& endpoint, SSL_SESSION* session);
+
+        void clear();
+        [[nodiscard]] std::size_t size() const;
+
+        static std::string endpoint(std::string_view host, std::size_t port);
+
+        // Default cache of every tcp_tls_stream
+        static tls_session_cache& shared();
+
+    private:
+        std::unordered_map<std::string, std::deque<SSL_SESSION*>> m_sessions; // newest at the back
+        std::size_t m_max_per_endpoint;
+        std::size_t m_max_endpoints;
+        mutable std::mutex m_lock;
+    };
+
+}
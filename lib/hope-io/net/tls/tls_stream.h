@@ -32,6 +32,8 @@ namespace hope::io {
 
         void write(const void *data, std::size_t length) override;
         void write_v(std::span<const std::span<const char>> buffers) override;
+        // kTLS: sendfile, the kernel encrypts. Otherwise the file is mmap'ed into SSL_write.
+        void write_file(const std::string& path, uint64_t offset, uint64_t length) override;
         size_t read(void *data, std::size_t length) override;
         size_t read_once(void* data, std::size_t length) override;
         void stream_in(std::string& buffer) override;
@@ -44,17 +46,19 @@ namespace hope::io {
 
         void set_ktls_enabled(bool enabled) { m_ktls_enabled = enabled; }
         bool is_ktls_enabled() const { return m_ktls_enabled; }
-        void try_enable_ktls();
+        void try_enable_ktls(bool is_server);
 
     protected:
         bool wait_for_ssl(int ssl_error, int timeout_ms);
         void handle_ssl_error(const char* op, int result);
+        void check_ktls_reply();
 
         tcp_stream* m_tcp_stream{ nullptr };
         ssl_st* m_ssl{ nullptr };
         ssl_ctx_st* m_context{ nullptr };
         stream_options m_options{};
         bool m_ktls_enabled = false;
+        bool m_ktls_rx = false;     // the kernel decrypts too, otherwise SSL_read still does
     };
 
 }
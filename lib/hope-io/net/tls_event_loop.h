@@ -20,10 +20,16 @@ namespace hope::io::el {
         std::size_t port = 443;
         std::size_t max_mutual_connections = 1024;
         std::size_t max_accepts_per_tick = 128;
-        int epoll_timeout = 1000;            // ms
+        int epoll_timeout = 1000;            // ms, upper bound for one wait, timers shorten it
+        int handshake_timeout_ms = 10000;    // Linux (epoll, io_uring): drop clients that do not finish the handshake in time, 0 = never
+        int idle_timeout_ms = 0;             // Linux (epoll, io_uring): close connections without traffic for this long, 0 = never
         bool verify_peer = false;            // optional mTLS
         bool enable_ktls = false;            // attempt KTLS on each accepted connection
+        std::size_t handshake_workers = 0;   // Linux: threads signing handshakes off the loop thread, 0 = sign inline
+        uring_setup uring_ring;              // io_uring loop only: ring setup profile
         stream_options accepted_stream_options;  // socket options applied to each accepted connection
+        std::string bind_address;            // numeric IPv4/IPv6 to listen on, empty = all interfaces, both stacks
+        bool ipv6_only = false;              // IPV6_V6ONLY on an IPv6 listener
     };
 
     template<typename TOnRead, typename TOnWrite, typename TOnError, typename TConnected>
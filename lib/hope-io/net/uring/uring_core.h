@@ -9,11 +9,15 @@
 #pragma once
 
 #include "hope-io/coredefs.h"
+#include "hope-io/net/event_loop.h"
 
 #if PLATFORM_LINUX
 
 #include <cstdint>
 #include <cstddef>
+#include <memory>
+#include <vector>
+#include <algorithm>
 #include <liburing.h>
 
 namespace hope::io::uring {
@@ -23,27 +27,38 @@ namespace hope::io::uring {
 
     // ── Tag encoding ───────────────────────────────────────────────────
     // user_data is uint64_t. Layout of bits:
-    //   TCP:   bits [63:1] = fd, bit [0] = 0→recv, 1→send
-    //   TLS:   bits [63:2] = fd, bits [1:0] = operation type
+    //   data:  bits [63:2] = fd (or registered file slot), bits [1:0] = operation type
     //
     // Operation type (2 low bits):
     //   0 = RECV (KTLS recv or TCP recv)
     //   1 = SEND (KTLS send or TCP send)
     //   2 = POLL_IN
     //   3 = POLL_OUT
-    //   listen_fd << 1 | 0  = ACCEPT (special, never collides because listen_fd is never a data fd)
+    //   bit 63 | listen_fd  = ACCEPT, bit 63 | 62 | eventfd = WAKEUP: control tags sit above
+    //                         any fd << 2, data fds may be registered file slots starting at 0
+    //   bit 63 | 61 | generation << 32 | index = CONNECT: outbound attempt in the loop's table
+    //   ~0                  = IGNORE (cancel requests and other fire-and-forget SQEs)
 
-    constexpr uint64_t tag_accept(int lfd)  { return uint64_t(lfd) << 1; }
+    constexpr uint64_t tag_control          = uint64_t(1) << 63;
+    constexpr uint64_t tag_accept(int lfd)  { return tag_control | uint32_t(lfd); }
     constexpr uint64_t tag_recv(int fd)     { return (uint64_t(fd) << 2) | 0; }
     constexpr uint64_t tag_send(int fd)     { return (uint64_t(fd) << 2) | 1; }
     constexpr uint64_t tag_poll_in(int fd)  { return (uint64_t(fd) << 2) | 2; }
     constexpr uint64_t tag_poll_out(int fd) { return (uint64_t(fd) << 2) | 3; }
+    constexpr uint64_t tag_wakeup(int efd)  { return tag_control | (uint64_t(1) << 62) | uint32_t(efd); } // eventfd read
+    constexpr uint64_t tag_connect(uint32_t index, uint16_t generation) {
+        return tag_control | (uint64_t(1) << 61) | (uint64_t(generation) << 32) | index;
+    }
+    constexpr uint64_t tag_ignore           = ~uint64_t(0);
 
     constexpr int  fd_of(uint64_t t)        { return int(t >> 2); }
     constexpr bool is_recv(uint64_t t)      { return (t & 3) == 0; }
     constexpr bool is_send(uint64_t t)      { return (t & 3) == 1; }
     constexpr bool is_poll_in(uint64_t t)   { return (t & 3) == 2; }
     constexpr bool is_poll_out(uint64_t t)  { return (t & 3) == 3; }
+    constexpr bool is_connect(uint64_t t)   { return (t >> 61) == 5; }
+    constexpr uint32_t connect_index(uint64_t t)      { return uint32_t(t); }
+    constexpr uint16_t connect_generation(uint64_t t) { return uint16_t(t >> 32); }
 
     // ── Ring wrapper ───────────────────────────────────────────────────
     struct ring final {
@@ -52,19 +67,62 @@ namespace hope::io::uring {
         void init(int entries = RING_ENTRIES, unsigned flags = 0) {
                 int ret = io_uring_queue_init(entries, &impl, flags);
                 if (ret < 0) {
+                    errno = -ret;
                     HOPE_THROW_ERRNO("uring", "io_uring_queue_init failed");
                 }
             }
 
+        // Creates the ring for a setup profile. A kernel that refuses the profile (too old,
+        // SQPOLL without privilege) gets a plain ring rather than failing the loop.
+        void init(const el::uring_setup& setup, int entries = RING_ENTRIES) {
+            struct io_uring_params params{};
+            switch (setup.profile) {
+                case el::uring_profile::standard:
+                    break;
+                case el::uring_profile::sqpoll:
+                    params.flags = IORING_SETUP_SQPOLL;
+                    params.sq_thread_idle = setup.sqpoll_idle_ms;
+                    if (setup.sqpoll_cpu >= 0) {
+                        params.flags |= IORING_SETUP_SQ_AFF;
+                        params.sq_thread_cpu = (unsigned)setup.sqpoll_cpu;
+                    }
+                    break;
+                case el::uring_profile::single_issuer:
+                    // Only the loop thread may submit; it creates the ring inside run()
+                    params.flags = IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN;
+                    break;
+                case el::uring_profile::coop_taskrun:
+                    params.flags = IORING_SETUP_COOP_TASKRUN | IORING_SETUP_TASKRUN_FLAG;
+                    break;
+            }
+            int ret = io_uring_queue_init_params(entries, &impl, &params);
+            if (ret < 0 && params.flags != 0 && (ret == -EINVAL || ret == -EPERM)) {
+                params = {};
+                ret = io_uring_queue_init_params(entries, &impl, &params);
+            }
+            if (ret < 0) {
+                errno = -ret;
+                HOPE_THROW_ERRNO("uring", "io_uring_queue_init_params failed");
+            }
+        }
+
+        // Setup flags the ring actually runs with
+        unsigned setup_flags() const noexcept { return impl.flags; }
+        bool sqpoll() const noexcept { return (impl.flags & IORING_SETUP_SQPOLL) != 0; }
+
         void exit() {
             io_uring_queue_exit(&impl);
         }
 
+        // SQ full: hands the queued SQEs to the kernel and retries once. nullptr after that
+        // means the kernel is not taking submissions (CQ overflow backpressure, or the SQPOLL
+        // thread has not caught up yet); the caller defers the op to its sqe_overflow.
         struct io_uring_sqe* get_sqe() {
             struct io_uring_sqe* sqe = io_uring_get_sqe(&impl);
-            // If nullptr, call submit_and_wait to drain completions, then retry.
-            // In practice RING_ENTRIES is generous enough that this should not happen
-            // during normal operation, but we handle it gracefully.
+            if (!sqe) {
+                io_uring_submit(&impl);
+                sqe = io_uring_get_sqe(&impl);
+            }
             return sqe;
         }
 
@@ -85,6 +143,17 @@ namespace hope::io::uring {
             return io_uring_wait_cqe_timeout(&impl, cqe, &ts);
         }
 
+        // Submits whatever is queued and waits for a completion in one io_uring_enter.
+        // Under SQPOLL liburing enters only to wake the SQ thread or to sleep; under
+        // DEFER_TASKRUN this is also where the batch of completions gets posted.
+        int submit_and_wait_timeout(struct io_uring_cqe** cqe, int timeout_ms) {
+            struct __kernel_timespec ts {
+                .tv_sec = timeout_ms / 1000,
+                .tv_nsec = (long)(timeout_ms % 1000) * 1000000,
+            };
+            return io_uring_submit_and_wait_timeout(&impl, cqe, 1, &ts, nullptr);
+        }
+
         void cqe_seen(struct io_uring_cqe* cqe) {
             io_uring_cqe_seen(&impl, cqe);
         }
@@ -104,6 +173,153 @@ namespace hope::io::uring {
         }
     };
 
+    // ── SQ overflow ────────────────────────────────────────────────────
+    // Ops that found no SQE even after a flush. The loop replays them after each completion
+    // batch and waits without blocking while any are left; replay re-checks whether an op
+    // is still wanted, so a connection that closed meanwhile is simply skipped.
+    class sqe_overflow final {
+    public:
+        struct entry {
+            uint8_t op;
+            int32_t fd;
+        };
+
+        void defer(uint8_t op, int32_t fd) { m_entries.push_back({ op, fd }); }
+
+        bool empty() const noexcept { return m_entries.empty(); }
+        std::size_t size() const noexcept { return m_entries.size(); }
+        void clear() noexcept { m_entries.clear(); }
+
+        // Ops deferred again during replay wait for the next one
+        template<typename F>
+        void replay(F&& fn) {
+            if (m_entries.empty()) return;
+            m_replaying.swap(m_entries);
+            for (auto& e : m_replaying) {
+                fn(e.op, e.fd);
+            }
+            m_replaying.clear();
+        }
+
+    private:
+        std::vector<entry> m_entries;
+        std::vector<entry> m_replaying;
+    };
+
+    // ── Provided buffer ring ───────────────────────────────────────────
+    // Kernel-registered pool of equally sized buffers shared by all connections of a loop.
+    // A recv with IOSQE_BUFFER_SELECT picks a free buffer at completion time, so idle
+    // connections pin no memory. The chosen buffer id comes back in cqe->flags and the
+    // buffer must be handed back with recycle() once its bytes are consumed.
+    struct provided_buffer_ring final {
+        void init(struct io_uring* ring, unsigned entries, std::size_t buffer_size, int group_id = 0) {
+            int ret = 0;
+            m_impl = io_uring_setup_buf_ring(ring, entries, group_id, 0, &ret);
+            if (m_impl == nullptr) {
+                errno = -ret;
+                HOPE_THROW_ERRNO("uring", "io_uring_setup_buf_ring failed (kernel 5.19+ required)");
+            }
+            m_ring = ring;
+            m_entries = entries;
+            m_buffer_size = buffer_size;
+            m_group_id = group_id;
+            m_mask = io_uring_buf_ring_mask(entries);
+            m_storage.reset(new unsigned char[entries * buffer_size]);
+            for (unsigned i = 0; i < entries; ++i) {
+                io_uring_buf_ring_add(m_impl, data((uint16_t)i), (unsigned)buffer_size, (unsigned short)i, m_mask, (int)i);
+            }
+            io_uring_buf_ring_advance(m_impl, (int)entries);
+        }
+
+        void exit() {
+            if (m_impl != nullptr) {
+                io_uring_free_buf_ring(m_ring, m_impl, m_entries, m_group_id);
+                m_impl = nullptr;
+            }
+            m_storage.reset();
+        }
+
+        unsigned char* data(uint16_t buffer_id) const noexcept {
+            return m_storage.get() + std::size_t(buffer_id) * m_buffer_size;
+        }
+
+        // Returns a consumed buffer to the kernel.
+        void recycle(uint16_t buffer_id) noexcept {
+            io_uring_buf_ring_add(m_impl, data(buffer_id), (unsigned)m_buffer_size, buffer_id, m_mask, 0);
+            io_uring_buf_ring_advance(m_impl, 1);
+        }
+
+        static bool has_buffer(unsigned cqe_flags) noexcept { return (cqe_flags & IORING_CQE_F_BUFFER) != 0; }
+        static uint16_t buffer_id(unsigned cqe_flags) noexcept { return uint16_t(cqe_flags >> IORING_CQE_BUFFER_SHIFT); }
+
+        int group_id() const noexcept { return m_group_id; }
+        bool is_initialized() const noexcept { return m_impl != nullptr; }
+
+    private:
+        struct io_uring* m_ring = nullptr;
+        struct io_uring_buf_ring* m_impl = nullptr;
+        std::unique_ptr<unsigned char[]> m_storage;
+        std::size_t m_buffer_size = 0;
+        unsigned m_entries = 0;
+        int m_mask = 0;
+        int m_group_id = 0;
+    };
+
+    // ── Registered buffers ─────────────────────────────────────────────
+    // Sparse table of registered buffers for READ_FIXED / WRITE_FIXED. Connection rings
+    // move when they change size class, so a slot is re-registered lazily when the
+    // storage behind it is not the one registered last (owner + storage generation).
+    // Registration pins pages against RLIMIT_MEMLOCK; init() returns false if refused.
+    struct fixed_buffer_table final {
+        // IORING_MAX_REG_BUFFERS
+        constexpr static unsigned max_slots = 1u << 14;
+
+        bool init(struct io_uring* ring, unsigned slots) {
+            slots = std::min(slots, max_slots);
+            if (slots == 0 || io_uring_register_buffers_sparse(ring, slots) < 0) return false;
+            m_ring = ring;
+            m_slots.assign(slots, {});
+            return true;
+        }
+
+        void exit() {
+            if (m_slots.empty()) return;
+            io_uring_unregister_buffers(m_ring);
+            m_slots.clear();
+        }
+
+        bool enabled() const noexcept { return !m_slots.empty(); }
+
+        // buf_index to use for I/O into owner's current storage, -1 if it cannot be registered
+        int index_for(unsigned slot, const void* owner, uint32_t generation, void* base, std::size_t size) {
+            if (slot >= m_slots.size()) return -1;
+            auto& e = m_slots[slot];
+            if (e.owner != owner || e.generation != generation || e.base != base) {
+                struct iovec iov { base, size };
+                __u64 tag = 0;
+                if (io_uring_register_buffers_update_tag(m_ring, slot, &iov, &tag, 1) < 0) return -1;
+                e = { owner, generation, base };
+            }
+            return (int)slot;
+        }
+
+    private:
+        struct entry {
+            const void* owner = nullptr;
+            uint32_t generation = 0;
+            void* base = nullptr;
+        };
+
+        struct io_uring* m_ring = nullptr;
+        std::vector<entry> m_slots;
+    };
+
+    // Multishot requests stay armed while IORING_CQE_F_MORE is set on their completions.
+    constexpr bool has_more(unsigned cqe_flags) { return (cqe_flags & IORING_CQE_F_MORE) != 0; }
+
+    // SEND_ZC: second completion of a request, the kernel no longer reads its memory.
+    constexpr bool is_notification(unsigned cqe_flags) { return (cqe_flags & IORING_CQE_F_NOTIF) != 0; }
+
 }
 
 #endif
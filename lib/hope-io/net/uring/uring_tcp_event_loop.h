@@ -9,8 +9,12 @@
 #pragma once
 
 #include "hope-io/net/event_loop.h"
+#include "hope-io/net/endpoint.h"
 #include "hope-io/net/stream_options_util.h"
 #include "hope-io/net/uring/uring_core.h"
+#include "hope-io/net/linux/post_queue.h"
+#include "hope-io/net/timer_wheel.h"
+#include "hope-io/net/zero_copy.h"
 
 #if PLATFORM_LINUX
 
@@ -18,7 +22,6 @@
 #include <atomic>
 #include <cstdint>
 
-#include <fcntl.h>
 #include <unistd.h>
 #include <arpa/inet.h>
 #include <sys/socket.h>
@@ -49,44 +52,73 @@ namespace hope::io::el {
         void run(const config& cfg) override {
             THREAD_SCOPE(EVENT_LOOP_THREAD);
 
-            // Create listen socket
-            m_listen_fd = socket(AF_INET, SOCK_STREAM, 0);
-            if (m_listen_fd == -1) {
-                throw_bind_err();
-            }
+            if (cfg.listen) {
+                endpoint srv_addr;
+                if (!endpoint::for_listen(cfg.bind_address, (uint16_t)cfg.port, srv_addr)) {
+                    HOPE_THROW("uring_tcp", "bind_address is not a numeric IPv4/IPv6 address: " + cfg.bind_address);
+                }
+                m_listen_fd = listen_socket(srv_addr, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, cfg.ipv6_only);
+                if (m_listen_fd == -1) {
+                    throw_bind_err();
+                }
 
-            int reuse = 1;
-            setsockopt(m_listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+                int reuse = 1;
+                setsockopt(m_listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
 
-            sockaddr_in srv_addr{};
-            srv_addr.sin_family = AF_INET;
-            srv_addr.sin_addr.s_addr = INADDR_ANY;
-            srv_addr.sin_port = htons(cfg.port);
-            if (bind(m_listen_fd, (struct sockaddr*)&srv_addr, sizeof(srv_addr)) == -1) {
-                throw_bind_err();
-            }
+                if (bind(m_listen_fd, srv_addr.addr(), srv_addr.size) == -1) {
+                    throw_bind_err();
+                }
 
-            auto flags = fcntl(m_listen_fd, F_GETFL, 0);
-            fcntl(m_listen_fd, F_SETFL, flags | O_NONBLOCK);
-            listen(m_listen_fd, cfg.max_mutual_connections);
+                m_accept_options = socket_option_list(cfg.accepted_stream_options);
+                m_accept_options.take_inherited().apply(m_listen_fd);
+                if (cfg.uring_fixed_files) {
+                    // Direct descriptors have no fd for setsockopt, the listener is all they can get
+                    m_accept_options.apply(m_listen_fd);
+                    m_accept_options = {};
+                }
+                listen(m_listen_fd, cfg.max_mutual_connections);
+            }
+            m_connect_options = socket_option_list(cfg.outbound_stream_options);
 
             // Init io_uring
-            m_ring.init();
+            m_ring.init(cfg.uring_ring);
+            m_ring_live = true;
 
             m_cfg = cfg;
-            m_pl.prepool(cfg.max_mutual_connections);
+            // Registration is an optimization, kernels or limits that refuse it keep the plain path
+            m_fixed_files = cfg.uring_fixed_files
+                && io_uring_register_files_sparse(&m_ring.impl, (unsigned)cfg.max_mutual_connections) == 0;
+            if (cfg.uring_fixed_buffers) {
+                m_fixed_buffers.init(&m_ring.impl, 2 * (unsigned)(cfg.max_mutual_connections + 1));
+            }
+            if (cfg.uring_multishot) {
+                // Recv memory comes from the shared ring, connection buffers are only
+                // held while a connection has unconsumed or unsent bytes.
+                m_buf_ring.init(&m_ring.impl, (unsigned)cfg.uring_buf_ring_entries, cfg.uring_buf_size);
+            } else {
+                m_pl.prepool(cfg.max_mutual_connections);
+            }
             m_connections.resize(cfg.max_mutual_connections + 1);
 
-            // Submit initial accept
+            // Initial accept and wakeup read go out with the first wait
+            m_accept_armed = m_wakeup_armed = false;
             rearm_accept();
-            m_ring.submit();
+            arm_wakeup();
 
             while (m_running.load(std::memory_order_acquire)) {
                 NAMED_SCOPE(Tick);
 
+                // SQEs queued by the previous batch are submitted by the same enter that waits,
+                // bounded by the next timer
                 struct io_uring_cqe* cqe = nullptr;
-                int ret = m_ring.wait_cqe_timeout(&cqe, 100);
-                if (ret == -ETIME) continue; // timeout, recheck m_running
+                // Deferred ops: only flush and reap, do not sleep until they are out
+                int wait_ms = m_overflow.empty() ? m_timers.next_timeout_ms(100) : 0;
+                int ret = m_ring.submit_and_wait_timeout(&cqe, wait_ms);
+                if (ret == -ETIME) {
+                    m_timers.advance(timer_wheel::clock::now());
+                    replay_deferred();
+                    continue; // recheck m_running
+                }
                 if (ret < 0) {
                     connection dumb;
                     m_on_err(dumb, "uring_tcp: io_uring_wait_cqe failed");
@@ -98,36 +130,75 @@ namespace hope::io::el {
                     NAMED_SCOPE(ProcessOne);
                     int res = cqe->res;
                     uint64_t ud = io_uring_cqe_get_data64(cqe);
+                    unsigned flags = cqe->flags;
                     count++;
 
+                    if (ud == uring::tag_ignore) continue;
+
+                    if (uring::is_connect(ud)) {
+                        handle_connect_completion(ud, res);
+                        continue;
+                    }
+
+                    if (ud == uring::tag_wakeup(m_posts.fd())) {
+                        m_wakeup_armed = false;
+                        handle_posts();
+                        arm_wakeup();
+                        continue;
+                    }
+
                     // ACCEPT completion
                     if (ud == uring::tag_accept(m_listen_fd)) {
                         if (res >= 0) {
                             int client_fd = res;
+                            // Accepted with SOCK_NONBLOCK, only options the listener could not pass on are left
+                            m_accept_options.apply(client_fd);
                             push_new_connection(client_fd);
+                            m_idle.arm(client_fd, std::chrono::milliseconds(m_cfg.idle_timeout_ms));
                             auto& conn = m_connections[client_fd].conn;
                             auto state = m_on_connect(conn);
-                            if (state == el_connection_state::die) {
-                                remove_connection(client_fd);
-                            } else {
-                                conn.set_state(state);
-                                if (state == el_connection_state::read) {
-                                    submit_recv(client_fd);
-                                } else if (state == el_connection_state::write) {
-                                    submit_send(client_fd);
-                                }
-                            }
+                            apply_state(client_fd, state);
+                        }
+                        // Multishot accept stays armed until the kernel drops IORING_CQE_F_MORE
+                        if (!m_cfg.uring_multishot || !uring::has_more(flags)) {
+                            m_accept_armed = false;
+                            rearm_accept();
                         }
-                        rearm_accept();
                         continue;
                     }
 
                     int fd = uring::fd_of(ud);
                     if (fd < 0 || (std::size_t)fd >= m_connections.size()) continue;
 
+                    auto& cs = m_connections[fd];
+                    if (cs.closing) {
+                        handle_closing_completion(fd, ud, flags);
+                        continue;
+                    }
+
+                    if (uring::is_send(ud) && uring::is_notification(flags)) {
+                        cs.zc.on_notification();
+                        continue;
+                    }
+
+                    if (m_cfg.uring_multishot && uring::is_recv(ud)) {
+                        handle_multishot_recv_completion(fd, res, flags);
+                        continue;
+                    }
+
+                    // Ignore stale completions, the kernel is done with the buffer either way
+                    if (uring::is_recv(ud)) {
+                        if (!cs.recv_pending) continue;
+                        cs.recv_pending = false;
+                        cs.conn.buffer->unpin();
+                    } else if (uring::is_send(ud)) {
+                        if (!cs.send_pending) continue;
+                        on_send_done(cs, flags);
+                    }
+
                     // Error or EOF
                     if (res <= 0) {
-                        remove_connection(fd);
+                        drop_connection(fd, "uring_tcp: connection closed");
                         continue;
                     }
 
@@ -139,153 +210,767 @@ namespace hope::io::el {
                 }
                 io_uring_cq_advance(&m_ring.impl, count);
 
-                // Submit all pending SQEs (including those added by completion handlers)
-                m_ring.submit();
+                // Buffers consumed in this batch are back in the ring, re-arm starved recvs
+                if (!m_starved.empty()) {
+                    auto starved = std::move(m_starved);
+                    m_starved.clear();
+                    for (auto fd : starved) {
+                        auto& cs = m_connections[fd];
+                        if (cs.conn.descriptor != -1 && !cs.recv_armed
+                            && wants_read(cs.conn.get_state())) {
+                            arm_multishot_recv(fd);
+                        }
+                    }
+                }
+
+                m_timers.advance(timer_wheel::clock::now());
+                replay_deferred();
             }
 
-            // Cleanup
-            for (auto& cs : m_connections) {
-                if (cs.conn.buffer) {
-                    m_pl.redeem(cs.conn.buffer);
-                    cs.conn.buffer = nullptr;
-                }
+            // Cleanup, tearing the ring down cancels whatever is still in flight
+            // and closes the sockets held in registered file slots
+            m_buf_ring.exit();
+            m_fixed_buffers.exit();
+            m_ring.exit();
+            m_ring_live = false;
+            m_overflow.clear();
+            for (std::size_t fd = 0; fd < m_connections.size(); ++fd) {
+                auto& cs = m_connections[fd];
+                if (cs.conn.descriptor == -1 && !cs.closing) continue;
+                if (cs.recv_pending) cs.conn.buffer->unpin();
+                if (cs.send_pending && !cs.send_is_segment) cs.conn.tx()->unpin();
+                cs.recv_pending = cs.send_pending = cs.recv_armed = false;
+                cs.stash.clear();
+                cs.zc.clear();
+                finish_close((int32_t)fd);
+            }
+            for (auto& o : m_outbound) {
+                // Direct sockets went with the ring
+                if (o.active && o.fd != -1 && !m_fixed_files) ::close(o.fd);
             }
-            ::close(m_listen_fd);
+            m_outbound.clear();
+            m_outbound_free.clear();
+            if (m_listen_fd != -1) ::close(m_listen_fd);
+            m_listen_fd = -1;
         }
 
         void stop() override {
             m_running = false;
         }
 
+        // Thread safe. Appends bytes to the connection's tx ring on the loop thread and starts
+        // sending. Half-duplex connections accept posts only while writing or with no unread
+        // input, use config::full_duplex for connections that also read. Descriptors are reused
+        // after close, producers must stop posting to a connection once on_err/die was seen.
+        void post(int32_t descriptor, std::vector<unsigned char> bytes) {
+            m_posts.push({ descriptor, std::move(bytes), {} });
+        }
+
+        // Thread safe. Runs fn on the loop thread.
+        void post(std::function<void()> fn) {
+            m_posts.push({ -1, {}, std::move(fn) });
+        }
+
+        // Loop thread only (from a callback or post(fn)). Queues buffer behind the bytes
+        // already in the tx ring and sends it with IORING_OP_SEND_ZC straight from its memory;
+        // buffer.owner is released on the notification CQE. Segments below
+        // config::zero_copy_min_size use a plain send. Same half-duplex rule as post().
+        void send_zero_copy(int32_t descriptor, zc_buffer buffer) {
+            if (descriptor < 0 || (std::size_t)descriptor >= m_connections.size()) return;
+            auto& cs = m_connections[descriptor];
+            if (cs.conn.descriptor != descriptor) return;
+            if (!prepare_output(descriptor, "send_zero_copy: half-duplex connection is reading, enable config::full_duplex")) return;
+            if (buffer.size == 0) return;
+            cs.zc.push(std::move(buffer), cs.conn.tx()->count() + cs.tx_backlog.size());
+            start_output(descriptor);
+        }
+
+        // Thread safe. Opens an outbound connection to ip:port (numeric IPv4 or IPv6) with
+        // IORING_OP_CONNECT; once established it goes through on_connect and the same state
+        // machine as an accepted one, with connection::tag == tag. A failed, refused or timed
+        // out attempt reports on_err with descriptor -1 and the tag. timeout 0 takes
+        // config::connect_timeout_ms. With uring_fixed_files the socket is created straight
+        // into a file slot and config::outbound_stream_options do not apply.
+        void connect(std::string_view ip, uint16_t port, uint64_t tag = 0,
+                     std::chrono::milliseconds timeout = std::chrono::milliseconds(0)) {
+            endpoint to;
+            if (!endpoint::parse(ip, port, to)) {
+                post([this, tag] { report_connect_error(tag, "connect: not a numeric IPv4/IPv6 address"); });
+                return;
+            }
+            post([this, to, tag, timeout] { start_connect(to, tag, timeout); });
+        }
+
+        // Loop thread only (callbacks or post(fn)). fn runs once after delay.
+        timer_wheel::timer_id add_timer(std::chrono::milliseconds delay, std::function<void()> fn) {
+            return m_timers.schedule(delay, std::move(fn));
+        }
+
+        // Loop thread only. Returns false if the timer already fired.
+        bool cancel_timer(timer_wheel::timer_id id) {
+            return m_timers.cancel(id);
+        }
+
     private:
-        enum class active_op : uint8_t {
-            none,
-            recv,
-            send,
+        // Provided buffer received by multishot recv but not yet copied into conn.buffer
+        // (connection buffer was full, or the connection was busy writing).
+        struct stashed_chunk {
+            uint16_t id;
+            uint32_t offset;
+            uint32_t length;
         };
 
         struct conn_state {
             connection conn;
-            active_op op = active_op::none;
+            bool recv_pending = false;  // single-shot recv in flight, rx ring pinned
+            bool send_pending = false;  // send in flight, tx ring pinned unless send_is_segment
+            bool send_is_segment = false; // the send in flight reads zc.pending.front()
+            bool recv_armed = false;    // multishot mode only
+            bool closing = false;       // removed, fd and buffers are released once nothing is in flight
+            std::vector<stashed_chunk> stash;
+
+            std::vector<unsigned char> tx_backlog; // posted bytes that did not fit the pinned tx ring
+            zc_queue zc;                           // send_zero_copy segments
+
+            bool in_flight() const noexcept {
+                return recv_pending || send_pending || recv_armed || zc.awaiting_notifications();
+            }
         };
 
+        void apply_state(int32_t fd, el_connection_state state) {
+            if (state == el_connection_state::die) {
+                remove_connection(fd);
+                return;
+            }
+            if (state == el_connection_state::idle) return;
+
+            auto& cs = m_connections[fd];
+            assert(state != el_connection_state::read_write || cs.conn.tx_buffer);
+            cs.conn.set_state(state);
+            // Full duplex keeps a recv and a send in flight at the same time
+            if (wants_write(state)) {
+                submit_send(fd);
+            }
+            if (wants_read(state)) {
+                submit_recv(fd);
+            }
+        }
+
         // ── Accept ────────────────────────────────────────────────────────
         void rearm_accept() {
+            if (m_accept_armed || m_listen_fd == -1) return;
             auto* sqe = m_ring.get_sqe();
-            HOPE_ASSERT(sqe != nullptr, "uring_tcp: out of SQEs in rearm_accept");
-            io_uring_prep_accept(sqe, m_listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (!sqe) {
+                m_overflow.defer((uint8_t)deferred_op::accept, m_listen_fd);
+                return;
+            }
+            if (m_fixed_files && m_cfg.uring_multishot) {
+                io_uring_prep_multishot_accept_direct(sqe, m_listen_fd, nullptr, nullptr, 0);
+            } else if (m_fixed_files) {
+                io_uring_prep_accept_direct(sqe, m_listen_fd, nullptr, nullptr, 0, IORING_FILE_INDEX_ALLOC);
+            } else if (m_cfg.uring_multishot) {
+                io_uring_prep_multishot_accept(sqe, m_listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            } else {
+                io_uring_prep_accept(sqe, m_listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            }
             io_uring_sqe_set_data64(sqe, uring::tag_accept(m_listen_fd));
+            m_accept_armed = true;
+        }
+
+        // ── Connect ──────────────────────────────────────────────────────
+        // One table entry per attempt in flight, the CQE tag carries its index and generation.
+        // Fixed files: SOCKET (direct) first, its CQE names the slot, then CONNECT on the slot.
+        struct outbound final {
+            endpoint to;
+            uint64_t tag = 0;
+            int32_t fd = -1;            // socket, or file slot; -1 while the direct socket is created
+            uint16_t generation = 0;
+            bool active = false;
+            bool timed_out = false;
+        };
+
+        void start_connect(const endpoint& to, uint64_t tag, std::chrono::milliseconds timeout) {
+            int32_t fd = -1;
+            if (!m_fixed_files) {
+                fd = socket(to.family(), SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+                if (fd == -1) {
+                    report_connect_error(tag, std::string("connect: socket failed: ") + strerror(errno));
+                    return;
+                }
+                m_connect_options.apply(fd);
+            }
+            uint32_t index;
+            if (!m_outbound_free.empty()) {
+                index = m_outbound_free.back();
+                m_outbound_free.pop_back();
+            } else {
+                index = (uint32_t)m_outbound.size();
+                m_outbound.emplace_back();
+            }
+            auto& o = m_outbound[index];
+            o.to = to;
+            o.tag = tag;
+            o.fd = fd;
+            o.active = true;
+            o.timed_out = false;
+            if (timeout.count() == 0) timeout = std::chrono::milliseconds(m_cfg.connect_timeout_ms);
+            m_connect_deadlines.arm((int32_t)index, timeout);
+            submit_connect(index);
+        }
+
+        void submit_connect(uint32_t index) {
+            auto& o = m_outbound[index];
+            auto* sqe = m_ring.get_sqe();
+            if (!sqe) {
+                m_overflow.defer((uint8_t)deferred_op::connect, (int32_t)index);
+                return;
+            }
+            if (o.fd == -1) {
+                io_uring_prep_socket_direct_alloc(sqe, o.to.family(), SOCK_STREAM, 0, 0);
+            } else {
+                io_uring_prep_connect(sqe, o.fd, o.to.addr(), o.to.size);
+                target_connection(sqe);
+            }
+            io_uring_sqe_set_data64(sqe, uring::tag_connect(index, o.generation));
+        }
+
+        void handle_connect_completion(uint64_t ud, int res) {
+            auto index = uring::connect_index(ud);
+            if (index >= m_outbound.size()) return;
+            auto& o = m_outbound[index];
+            if (!o.active || o.generation != uring::connect_generation(ud)) return;
+            if (o.fd == -1) {
+                // Direct socket created, res is its slot
+                if (res < 0) {
+                    fail_connect(index, -res);
+                } else {
+                    o.fd = res;
+                    if (o.timed_out) fail_connect(index, ETIMEDOUT);
+                    else submit_connect(index);
+                }
+                return;
+            }
+            if (res < 0) {
+                fail_connect(index, o.timed_out ? ETIMEDOUT : -res);
+                return;
+            }
+            auto fd = o.fd;
+            auto tag = o.tag;
+            release_connect(index);
+
+            push_new_connection(fd);
+            m_idle.arm(fd, std::chrono::milliseconds(m_cfg.idle_timeout_ms));
+            auto& conn = m_connections[fd].conn;
+            conn.tag = tag;
+            auto state = m_on_connect(conn);
+            apply_state(fd, state);
+        }
+
+        // Deadline: cancel the CONNECT, its -ECANCELED completion reports the timeout
+        void expire_connect(int32_t index) {
+            auto& o = m_outbound[index];
+            if (!o.active) return;
+            o.timed_out = true;
+            if (o.fd == -1) return; // the socket completion sees timed_out
+            cancel_connect((uint32_t)index);
+        }
+
+        void cancel_connect(uint32_t index) {
+            auto& o = m_outbound[index];
+            auto* sqe = m_ring.get_sqe();
+            if (!sqe) {
+                m_overflow.defer((uint8_t)deferred_op::cancel_connect, (int32_t)index);
+                return;
+            }
+            io_uring_prep_cancel64(sqe, uring::tag_connect(index, o.generation), 0);
+            io_uring_sqe_set_data64(sqe, uring::tag_ignore);
+        }
+
+        void fail_connect(uint32_t index, int error) {
+            auto& o = m_outbound[index];
+            auto tag = o.tag;
+            if (o.fd != -1) close_socket(o.fd);
+            release_connect(index);
+            report_connect_error(tag, std::string("connect failed: ") + strerror(error));
+        }
+
+        void release_connect(uint32_t index) {
+            m_connect_deadlines.disarm((int32_t)index);
+            auto& o = m_outbound[index];
+            o.active = false;
+            o.fd = -1;
+            ++o.generation; // a late cancel cannot hit the next attempt in this entry
+            m_outbound_free.push_back(index);
+        }
+
+        void report_connect_error(uint64_t tag, const std::string& what) {
+            connection failed;
+            failed.tag = tag;
+            m_on_err(failed, what);
+        }
+
+        // ── Cross-thread posts ───────────────────────────────────────────
+        // MSG_RING needs a ring on the sending side, producers are plain threads,
+        // so they wake the loop through an eventfd with a read kept armed here.
+        void arm_wakeup() {
+            if (m_wakeup_armed) return;
+            auto* sqe = m_ring.get_sqe();
+            if (!sqe) {
+                m_overflow.defer((uint8_t)deferred_op::wakeup, m_posts.fd());
+                return;
+            }
+            io_uring_prep_read(sqe, m_posts.fd(), &m_wakeup_counter, sizeof(m_wakeup_counter), 0);
+            io_uring_sqe_set_data64(sqe, uring::tag_wakeup(m_posts.fd()));
+            m_wakeup_armed = true;
+        }
+
+        void handle_posts() {
+            NAMED_SCOPE(HandlePosts);
+            m_posts.drain([this](post_queue::task& task) {
+                if (task.fn) {
+                    task.fn();
+                } else {
+                    deliver_post(task.descriptor, task.bytes);
+                }
+            });
+        }
+
+        void deliver_post(int32_t fd, const std::vector<unsigned char>& bytes) {
+            if (fd < 0 || (std::size_t)fd >= m_connections.size()) return;
+            auto& cs = m_connections[fd];
+            if (cs.conn.descriptor != fd) return; // closed meanwhile
+
+            if (!prepare_output(fd, "post: half-duplex connection is reading, enable config::full_duplex")) return;
+
+            auto* tx = cs.conn.tx();
+            auto written = cs.tx_backlog.empty() ? tx->write(bytes.data(), bytes.size()) : 0;
+            if (written != bytes.size()) {
+                if (!tx->is_pinned()) {
+                    report_post_error(fd, "post: tx ring overflow");
+                    return;
+                }
+                // The ring cannot grow under the in-flight send, keep the rest for its completion
+                cs.tx_backlog.insert(cs.tx_backlog.end(), bytes.begin() + written, bytes.end());
+            }
+            start_output(fd);
+        }
+
+        // Half duplex: the shared ring is the recv target while reading
+        bool prepare_output(int32_t fd, const char* err) {
+            auto& cs = m_connections[fd];
+            if (cs.conn.tx_buffer || cs.conn.get_state() == el_connection_state::write) return true;
+            if (cs.recv_pending || (cs.conn.buffer && !cs.conn.buffer->is_empty())) {
+                report_post_error(fd, err);
+                return false;
+            }
+            if (!cs.conn.buffer) {
+                cs.conn.buffer = m_pl.allocate(); // released by an idle multishot connection
+            }
+            return true;
+        }
+
+        void start_output(int32_t fd) {
+            auto state = m_connections[fd].conn.get_state();
+            if (!wants_write(state)) {
+                state = m_connections[fd].conn.tx_buffer ? el_connection_state::read_write : el_connection_state::write;
+            }
+            apply_state(fd, state);
+        }
+
+        void report_post_error(int32_t fd, const char* what) {
+            auto state = m_on_err(m_connections[fd].conn, what);
+            apply_state(fd, state);
         }
 
         // ── Recv / Send submissions ──────────────────────────────────────
         void submit_recv(int32_t fd) {
             if ((std::size_t)fd >= m_connections.size()) return;
             auto& cs = m_connections[fd];
-            if (!cs.conn.buffer) return;
+            if (m_cfg.uring_multishot) {
+                resume_multishot_recv(fd);
+                return;
+            }
+            if (!cs.conn.buffer || cs.recv_pending) return;
 
             auto [data, size] = cs.conn.buffer->get_free_region();
             if (size == 0) return; // buffer full
 
             auto* sqe = m_ring.get_sqe();
-            if (!sqe) return; // ring full, will be retried on next tick
-            io_uring_prep_recv(sqe, fd, data, size, 0);
+            if (!sqe) {
+                m_overflow.defer((uint8_t)deferred_op::recv, fd);
+                return;
+            }
+            auto index = fixed_index(fd, cs.conn.buffer);
+            if (index >= 0) {
+                io_uring_prep_read_fixed(sqe, fd, data, (unsigned)size, 0, index);
+            } else {
+                io_uring_prep_recv(sqe, fd, data, size, 0);
+            }
+            target_connection(sqe);
             io_uring_sqe_set_data64(sqe, uring::tag_recv(fd));
-            cs.op = active_op::recv;
+            cs.conn.buffer->pin();
+            cs.recv_pending = true;
         }
 
         void submit_send(int32_t fd) {
             if ((std::size_t)fd >= m_connections.size()) return;
             auto& cs = m_connections[fd];
-            if (!cs.conn.buffer) return;
+            auto* tx = cs.conn.tx();
+            if (cs.send_pending) return;
+
+            // Ring bytes and zero-copy segments go out in the order they were queued
+            auto budget = cs.zc.ring_budget();
+            if (tx && budget != 0 && !tx->is_empty()) {
+                auto [data, size] = tx->get_used_region();
+                auto* sqe = m_ring.get_sqe();
+                if (!sqe) {
+                    m_overflow.defer((uint8_t)deferred_op::send, fd);
+                    return;
+                }
+                auto index = fixed_index(fd, tx);
+                if (index >= 0) {
+                    io_uring_prep_write_fixed(sqe, fd, data, (unsigned)std::min(size, budget), 0, index);
+                } else {
+                    io_uring_prep_send(sqe, fd, data, std::min(size, budget), 0);
+                }
+                target_connection(sqe);
+                io_uring_sqe_set_data64(sqe, uring::tag_send(fd));
+                tx->pin();
+                cs.send_pending = true;
+                cs.send_is_segment = false;
+            } else if (!cs.zc.empty()) {
+                auto& s = cs.zc.pending.front();
+                auto* data = (const char*)s.buffer.data + s.offset;
+                auto size = s.buffer.size - s.offset;
+                auto* sqe = m_ring.get_sqe();
+                if (!sqe) {
+                    m_overflow.defer((uint8_t)deferred_op::send, fd);
+                    return;
+                }
+                if (size >= m_cfg.zero_copy_min_size) {
+                    io_uring_prep_send_zc(sqe, fd, data, size, 0, 0);
+                } else {
+                    io_uring_prep_send(sqe, fd, data, size, 0);
+                }
+                target_connection(sqe);
+                io_uring_sqe_set_data64(sqe, uring::tag_send(fd));
+                cs.send_pending = true;
+                cs.send_is_segment = true;
+            }
+        }
+
+        // First completion of a send; a SEND_ZC with F_MORE is followed by a notification
+        void on_send_done(conn_state& cs, unsigned flags) {
+            cs.send_pending = false;
+            if (!cs.send_is_segment) {
+                cs.conn.tx()->unpin();
+            } else if (uring::has_more(flags)) {
+                auto seq = cs.zc.expect_notification();
+                if (!cs.zc.empty()) {
+                    cs.zc.pending.front().zero_copy = true;
+                    cs.zc.pending.front().last_seq = seq;
+                }
+            }
+        }
 
-            auto [data, size] = cs.conn.buffer->get_used_region();
-            if (size == 0) return; // nothing to send
+        // ── Registered files / buffers ───────────────────────────────────
+        void target_connection(struct io_uring_sqe* sqe) const {
+            if (m_fixed_files) sqe->flags |= IOSQE_FIXED_FILE;
+        }
+
+        // rx ring at slot 2 * fd, tx ring at 2 * fd + 1; -1 means use the plain op
+        int fixed_index(int32_t fd, tiered_buffer* buf) {
+            if (!m_fixed_buffers.enabled()) return -1;
+            auto slot = 2 * (unsigned)fd + (buf == m_connections[fd].conn.buffer ? 0 : 1);
+            auto [base, size] = buf->storage();
+            return m_fixed_buffers.index_for(slot, buf, buf->storage_generation(), base, size);
+        }
+
+        void shutdown_socket(int32_t fd) {
+            if (!m_fixed_files) {
+                ::shutdown(fd, SHUT_RDWR);
+                return;
+            }
+            auto* sqe = m_ring.get_sqe();
+            if (!sqe) {
+                m_overflow.defer((uint8_t)deferred_op::shutdown, fd);
+                return;
+            }
+            io_uring_prep_shutdown(sqe, fd, SHUT_RDWR);
+            sqe->flags |= IOSQE_FIXED_FILE;
+            io_uring_sqe_set_data64(sqe, uring::tag_ignore);
+        }
 
+        void close_socket(int32_t fd) {
+            if (!m_fixed_files) {
+                ::close(fd);
+                return;
+            }
+            if (!m_ring_live) return; // ring teardown released the slots
+            // The slot stays taken until this completes, accept cannot hand it out before
             auto* sqe = m_ring.get_sqe();
-            if (!sqe) return;
-            io_uring_prep_send(sqe, fd, data, size, 0);
-            io_uring_sqe_set_data64(sqe, uring::tag_send(fd));
-            cs.op = active_op::send;
+            if (!sqe) {
+                m_overflow.defer((uint8_t)deferred_op::close, fd);
+                return;
+            }
+            io_uring_prep_close_direct(sqe, (unsigned)fd);
+            io_uring_sqe_set_data64(sqe, uring::tag_ignore);
+        }
+
+        // ── SQ overflow ──────────────────────────────────────────────────
+        enum class deferred_op : uint8_t { accept, wakeup, recv, send, shutdown, close, connect, cancel_connect };
+
+        void replay_deferred() {
+            m_overflow.replay([this](uint8_t op, int32_t fd) {
+                switch ((deferred_op)op) {
+                    case deferred_op::accept: rearm_accept(); break;
+                    case deferred_op::wakeup: arm_wakeup(); break;
+                    case deferred_op::recv: {
+                        auto& cs = m_connections[fd];
+                        if (cs.conn.descriptor != fd || !wants_read(cs.conn.get_state())) break;
+                        if (!m_cfg.uring_multishot) submit_recv(fd);
+                        else if (!cs.recv_armed) arm_multishot_recv(fd);
+                        break;
+                    }
+                    case deferred_op::send: {
+                        auto& cs = m_connections[fd];
+                        if (cs.conn.descriptor == fd && wants_write(cs.conn.get_state())) submit_send(fd);
+                        break;
+                    }
+                    case deferred_op::shutdown:
+                        if (m_connections[fd].closing) shutdown_socket(fd);
+                        break;
+                    case deferred_op::close: close_socket(fd); break;
+                    // fd is the outbound table index here
+                    case deferred_op::connect:
+                        if (m_outbound[fd].active) submit_connect((uint32_t)fd);
+                        break;
+                    case deferred_op::cancel_connect:
+                        if (m_outbound[fd].active && m_outbound[fd].timed_out) cancel_connect((uint32_t)fd);
+                        break;
+                }
+            });
         }
 
         // ── Completion handlers ──────────────────────────────────────────
         void handle_recv_completion(int32_t fd, int res) {
             if ((std::size_t)fd >= m_connections.size()) return;
             auto& cs = m_connections[fd];
-
-            // Ignore stale completion (state changed since submission)
-            if (cs.op != active_op::recv) return;
-            cs.op = active_op::none;
-
+            m_idle.touch(fd);
             cs.conn.buffer->advance_tail((std::size_t)res);
             auto state = m_on_read(cs.conn);
-            if (state == el_connection_state::die) {
-                remove_connection(fd);
-            } else if (state == el_connection_state::write) {
-                cs.conn.set_state(el_connection_state::write);
-                submit_send(fd);
-            } else if (state == el_connection_state::read) {
-                cs.conn.set_state(el_connection_state::read);
-                submit_recv(fd);
-            }
+            apply_state(fd, state);
         }
 
         void handle_send_completion(int32_t fd, int res) {
             if ((std::size_t)fd >= m_connections.size()) return;
             auto& cs = m_connections[fd];
+            m_idle.touch(fd);
+            auto* tx = cs.conn.tx();
+            if (cs.send_is_segment) {
+                auto& s = cs.zc.pending.front();
+                s.offset += (std::size_t)res;
+                if (s.offset == s.buffer.size) {
+                    cs.zc.on_segment_sent();
+                }
+            } else {
+                tx->advance_head((std::size_t)res);
+                cs.zc.on_ring_sent((std::size_t)res);
+                if (!cs.tx_backlog.empty()) {
+                    auto n = tx->write(cs.tx_backlog.data(), cs.tx_backlog.size());
+                    cs.tx_backlog.erase(cs.tx_backlog.begin(), cs.tx_backlog.begin() + n);
+                }
+            }
 
-            // Ignore stale completion (state changed since submission)
-            if (cs.op != active_op::send) return;
-            cs.op = active_op::none;
-
-            cs.conn.buffer->advance_head((std::size_t)res);
-
-            // If buffer is fully drained, report write complete
-            if (cs.conn.buffer->is_empty()) {
+            // If the ring and the zero-copy queue are drained, report write complete
+            if ((!tx || tx->is_empty()) && cs.tx_backlog.empty() && cs.zc.empty()) {
                 auto state = m_on_write(cs.conn);
-                if (state == el_connection_state::die) {
-                    remove_connection(fd);
-                } else if (state == el_connection_state::read) {
-                    cs.conn.set_state(el_connection_state::read);
-                    submit_recv(fd);
-                } else if (state == el_connection_state::write) {
-                    cs.conn.set_state(el_connection_state::write);
-                    submit_send(fd);
-                }
+                apply_state(fd, state);
             } else {
                 // Partial send — submit another SQE to send remaining data
                 submit_send(fd);
             }
         }
 
-        // ── Connection management ────────────────────────────────────────
-        void push_new_connection(int32_t fd) {
-            int flags = fcntl(fd, F_GETFL, 0);
-            if (flags != -1) {
-                fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+        // ── Multishot recv (provided buffer ring) ────────────────────────
+        // One recv SQE per connection stays armed for its whole life. Completions land
+        // in the stash and are copied into conn.buffer while the connection reads;
+        // bytes arriving while a half-duplex connection writes wait in the stash.
+        void arm_multishot_recv(int32_t fd) {
+            auto& cs = m_connections[fd];
+            auto* sqe = m_ring.get_sqe();
+            if (!sqe) {
+                m_overflow.defer((uint8_t)deferred_op::recv, fd);
+                return;
             }
+            io_uring_prep_recv_multishot(sqe, fd, nullptr, 0, 0);
+            target_connection(sqe);
+            sqe->flags |= IOSQE_BUFFER_SELECT;
+            sqe->buf_group = m_buf_ring.group_id();
+            io_uring_sqe_set_data64(sqe, uring::tag_recv(fd));
+            cs.recv_armed = true;
+        }
 
-            apply_stream_options(fd, m_cfg.accepted_stream_options);
+        void resume_multishot_recv(int32_t fd) {
+            auto& cs = m_connections[fd];
+            if (!cs.stash.empty() && drain_stash(cs) > 0) {
+                auto state = m_on_read(cs.conn);
+                apply_state(fd, state);
+                return;
+            }
+            // Nothing buffered: give the connection buffer back, an idle connection pins no memory
+            if (cs.conn.buffer && cs.conn.buffer->is_empty()) {
+                m_pl.redeem(cs.conn.buffer);
+                cs.conn.buffer = nullptr;
+            }
+            if (!cs.recv_armed) {
+                arm_multishot_recv(fd);
+            }
+        }
 
+        // Copies stashed chunks into conn.buffer and recycles fully consumed ones.
+        std::size_t drain_stash(conn_state& cs) {
+            if (!cs.conn.buffer) {
+                cs.conn.buffer = m_pl.allocate();
+            }
+            std::size_t moved = 0;
+            std::size_t consumed = 0;
+            for (auto& chunk : cs.stash) {
+                auto n = cs.conn.buffer->write(m_buf_ring.data(chunk.id) + chunk.offset, chunk.length);
+                moved += n;
+                chunk.offset += (uint32_t)n;
+                chunk.length -= (uint32_t)n;
+                if (chunk.length != 0) break; // connection buffer is full
+                m_buf_ring.recycle(chunk.id);
+                ++consumed;
+            }
+            cs.stash.erase(cs.stash.begin(), cs.stash.begin() + consumed);
+            return moved;
+        }
+
+        void handle_multishot_recv_completion(int32_t fd, int res, unsigned flags) {
+            auto& cs = m_connections[fd];
+            if (!uring::has_more(flags)) {
+                cs.recv_armed = false;
+            }
+
+            if (uring::provided_buffer_ring::has_buffer(flags)) {
+                auto id = uring::provided_buffer_ring::buffer_id(flags);
+                if (res > 0 && cs.conn.descriptor != -1) {
+                    m_idle.touch(fd);
+                    cs.stash.push_back({id, 0, (uint32_t)res});
+                } else {
+                    m_buf_ring.recycle(id);
+                }
+            }
+
+            if (cs.conn.descriptor == -1) return; // stale completion
+
+            if (res == -ENOBUFS) {
+                // Ring ran dry, the kernel terminated the multishot recv
+                m_starved.push_back(fd);
+                return;
+            }
+            if (res <= 0) {
+                drop_connection(fd, "uring_tcp: connection closed");
+                return;
+            }
+
+            if (wants_read(cs.conn.get_state())) {
+                resume_multishot_recv(fd);
+            }
+        }
+
+        // Completion for a removed connection, releases everything after the last one
+        void handle_closing_completion(int32_t fd, uint64_t ud, unsigned flags) {
+            auto& cs = m_connections[fd];
+            if (uring::is_recv(ud)) {
+                if (m_cfg.uring_multishot) {
+                    if (!uring::has_more(flags)) cs.recv_armed = false;
+                    if (uring::provided_buffer_ring::has_buffer(flags)) {
+                        m_buf_ring.recycle(uring::provided_buffer_ring::buffer_id(flags));
+                    }
+                } else if (cs.recv_pending) {
+                    cs.recv_pending = false;
+                    cs.conn.buffer->unpin();
+                }
+            } else if (uring::is_send(ud) && uring::is_notification(flags)) {
+                cs.zc.on_notification();
+            } else if (uring::is_send(ud) && cs.send_pending) {
+                on_send_done(cs, flags);
+            }
+            if (!cs.in_flight()) {
+                finish_close(fd);
+            }
+        }
+
+        // ── Connection management ────────────────────────────────────────
+        void push_new_connection(int32_t fd) {
             if ((std::size_t)fd >= m_connections.size()) {
                 m_connections.resize(fd + 1);
             }
 
             auto& cs = m_connections[fd];
             cs.conn.descriptor = fd;
+            cs.conn.tag = 0;
             cs.conn.buffer = m_pl.allocate();
-            cs.op = active_op::none;
+            if (m_cfg.full_duplex) {
+                cs.conn.tx_buffer = m_pl.allocate();
+            }
+            cs.recv_pending = false;
+            cs.send_pending = false;
+            cs.recv_armed = false;
+            cs.closing = false;
+            cs.tx_backlog.clear();
+            cs.zc.clear();
         }
 
         void remove_connection(int32_t fd) {
             if ((std::size_t)fd >= m_connections.size()) return;
+            auto& cs = m_connections[fd];
+            if (cs.conn.descriptor == -1) return; // already removed
+            m_idle.disarm(fd);
+            cs.conn.descriptor = -1;
+            for (auto& chunk : cs.stash) {
+                m_buf_ring.recycle(chunk.id);
+            }
+            cs.stash.clear();
+            if (cs.in_flight()) {
+                // In-flight ops still reference the socket and pinned buffers; shutdown makes
+                // them complete, the last completion calls finish_close.
+                shutdown_socket(fd);
+                cs.closing = true;
+                return;
+            }
+            finish_close(fd);
+        }
+
+        void expire_idle(int32_t fd) {
+            drop_connection(fd, "uring_tcp: idle timeout, close connection");
+        }
+
+        // The connection is going away regardless of what on_err answers
+        void drop_connection(int32_t fd, const char* what) {
+            auto& cs = m_connections[fd];
+            if (cs.conn.descriptor != fd) return;
+            m_on_err(cs.conn, what);
+            remove_connection(fd);
+        }
+
+        void finish_close(int32_t fd) {
             auto& cs = m_connections[fd];
             if (cs.conn.buffer) {
                 m_pl.redeem(cs.conn.buffer);
                 cs.conn.buffer = nullptr;
             }
-            cs.op = active_op::none;
-            ::close(fd);
+            if (cs.conn.tx_buffer) {
+                m_pl.redeem(cs.conn.tx_buffer);
+                cs.conn.tx_buffer = nullptr;
+            }
+            cs.conn.descriptor = -1;
+            cs.closing = false;
+            cs.zc.clear();
+            close_socket(fd);
         }
 
         void throw_bind_err() {
@@ -302,6 +987,10 @@ namespace hope::io::el {
 
         uring::ring m_ring;
         int32_t m_listen_fd = -1;
+        socket_option_list m_accept_options;
+        socket_option_list m_connect_options;
+        std::vector<outbound> m_outbound;
+        std::vector<uint32_t> m_outbound_free;
 
         TOnError m_on_err;
         TOnWrite m_on_write;
@@ -310,6 +999,19 @@ namespace hope::io::el {
 
         config m_cfg;
         buffer_pool m_pl;
+        post_queue m_posts;
+        uint64_t m_wakeup_counter = 0;
+        timer_wheel m_timers;
+        descriptor_timeouts m_idle{ m_timers, [this](int32_t fd) { expire_idle(fd); } };
+        descriptor_timeouts m_connect_deadlines{ m_timers, [this](int32_t index) { expire_connect(index); } };
+        uring::provided_buffer_ring m_buf_ring;
+        uring::fixed_buffer_table m_fixed_buffers;
+        uring::sqe_overflow m_overflow;
+        bool m_accept_armed = false;
+        bool m_wakeup_armed = false;
+        bool m_fixed_files = false; // connection descriptors are registered file slots
+        bool m_ring_live = false;
+        std::vector<int32_t> m_starved;
         std::vector<conn_state> m_connections;
         std::atomic<bool> m_running = true;
     };
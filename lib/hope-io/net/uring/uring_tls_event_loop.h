@@ -10,34 +10,41 @@
 
 #include "hope-io/net/tls_event_loop.h"
 #include "hope-io/net/event_loop.h"
+#include "hope-io/net/endpoint.h"
 #include "hope-io/net/stream_options_util.h"
 #include "hope-io/net/tls/ktls_enable.h"
 #include "hope-io/net/uring/uring_core.h"
+#include "hope-io/net/linux/tls_key_offload.h"
+#include "hope-io/net/timer_wheel.h"
 #include "hope-io/net/init.h"
 
 #if PLATFORM_LINUX
 
 #include <vector>
-#include <unordered_set>
+#include <memory>
 #include <atomic>
 #include <cstdint>
 
-#include <fcntl.h>
-#include <poll.h>
-#include <sys/epoll.h>
 #include <unistd.h>
 #include <arpa/inet.h>
 #include <sys/socket.h>
 #include <netinet/ip.h>
 #include <netinet/tcp.h>
+#include <linux/tls.h>
 #include <cstring>
 #include <cerrno>
 
 #include "openssl/ssl.h"
 #include "openssl/err.h"
+#include "openssl/bio.h"
 
 namespace hope::io::el {
 
+    // TLS server on io_uring only: ACCEPT, RECV and SEND are ring ops, the loop never polls.
+    // Without kTLS the socket is not SSL's business at all: ciphertext is received into a
+    // per-connection buffer and written into a memory BIO, SSL decrypts from it and encrypts
+    // into a second one that SEND drains, so a tick's worth of connections costs one
+    // io_uring_enter as with uring_tcp_event_loop. With kTLS RECV and SEND carry plaintext.
     template<typename TOnRead, typename TOnWrite, typename TOnError, typename TConnected>
     class uring_tls_event_loop final
         : public tls_event_loop<TOnRead, TOnWrite, TOnError, TConnected> {
@@ -50,17 +57,16 @@ namespace hope::io::el {
             , m_on_err(std::move(on_error)) {}
 
         ~uring_tls_event_loop() override {
-            if (m_ctx) {
-                SSL_CTX_free(m_ctx);
-            }
             for (auto& cs : m_connections) {
                 if (cs.tls.ssl) {
                     SSL_free(cs.tls.ssl);
                     cs.tls.ssl = nullptr;
                 }
             }
+            if (m_ctx) {
+                SSL_CTX_free(m_ctx);
+            }
             m_pl.drain();
-            m_pending_handshakes.clear();
         }
 
         void run(const tls_config& cfg) override {
@@ -89,7 +95,13 @@ namespace hope::io::el {
             SSL_CTX_sess_set_cache_size(m_ctx, 128);
 
             // Create listen socket
-            m_listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+            endpoint srv_addr;
+            if (!endpoint::for_listen(cfg.bind_address, (uint16_t)cfg.port, srv_addr)) {
+                SSL_CTX_free(m_ctx);
+                m_ctx = nullptr;
+                HOPE_THROW("uring_tls", "bind_address is not a numeric IPv4/IPv6 address: " + cfg.bind_address);
+            }
+            m_listen_fd = listen_socket(srv_addr, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, cfg.ipv6_only);
             if (m_listen_fd == -1) {
                 SSL_CTX_free(m_ctx);
                 m_ctx = nullptr;
@@ -99,51 +111,35 @@ namespace hope::io::el {
             int reuse = 1;
             setsockopt(m_listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
 
-            sockaddr_in srv_addr{};
-            srv_addr.sin_family = AF_INET;
-            srv_addr.sin_addr.s_addr = INADDR_ANY;
-            srv_addr.sin_port = htons(cfg.port);
-            if (bind(m_listen_fd, (struct sockaddr*)&srv_addr, sizeof(srv_addr)) == -1) {
+            if (bind(m_listen_fd, srv_addr.addr(), srv_addr.size) == -1) {
                 throw_bind_err();
             }
 
-            auto flags = fcntl(m_listen_fd, F_GETFL, 0);
-            if (flags != -1) {
-                fcntl(m_listen_fd, F_SETFL, flags | O_NONBLOCK);
-            }
+            m_accept_options = socket_option_list(cfg.accepted_stream_options);
+            m_accept_options.take_inherited().apply(m_listen_fd);
             listen(m_listen_fd, cfg.max_mutual_connections);
 
-            // Create epoll fd for accept monitoring
-            int epfd = epoll_create1(0);
-            if (epfd < 0) { throw std::runtime_error("epoll_create1 failed"); }
-            {
-                epoll_event ev;
-                ev.events = EPOLLIN;
-                ev.data.fd = m_listen_fd;
-                epoll_ctl(epfd, EPOLL_CTL_ADD, m_listen_fd, &ev);
-            }
-
             // Init io_uring
-            m_ring.init();
+            m_ring.init(cfg.uring_ring);
             m_pl.prepool(cfg.max_mutual_connections);
             m_connections.resize(cfg.max_mutual_connections + 1);
             m_cfg = cfg;
+            if (cfg.handshake_workers > 0) {
+                m_key_offload = std::make_unique<tls_key_offload>(SSL_CTX_get0_privatekey(m_ctx), cfg.handshake_workers);
+                m_key_offload->install(m_ctx);
+            }
+            m_accept_armed = m_key_offload_armed = false;
+            rearm_accept();
 
             while (m_running.load(std::memory_order_acquire)) {
                 NAMED_SCOPE(TlsTick);
 
-                // Non-blocking check for new connections via epoll
-                {
-                    epoll_event ev;
-                    while (epoll_wait(epfd, &ev, 1, 0) > 0) {
-                        if (ev.data.fd == m_listen_fd) {
-                            handle_accept();
-                        }
-                    }
-                }
+                arm_key_offload();
 
                 struct io_uring_cqe* cqe = nullptr;
-                int ret = m_ring.wait_cqe_timeout(&cqe, 10);
+                // Submits the SQEs queued since the last tick in the same enter
+                int wait_ms = m_overflow.empty() ? m_timers.next_timeout_ms(100) : 0;
+                int ret = m_ring.submit_and_wait_timeout(&cqe, wait_ms);
 
                 if (ret >= 0) {
                     // CQE available — process it
@@ -154,56 +150,29 @@ namespace hope::io::el {
                         uint64_t ud = io_uring_cqe_get_data64(cqe);
                         count++;
 
-                        int fd = uring::fd_of(ud);
-                        if (fd < 0 || (std::size_t)fd >= m_connections.size()) continue;
-
-                        // Error or EOF
-                        if (res < 0 && res != -EAGAIN) {
-                            remove_connection(fd);
+                        // Control tags first, fd_of would make a bogus descriptor of them
+                        if (ud == uring::tag_accept(m_listen_fd)) {
+                            m_accept_armed = false;
+                            if (res >= 0) {
+                                handle_accept(res);
+                            }
+                            rearm_accept();
                             continue;
                         }
-
-                        if (m_pending_handshakes.count(fd)) {
-                            retry_handshake(fd);
+                        if (m_key_offload && ud == uring::tag_wakeup(m_key_offload->fd())) {
+                            m_key_offload_armed = false;
+                            resume_signed_handshakes();
                             continue;
                         }
+                        if (ud == uring::tag_ignore) continue;
+
+                        int fd = uring::fd_of(ud);
+                        if (fd < 0 || (std::size_t)fd >= m_connections.size()) continue;
 
                         if (uring::is_recv(ud)) {
-                            // KTLS recv completion
-                            if (res > 0) {
-                                auto& cs = m_connections[fd];
-                                if (cs.op == active_op::recv_ktls) {
-                                    cs.op = active_op::none;
-                                    cs.conn.buffer->advance_tail((std::size_t)res);
-                                    auto state = m_on_read(cs.conn);
-                                    apply_state(cs.conn, state);
-                                }
-                            }
+                            on_recv_done(fd, res);
                         } else if (uring::is_send(ud)) {
-                            // KTLS send completion
-                            if (res > 0) {
-                                auto& cs = m_connections[fd];
-                                if (cs.op == active_op::send_ktls) {
-                                    cs.op = active_op::none;
-                                    cs.conn.buffer->advance_head((std::size_t)res);
-                                    if (cs.conn.buffer->is_empty()) {
-                                        auto state = m_on_write(cs.conn);
-                                        apply_state(cs.conn, state);
-                                    } else {
-                                        submit_send_ktls(fd);
-                                    }
-                                }
-                            }
-                        } else if (uring::is_poll_in(ud)) {
-                            auto& cs = m_connections[fd];
-                            if (cs.op == active_op::poll_in) {
-                                handle_read(cs.conn);
-                            }
-                        } else if (uring::is_poll_out(ud)) {
-                            auto& cs = m_connections[fd];
-                            if (cs.op == active_op::poll_out) {
-                                handle_write(cs.conn);
-                            }
+                            on_send_done(fd, res);
                         }
                     }
                     io_uring_cq_advance(&m_ring.impl, count);
@@ -212,25 +181,29 @@ namespace hope::io::el {
                     m_on_err(dumb, "uring_tls: io_uring_wait_cqe failed");
                     break;
                 }
-
-                // Always submit pending SQEs (even on timeout)
-                m_ring.submit();
+                m_timers.advance(timer_wheel::clock::now());
+                replay_deferred();
             }
-
-            // Cleanup
-            for (auto& cs : m_connections) {
-                if (cs.tls.ssl) {
-                    SSL_free(cs.tls.ssl);
-                    cs.tls.ssl = nullptr;
-                }
-                if (cs.conn.buffer) {
-                    m_pl.redeem(cs.conn.buffer);
-                    cs.conn.buffer = nullptr;
+            m_overflow.clear();
+
+            // Cleanup, tearing the ring down cancels whatever is still in flight
+            m_ring.exit();
+            for (std::size_t fd = 0; fd < m_connections.size(); ++fd) {
+                auto& cs = m_connections[fd];
+                if (cs.conn.descriptor == -1 && !cs.closing) continue;
+                m_timeouts.disarm((int32_t)fd);
+                release_ssl(cs);
+                if (cs.conn.buffer && cs.tls.ktls_active) {
+                    if (cs.recv_pending) cs.conn.buffer->unpin();
+                    if (cs.send_pending) cs.conn.buffer->unpin();
                 }
+                cs.recv_pending = cs.send_pending = false;
+                finish_close((int32_t)fd);
             }
-            m_pending_handshakes.clear();
-            ::close(epfd);
+            // Jobs hang off the SSLs, so the workers go after them
+            m_key_offload.reset();
             ::close(m_listen_fd);
+            m_listen_fd = -1;
         }
 
         void stop() override {
@@ -238,327 +211,559 @@ namespace hope::io::el {
         }
 
     private:
+        // One TLS record and then some: a RECV never returns less than a record's worth of room
+        constexpr static std::size_t cipher_chunk = 16 * 1024 + 512;
+
+        // What a handshake in progress waits for, none once the application has the connection
+        enum class handshake_wait : uint8_t {
+            none,
+            read,   // client flight, RECV armed
+            key,    // private key operation on a tls_key_offload worker
+            flush,  // done, the last server flight is still being sent
+        };
+
         struct tls_per_conn {
             SSL* ssl = nullptr;
+            BIO* rbio = nullptr;    // ciphertext received, owned by ssl
+            BIO* wbio = nullptr;    // ciphertext to send, owned by ssl
             bool ktls_active = false;
+            handshake_wait handshake = handshake_wait::none;
         };
 
-        enum class active_op : uint8_t {
-            none,
-            recv_ktls,
-            send_ktls,
-            poll_in,
-            poll_out,
-            handshake_poll,
+        enum class deferred_op : uint8_t {
+            accept,
+            recv,
+            send,
+        };
+
+        // recvmsg arguments of a kTLS RECV, read by the kernel while the op runs: kept off
+        // m_connections, which may reallocate meanwhile
+        struct ktls_rx {
+            msghdr msg{};
+            iovec iov{};
+            alignas(cmsghdr) unsigned char control[CMSG_SPACE(sizeof(unsigned char))];
         };
 
         struct conn_state {
             connection conn;
             tls_per_conn tls;
-            active_op op = active_op::none;
+            std::unique_ptr<ktls_rx> rx;            // allocated once kTLS is on for this fd
+            std::vector<unsigned char> cipher_in;   // RECV target, without kTLS
+            std::vector<unsigned char> cipher_out;  // taken from wbio, SEND in flight reads it
+            std::size_t cipher_sent = 0;
+            bool recv_pending = false;  // RECV submitted or deferred
+            bool send_pending = false;  // SEND submitted or deferred
+            bool closing = false;       // removed, the fd is closed once nothing is in flight
+
+            bool in_flight() const noexcept { return recv_pending || send_pending; }
         };
 
-        void apply_state(connection& conn, el_connection_state state) {
+        void apply_state(int32_t fd, el_connection_state state) {
+            auto& cs = m_connections[fd];
             if (state == el_connection_state::die) {
-                remove_connection(conn.descriptor);
+                remove_connection(fd);
                 return;
             }
-            conn.set_state(state);
+            cs.conn.set_state(state);
             if (state == el_connection_state::read) {
-                auto& cs = m_connections[conn.descriptor];
                 if (cs.tls.ktls_active) {
-                    submit_recv_ktls(conn.descriptor);
+                    submit_recv(fd);
                 } else {
-                    submit_poll_in(conn.descriptor);
+                    decrypt(fd);
                 }
             } else if (state == el_connection_state::write) {
-                auto& cs = m_connections[conn.descriptor];
                 if (cs.tls.ktls_active) {
-                    submit_send_ktls(conn.descriptor);
+                    if (cs.conn.buffer->is_empty()) {
+                        // Nothing to send at all
+                        apply_state(fd, m_on_write(cs.conn));
+                        return;
+                    }
+                    submit_send(fd);
                 } else {
-                    submit_poll_out(conn.descriptor);
+                    encrypt(fd);
                 }
             }
         }
 
-        void handle_accept() {
-            struct sockaddr_in client_addr{};
-            socklen_t socklen = sizeof(client_addr);
-            int sock = accept(m_listen_fd, (struct sockaddr*)&client_addr, &socklen);
-            if (sock < 0) return;
-
-            int flags = fcntl(sock, F_GETFL, 0);
-            if (flags == -1) { ::close(sock); return; }
-            flags |= O_NONBLOCK;
-            if (fcntl(sock, F_SETFL, flags) == -1) { ::close(sock); return; }
+        // ── Accept and handshake ─────────────────────────────────────────
+        void rearm_accept() {
+            if (m_accept_armed || m_listen_fd == -1) return;
+            auto* sqe = m_ring.get_sqe();
+            if (!sqe) {
+                m_overflow.defer((uint8_t)deferred_op::accept, m_listen_fd);
+                return;
+            }
+            io_uring_prep_accept(sqe, m_listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            io_uring_sqe_set_data64(sqe, uring::tag_accept(m_listen_fd));
+            m_accept_armed = true;
+        }
 
-            apply_stream_options(sock, m_cfg.accepted_stream_options);
+        void handle_accept(int32_t sock) {
+            NAMED_SCOPE(TlsUringAccept);
+            // Accepted with SOCK_NONBLOCK, only options the listener could not pass on are left
+            m_accept_options.apply(sock);
 
             SSL* ssl = SSL_new(m_ctx);
-            if (!ssl) { ::close(sock); return; }
-            SSL_set_fd(ssl, sock);
+            BIO* rbio = BIO_new(BIO_s_mem());
+            BIO* wbio = BIO_new(BIO_s_mem());
+            if (!ssl || !rbio || !wbio) {
+                if (ssl) SSL_free(ssl);
+                if (rbio) BIO_free(rbio);
+                if (wbio) BIO_free(wbio);
+                ::close(sock);
+                connection dumb;
+                m_on_err(dumb, "uring_tls: SSL_new failed");
+                return;
+            }
+            // Empty BIO reads as "retry", SSL reports WANT_READ instead of EOF
+            BIO_set_mem_eof_return(rbio, -1);
+            BIO_set_mem_eof_return(wbio, -1);
+            SSL_set_bio(ssl, rbio, wbio);
             SSL_set_accept_state(ssl);
+            SSL_set_app_data(ssl, (void*)(intptr_t)sock);
 
             if ((std::size_t)sock >= m_connections.size()) {
                 m_connections.resize(sock + 1);
             }
-
-            int ret = SSL_do_handshake(ssl);
-            if (ret == 1) {
-                register_connection(sock, ssl);
-                if (m_cfg.enable_ktls) {
-                    m_connections[sock].tls.ktls_active = try_enable_fd_ktls(ssl, sock, true);
-                }
-                auto state = m_on_connect(m_connections[sock].conn);
-                if (state == el_connection_state::die) {
-                    remove_connection(sock);
-                } else {
-                    apply_state(m_connections[sock].conn, state);
-                    handle_read(m_connections[sock].conn);
-                }
-            } else {
-                int err = SSL_get_error(ssl, ret);
-                if (err == SSL_ERROR_WANT_READ) {
-                    m_pending_handshakes.insert(sock);
-                    m_connections[sock].tls.ssl = ssl;
-                    m_connections[sock].conn.descriptor = sock;
-                    m_connections[sock].op = active_op::handshake_poll;
-                    submit_poll_in(sock);
-                } else {
-                    SSL_free(ssl);
-                    ::close(sock);
-                }
-            }
+            auto& cs = m_connections[sock];
+            cs.conn.descriptor = sock;
+            cs.conn.set_state(el_connection_state::idle);
+            cs.tls = { ssl, rbio, wbio, false, handshake_wait::read };
+            cs.cipher_in.resize(cipher_chunk);
+            cs.cipher_out.clear();
+            cs.cipher_sent = 0;
+            cs.recv_pending = cs.send_pending = cs.closing = false;
+            // One deadline for the whole handshake, progress does not extend it
+            m_timeouts.arm(sock, std::chrono::milliseconds(m_cfg.handshake_timeout_ms));
+            // The client speaks first, there is nothing to run SSL on yet
+            submit_recv(sock);
         }
 
-        void retry_handshake(int32_t fd) {
-            NAMED_SCOPE(TlsUringRetryHs);
+        void advance_handshake(int32_t fd) {
+            NAMED_SCOPE(TlsUringHandshake);
             auto& cs = m_connections[fd];
             int ret = SSL_do_handshake(cs.tls.ssl);
             if (ret == 1) {
-                m_pending_handshakes.erase(fd);
-                register_connection(fd, cs.tls.ssl);
-                if (m_cfg.enable_ktls) {
-                    cs.tls.ktls_active = try_enable_fd_ktls(cs.tls.ssl, fd, true);
-                }
-                auto state = m_on_connect(cs.conn);
-                if (state == el_connection_state::die) {
-                    remove_connection(fd);
-                } else {
-                    apply_state(cs.conn, state);
-                    handle_read(cs.conn);
+                cs.tls.handshake = handshake_wait::flush;
+                flush_cipher(fd);
+                if (!cs.send_pending) {
+                    establish(fd);
                 }
-            } else {
-                int err = SSL_get_error(cs.tls.ssl, ret);
-                if (err == SSL_ERROR_WANT_READ) {
-                    cs.op = active_op::handshake_poll;
-                    submit_poll_in(fd);
-                } else {
-                    SSL_free(cs.tls.ssl);
-                    cs.tls.ssl = nullptr;
-                    m_pending_handshakes.erase(fd);
-                    ::close(fd);
+                return;
+            }
+            switch (SSL_get_error(cs.tls.ssl, ret)) {
+                case SSL_ERROR_WANT_READ:
+                    cs.tls.handshake = handshake_wait::read;
+                    flush_cipher(fd);
+                    submit_recv(fd);
+                    break;
+                case SSL_ERROR_WANT_PRIVATE_KEY_OPERATION:
+                    cs.tls.handshake = handshake_wait::key;
+                    flush_cipher(fd);
+                    break;
+                default: {
                     connection dumb;
                     m_on_err(dumb, "uring_tls: handshake failed");
+                    remove_connection(fd);
+                    break;
                 }
             }
         }
 
-        void register_connection(int32_t sock, SSL* ssl) {
-            NAMED_SCOPE(TlsUringRegister);
-            auto& cs = m_connections[sock];
-            if (!cs.tls.ssl) {
-                cs.tls.ssl = ssl;
+        // Handshake done and its last flight on the wire: the application takes over
+        void establish(int32_t fd) {
+            auto& cs = m_connections[fd];
+            cs.tls.handshake = handshake_wait::none;
+            m_timeouts.disarm(fd);
+            m_timeouts.arm(fd, std::chrono::milliseconds(m_cfg.idle_timeout_ms));
+            // Ciphertext the client sent right behind its Finished is in rbio, the kernel
+            // would never see it
+            if (m_cfg.enable_ktls && BIO_ctrl_pending(cs.tls.rbio) == 0) {
+                cs.tls.ktls_active = try_enable_fd_ktls(cs.tls.ssl, fd, true);
+                if (cs.tls.ktls_active && !cs.rx) {
+                    cs.rx = std::make_unique<ktls_rx>();
+                }
             }
-            cs.conn.descriptor = sock;
             cs.conn.buffer = m_pl.allocate();
-            cs.op = active_op::none;
+            auto state = m_on_connect(cs.conn);
+            apply_state(fd, state);
         }
 
-        // ── I/O submissions ──────────────────────────────────────────────
-        void submit_poll_in(int32_t fd) {
-            if ((std::size_t)fd >= m_connections.size()) return;
-            auto& cs = m_connections[fd];
+        // ── Handshake key offload ────────────────────────────────────────
+        // One eventfd read in flight while handshakes sign on the workers. Without a free SQE
+        // it waits for the next tick, the counter keeps whatever was signalled meanwhile.
+        void arm_key_offload() {
+            if (!m_key_offload || m_key_offload_armed) return;
             auto* sqe = m_ring.get_sqe();
             if (!sqe) return;
-            io_uring_prep_poll_add(sqe, fd, POLLIN);
-            io_uring_sqe_set_data64(sqe, uring::tag_poll_in(fd));
-            cs.op = active_op::poll_in;
+            io_uring_prep_read(sqe, m_key_offload->fd(), &m_key_offload_counter, sizeof(m_key_offload_counter), 0);
+            io_uring_sqe_set_data64(sqe, uring::tag_wakeup(m_key_offload->fd()));
+            m_key_offload_armed = true;
         }
 
-        void submit_poll_out(int32_t fd) {
-            if ((std::size_t)fd >= m_connections.size()) return;
-            auto& cs = m_connections[fd];
-            auto* sqe = m_ring.get_sqe();
-            if (!sqe) return;
-            io_uring_prep_poll_add(sqe, fd, POLLOUT);
-            io_uring_sqe_set_data64(sqe, uring::tag_poll_out(fd));
-            cs.op = active_op::poll_out;
+        // The connection may have died while its key operation ran, the fd even reused
+        void resume_signed_handshakes() {
+            NAMED_SCOPE(TlsUringResumeSigned);
+            m_key_offload->drain([this](SSL* ssl) {
+                const auto fd = (int32_t)(intptr_t)SSL_get_app_data(ssl);
+                if (fd >= 0 && (std::size_t)fd < m_connections.size()
+                    && m_connections[fd].tls.ssl == ssl && m_connections[fd].tls.handshake == handshake_wait::key) {
+                    advance_handshake(fd);
+                }
+            });
         }
 
-        void submit_recv_ktls(int32_t fd) {
-            if ((std::size_t)fd >= m_connections.size()) return;
+        // ── Record layer in memory ───────────────────────────────────────
+        // Plaintext out of whatever ciphertext rbio holds; RECV for more when it runs dry
+        void decrypt(int32_t fd) {
+            NAMED_SCOPE(TlsUringDecrypt);
             auto& cs = m_connections[fd];
-            if (!cs.conn.buffer) return;
+            auto& conn = cs.conn;
+            if (conn.get_state() != el_connection_state::read) return;
 
-            auto [data, size] = cs.conn.buffer->get_free_region();
-            if (size == 0) return;
+            bool error = false;
+            bool closed = false;
+            bool got_data = false;
+            while (true) {
+                auto consumed = conn.buffer->consume_free([&](void* data, std::size_t size) -> std::size_t {
+                    ERR_clear_error();
+                    int received = SSL_read(cs.tls.ssl, data, (int)size);
+                    if (received > 0) {
+                        got_data = true;
+                        return (std::size_t)received;
+                    }
+                    int err = SSL_get_error(cs.tls.ssl, received);
+                    if (err == SSL_ERROR_ZERO_RETURN) {
+                        closed = true;
+                    } else if (err != SSL_ERROR_WANT_READ) {
+                        error = true;
+                    }
+                    return 0;
+                });
+                if (consumed == 0) break;
+            }
+            // Post-handshake messages (tickets, KeyUpdate) may owe the peer a reply
+            flush_cipher(fd);
 
-            auto* sqe = m_ring.get_sqe();
-            if (!sqe) return;
-            io_uring_prep_recv(sqe, fd, data, size, 0);
-            io_uring_sqe_set_data64(sqe, uring::tag_recv(fd));
-            cs.op = active_op::recv_ktls;
+            if (error) {
+                auto state = m_on_err(conn, "uring_tls: SSL_read failed");
+                apply_state(fd, state);
+            } else if (got_data) {
+                auto state = m_on_read(conn);
+                apply_state(fd, state);
+            } else if (closed) {
+                remove_connection(fd);
+            } else {
+                submit_recv(fd);
+            }
         }
 
-        void submit_send_ktls(int32_t fd) {
-            if ((std::size_t)fd >= m_connections.size()) return;
+        // The whole buffer into wbio, on_write once SEND has put all of it on the wire
+        void encrypt(int32_t fd) {
+            NAMED_SCOPE(TlsUringEncrypt);
             auto& cs = m_connections[fd];
-            if (!cs.conn.buffer) return;
-
-            auto [data, size] = cs.conn.buffer->get_used_region();
-            if (size == 0) return;
+            auto& conn = cs.conn;
+            if (conn.get_state() != el_connection_state::write) return;
 
-            auto* sqe = m_ring.get_sqe();
-            if (!sqe) return;
-            io_uring_prep_send(sqe, fd, data, size, 0);
-            io_uring_sqe_set_data64(sqe, uring::tag_send(fd));
-            cs.op = active_op::send_ktls;
+            bool error = false;
+            while (true) {
+                auto consumed = conn.buffer->consume_used([&](const void* data, std::size_t size) -> std::size_t {
+                    ERR_clear_error();
+                    int sent = SSL_write(cs.tls.ssl, data, (int)size);
+                    if (sent > 0) return (std::size_t)sent;
+                    error = true;
+                    return 0;
+                });
+                if (consumed == 0) break;
+            }
+            if (error) {
+                auto state = m_on_err(conn, "uring_tls: SSL_write failed");
+                apply_state(fd, state);
+                return;
+            }
+            flush_cipher(fd);
+            if (!cs.send_pending) {
+                // Nothing to send at all
+                auto state = m_on_write(conn);
+                apply_state(fd, state);
+            }
         }
 
-        // ── Read / Write handlers ────────────────────────────────────────
-        void handle_read(connection& conn) {
-            NAMED_SCOPE(TlsUringHandleRead);
-            if (conn.get_state() != el_connection_state::read) return;
+        // SEND whatever wbio holds, unless a SEND is in flight: its completion comes back here
+        void flush_cipher(int32_t fd) {
+            auto& cs = m_connections[fd];
+            if (cs.send_pending) return;
+            const auto pending = BIO_ctrl_pending(cs.tls.wbio);
+            if (pending == 0) return;
+            cs.cipher_out.resize(pending);
+            const int n = BIO_read(cs.tls.wbio, cs.cipher_out.data(), (int)pending);
+            cs.cipher_out.resize(n > 0 ? (std::size_t)n : 0);
+            cs.cipher_sent = 0;
+            if (!cs.cipher_out.empty()) {
+                submit_send(fd);
+            }
+        }
 
-            auto& cs = m_connections[conn.descriptor];
-            bool error = false;
-            bool got_data = false;
-            bool want_read = false;
+        // ── Completions ──────────────────────────────────────────────────
+        void on_recv_done(int32_t fd, int res) {
+            auto& cs = m_connections[fd];
+            if (!cs.recv_pending) return;
+            cs.recv_pending = false;
+            if (cs.tls.ktls_active) cs.conn.buffer->unpin();
+            if (cs.closing) {
+                if (!cs.in_flight()) finish_close(fd);
+                return;
+            }
+            if (res == -EAGAIN || res == -EINTR) {
+                submit_recv(fd);
+                return;
+            }
+            if (res <= 0) {
+                // EOF or reset
+                remove_connection(fd);
+                return;
+            }
+            m_timeouts.touch(fd);
 
             if (cs.tls.ktls_active) {
-                got_data = !conn.buffer->is_empty();
-            } else {
-                // Keep reading until SSL says WANT_READ (no more data available)
-                while (true) {
-                    auto consumed = conn.buffer->consume_free([&](void* data, std::size_t size) -> std::size_t {
-                        ERR_clear_error();
-                        int received = SSL_read(cs.tls.ssl, data, (int)size);
-                        if (received > 0) {
-                            got_data = true;
-                            return (std::size_t)received;
-                        }
+                // The kernel stops at record boundaries and tells each record's type
+                const auto type = record_type(*cs.rx);
+                if (type == 21) {
+                    // alert: close_notify or fatal, nothing follows either way
+                    remove_connection(fd);
+                    return;
+                }
+                if (type != 23) {
+                    // handshake: a server never gets a NewSessionTicket, so this is a client
+                    // KeyUpdate; the kernel keeps the old RX key and every later record fails
+                    m_on_err(cs.conn, "kTLS: KeyUpdate not supported");
+                    remove_connection(fd);
+                    return;
+                }
+                cs.conn.buffer->advance_tail((std::size_t)res);
+                auto state = m_on_read(cs.conn);
+                apply_state(fd, state);
+                return;
+            }
 
-                        int err = SSL_get_error(cs.tls.ssl, received);
-                        if (err == SSL_ERROR_WANT_READ) {
-                            want_read = true;
-                            return 0;
-                        }
-                        if (err == SSL_ERROR_ZERO_RETURN) {
-                            return 0;
-                        }
-                        error = true;
-                        return 0;
-                    });
-                    if (consumed == 0) break;
-                    want_read = false; // consumed data, try again
+            BIO_write(cs.tls.rbio, cs.cipher_in.data(), res);
+            if (cs.tls.handshake == handshake_wait::read) {
+                advance_handshake(fd);
+            } else if (cs.tls.handshake == handshake_wait::none) {
+                decrypt(fd);
+            }
+        }
+
+        void on_send_done(int32_t fd, int res) {
+            auto& cs = m_connections[fd];
+            if (!cs.send_pending) return;
+            cs.send_pending = false;
+            if (cs.tls.ktls_active) cs.conn.buffer->unpin();
+            if (cs.closing) {
+                if (!cs.in_flight()) finish_close(fd);
+                return;
+            }
+            if (res == -EAGAIN || res == -EINTR) {
+                submit_send(fd);
+                return;
+            }
+            if (res < 0) {
+                remove_connection(fd);
+                return;
+            }
+            m_timeouts.touch(fd);
+
+            if (cs.tls.ktls_active) {
+                cs.conn.buffer->advance_head((std::size_t)res);
+                if (!cs.conn.buffer->is_empty()) {
+                    submit_send(fd);
+                    return;
                 }
+                auto state = m_on_write(cs.conn);
+                apply_state(fd, state);
+                return;
             }
 
-            if (got_data && !error) {
-                auto state = m_on_read(conn);
-                apply_state(conn, state);
+            cs.cipher_sent += (std::size_t)res;
+            if (cs.cipher_sent < cs.cipher_out.size()) {
+                submit_send(fd);
+                return;
             }
-            if (error) {
-                remove_connection(conn.descriptor);
+            cs.cipher_out.clear();
+            cs.cipher_sent = 0;
+            flush_cipher(fd);
+            if (cs.send_pending) return;
+
+            if (cs.tls.handshake == handshake_wait::flush) {
+                establish(fd);
+            } else if (cs.tls.handshake == handshake_wait::none
+                       && cs.conn.get_state() == el_connection_state::write && cs.conn.buffer->is_empty()) {
+                auto state = m_on_write(cs.conn);
+                apply_state(fd, state);
             }
-            if (want_read && !got_data && !error) {
-                // SSL wants more data — resubmit poll_in
-                submit_poll_in(conn.descriptor);
+        }
+
+        // ── I/O submissions ──────────────────────────────────────────────
+        // ciphertext into cipher_in, or plaintext into the connection buffer under kTLS
+        void submit_recv(int32_t fd) {
+            auto& cs = m_connections[fd];
+            if (cs.recv_pending) return;
+            if (cs.tls.handshake == handshake_wait::none && read_buffer_full(fd)) return;
+            if (cs.tls.ktls_active) {
+                cs.conn.buffer->pin();
+            }
+            cs.recv_pending = true;
+            if (!prep_recv(fd)) {
+                m_overflow.defer((uint8_t)deferred_op::recv, fd);
             }
         }
 
-        void handle_write(connection& conn) {
-            NAMED_SCOPE(TlsUringHandleWrite);
-            if (conn.get_state() != el_connection_state::write) return;
+        void submit_send(int32_t fd) {
+            auto& cs = m_connections[fd];
+            if (cs.tls.ktls_active) {
+                if (cs.conn.buffer->is_empty()) return;
+                cs.conn.buffer->pin();
+            }
+            cs.send_pending = true;
+            if (!prep_send(fd)) {
+                m_overflow.defer((uint8_t)deferred_op::send, fd);
+            }
+        }
+
+        bool prep_recv(int32_t fd) {
+            auto& cs = m_connections[fd];
+            auto* sqe = m_ring.get_sqe();
+            if (!sqe) return false;
+            if (cs.tls.ktls_active) {
+                auto [data, size] = cs.conn.buffer->get_free_region();
+                auto& rx = *cs.rx;
+                rx.iov = { data, size };
+                rx.msg = {};
+                rx.msg.msg_iov = &rx.iov;
+                rx.msg.msg_iovlen = 1;
+                std::memset(rx.control, 0, sizeof(rx.control));
+                rx.msg.msg_control = rx.control;
+                rx.msg.msg_controllen = sizeof(rx.control);
+                io_uring_prep_recvmsg(sqe, fd, &rx.msg, 0);
+            } else {
+                io_uring_prep_recv(sqe, fd, cs.cipher_in.data(), cs.cipher_in.size(), 0);
+            }
+            io_uring_sqe_set_data64(sqe, uring::tag_recv(fd));
+            return true;
+        }
 
-            auto& cs = m_connections[conn.descriptor];
+        // TLS_GET_RECORD_TYPE of a completed kTLS RECV, application_data if the kernel sent none
+        static unsigned char record_type(const ktls_rx& rx) {
+            const auto* cmsg = CMSG_FIRSTHDR(&rx.msg);
+            if (cmsg == nullptr || cmsg->cmsg_level != SOL_TLS || cmsg->cmsg_type != TLS_GET_RECORD_TYPE) {
+                return 23;
+            }
+            return *CMSG_DATA(cmsg);
+        }
 
+        // The application asks for more input with no room left: every byte in the buffer
+        // went through on_read already. Receiving more would stall under kTLS and only pile
+        // ciphertext up in rbio without it, the connection fails instead.
+        bool read_buffer_full(int32_t fd) {
+            auto& cs = m_connections[fd];
+            if (cs.conn.buffer->count() < tiered_buffer::max_capacity) return false;
+            m_on_err(cs.conn, "uring_tls: read buffer full, close connection");
+            remove_connection(fd);
+            return true;
+        }
+
+        bool prep_send(int32_t fd) {
+            auto& cs = m_connections[fd];
+            auto* sqe = m_ring.get_sqe();
+            if (!sqe) return false;
             if (cs.tls.ktls_active) {
-                // KTLS: sink the data with raw send
-                bool error = false;
-                while (true) {
-                    auto consumed = conn.buffer->consume_used([&](const void* data, std::size_t size) -> std::size_t {
-                        auto sent = ::send(conn.descriptor, (const char*)data, size, 0);
-                        if (sent > 0) return (std::size_t)sent;
-                        if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                            return 0;
-                        }
-                        error = true;
-                        return size;
-                    });
-                    if (consumed == 0) break;
+                auto [data, size] = cs.conn.buffer->get_used_region();
+                io_uring_prep_send(sqe, fd, data, size, MSG_NOSIGNAL);
+            } else {
+                io_uring_prep_send(sqe, fd, cs.cipher_out.data() + cs.cipher_sent,
+                                   cs.cipher_out.size() - cs.cipher_sent, MSG_NOSIGNAL);
+            }
+            io_uring_sqe_set_data64(sqe, uring::tag_send(fd));
+            return true;
+        }
+
+        // ── SQ overflow ──────────────────────────────────────────────────
+        // A deferred op counts as in flight, replay submits it or lets a closing connection go
+        void replay_deferred() {
+            m_overflow.replay([this](uint8_t raw, int32_t fd) {
+                auto op = (deferred_op)raw;
+                if (op == deferred_op::accept) {
+                    rearm_accept();
+                    return;
                 }
-                if (!error && conn.buffer->is_empty()) {
-                    auto state = m_on_write(conn);
-                    apply_state(conn, state);
+                auto& cs = m_connections[fd];
+                bool& pending = op == deferred_op::recv ? cs.recv_pending : cs.send_pending;
+                if (!pending) return;
+                if (cs.closing) {
+                    pending = false;
+                    if (cs.tls.ktls_active && cs.conn.buffer) cs.conn.buffer->unpin();
+                    if (!cs.in_flight()) finish_close(fd);
+                    return;
                 }
-                if (error) {
-                    m_on_err(conn, "KTLS write failed");
-                    apply_state(conn, el_connection_state::die);
-                }
-            } else {
-                bool error = false;
-                bool want_write = false;
-                // Keep writing until SSL says WANT_WRITE or buffer is empty
-                while (true) {
-                    auto consumed = conn.buffer->consume_used([&](const void* data, std::size_t size) -> std::size_t {
-                        ERR_clear_error();
-                        int sent = SSL_write(cs.tls.ssl, data, (int)size);
-                        if (sent > 0) return (std::size_t)sent;
-
-                        int err = SSL_get_error(cs.tls.ssl, sent);
-                        if (err == SSL_ERROR_WANT_WRITE) {
-                            want_write = true;
-                            return 0;
-                        }
-                        error = true;
-                        return size;
-                    });
-                    if (consumed == 0) break;
-                    want_write = false;
+                if (!(op == deferred_op::recv ? prep_recv(fd) : prep_send(fd))) {
+                    m_overflow.defer(raw, fd);
                 }
+            });
+        }
 
-                if (error) {
-                    auto err_state = m_on_err(conn, "SSL_write failed");
-                    apply_state(conn, err_state);
-                } else if (conn.buffer->is_empty()) {
-                    auto state = m_on_write(conn);
-                    apply_state(conn, state);
-                } else if (want_write) {
-                    // SSL wants more room — resubmit poll_out
-                    submit_poll_out(conn.descriptor);
-                }
+        // ── Connection management ────────────────────────────────────────
+        // Handshake deadline or idle timeout
+        void expire(int32_t fd) {
+            auto& cs = m_connections[fd];
+            if (cs.conn.descriptor != fd || cs.closing) return;
+            if (cs.tls.handshake != handshake_wait::none) {
+                remove_connection(fd);
+                connection dumb;
+                m_on_err(dumb, "uring_tls: handshake timeout");
+                return;
             }
+            m_on_err(cs.conn, "uring_tls: idle timeout, close connection");
+            remove_connection(fd);
+        }
+
+        void release_ssl(conn_state& cs) {
+            if (cs.tls.ssl) {
+                SSL_free(cs.tls.ssl); // frees both BIOs, drops a key operation still running
+            }
+            const bool ktls = cs.tls.ktls_active;
+            cs.tls = {};
+            cs.tls.ktls_active = ktls; // in-flight kTLS ops still pin the connection buffer
         }
 
-        // ── Connection management ────────────────────────────────────────
         void remove_connection(int32_t fd) {
             NAMED_SCOPE(TlsUringRemove);
             if ((std::size_t)fd >= m_connections.size()) return;
             auto& cs = m_connections[fd];
-
-            if (cs.tls.ssl) {
-                SSL_free(cs.tls.ssl);
-                cs.tls.ssl = nullptr;
+            if (cs.conn.descriptor != fd || cs.closing) return;
+            m_timeouts.disarm(fd);
+            release_ssl(cs);
+            cs.conn.descriptor = -1;
+            if (cs.in_flight()) {
+                // RECV and SEND still reference the socket and the buffers; shutdown makes
+                // them complete, the last completion closes the fd
+                ::shutdown(fd, SHUT_RDWR);
+                cs.closing = true;
+                return;
             }
-            m_pending_handshakes.erase(fd);
+            finish_close(fd);
+        }
 
+        void finish_close(int32_t fd) {
+            auto& cs = m_connections[fd];
             if (cs.conn.buffer) {
                 m_pl.redeem(cs.conn.buffer);
                 cs.conn.buffer = nullptr;
             }
-            cs.op = active_op::none;
+            cs.conn.descriptor = -1;
+            cs.tls = {};
+            cs.cipher_out.clear();
+            cs.cipher_sent = 0;
+            cs.closing = false;
             ::close(fd);
         }
 
@@ -575,14 +780,21 @@ namespace hope::io::el {
         }
 
         uring::ring m_ring;
+        uring::sqe_overflow m_overflow;
         int32_t m_listen_fd = -1;
+        bool m_accept_armed = false;
+        socket_option_list m_accept_options;
         SSL_CTX* m_ctx = nullptr;
+        std::unique_ptr<tls_key_offload> m_key_offload;
+        uint64_t m_key_offload_counter = 0;
+        bool m_key_offload_armed = false;
 
         tls_config m_cfg;
         buffer_pool m_pl;
+        timer_wheel m_timers;
+        descriptor_timeouts m_timeouts{ m_timers, [this](int32_t fd) { expire(fd); } };
 
         std::vector<conn_state> m_connections;
-        std::unordered_set<int32_t> m_pending_handshakes;
         std::atomic<bool> m_running = true;
         TOnError m_on_err;
         TOnWrite m_on_write;
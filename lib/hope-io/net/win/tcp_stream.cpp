@@ -253,7 +253,11 @@ namespace hope::io {
     }
 
     void tcp_stream::stream_in(std::string& buffer) {
-        assert(false && "Not implemented");
+        // Everything up to the peer's close
+        char chunk[16 * 1024];
+        while (const auto received = read_once(chunk, sizeof(chunk))) {
+            buffer.append(chunk, received);
+        }
     }
 
 
@@ -0,0 +1,103 @@
+/* Copyright (C) 2026 Gleb Bezborodov - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: bezborodoff.gleb@gmail.com, or visit : https://github.com/glensand/hope-io
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace hope::io::el {
+
+    // Bytes handed to an event loop's send_zero_copy(). The loop keeps owner alive until
+    // the kernel reports it no longer reads the pages, the memory must not change meanwhile.
+    struct zc_buffer final {
+        std::shared_ptr<const void> owner;
+        const void* data = nullptr;
+        std::size_t size = 0;
+
+        static zc_buffer from(std::vector<unsigned char> bytes) {
+            auto holder = std::make_shared<const std::vector<unsigned char>>(std::move(bytes));
+            return { holder, holder->data(), holder->size() };
+        }
+    };
+
+    // Zero-copy segments of one connection, interleaved with its tx ring in call order:
+    // each segment remembers how many ring bytes were queued ahead of it.
+    struct zc_queue final {
+        struct segment {
+            zc_buffer buffer;
+            std::size_t offset = 0;         // bytes already handed to the kernel
+            std::size_t ring_before = 0;    // tx ring bytes to send before this segment
+            uint32_t last_seq = 0;          // MSG_ZEROCOPY: sequence of the last send() call
+            bool zero_copy = false;         // sent with MSG_ZEROCOPY / SEND_ZC, wait for notification
+        };
+
+        void push(zc_buffer buffer, std::size_t ring_count) {
+            std::size_t accounted = 0;
+            for (auto& s : pending) accounted += s.ring_before;
+            pending.push_back({ std::move(buffer), 0, ring_count - accounted });
+        }
+
+        // Ring bytes that may go out before the next segment
+        std::size_t ring_budget() const noexcept {
+            return pending.empty() ? std::numeric_limits<std::size_t>::max() : pending.front().ring_before;
+        }
+
+        void on_ring_sent(std::size_t n) noexcept {
+            if (!pending.empty()) pending.front().ring_before -= n;
+        }
+
+        // Front segment is fully handed to the kernel
+        void on_segment_sent() {
+            auto s = std::move(pending.front());
+            pending.pop_front();
+            if (s.zero_copy) {
+                in_flight.push_back(std::move(s));
+            }
+        }
+
+        // MSG_ZEROCOPY notification covering sequences up to hi (inclusive, wrapping)
+        void release_through(uint32_t hi) {
+            while (!in_flight.empty() && int32_t(in_flight.front().last_seq - hi) <= 0) {
+                in_flight.pop_front();
+            }
+        }
+
+        // SEND_ZC: the sequence of a request whose first CQE promised a notification
+        uint32_t expect_notification() noexcept { return next_seq++; }
+
+        // SEND_ZC notification CQE, notifications of one socket complete in order
+        void on_notification() {
+            release_through(notified++);
+        }
+
+        bool awaiting_notifications() const noexcept { return next_seq != notified || !in_flight.empty(); }
+
+        bool empty() const noexcept { return pending.empty(); }
+
+        void clear() {
+            pending.clear();
+            in_flight.clear();
+            next_seq = 0;
+            notified = 0;
+            so_zerocopy = -1;
+            lingering = false;
+        }
+
+        std::deque<segment> pending;
+        std::deque<segment> in_flight;
+        uint32_t next_seq = 0;
+        uint32_t notified = 0;    // io_uring: notification CQEs seen so far
+        int8_t so_zerocopy = -1;  // epoll: SO_ZEROCOPY state, -1 unknown, 0 unsupported, 1 on
+        bool lingering = false;   // epoll: connection removed, the socket stays open until in_flight drains
+    };
+
+}
@@ -0,0 +1,159 @@
+/* Copyright (C) 2026 Gleb Bezborodov - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: bezborodoff.gleb@gmail.com, or visit : https://github.com/glensand/hope-io
+ */
+
+#pragma once
+
+#include "hope-io/coredefs.h"
+#if PLATFORM_LINUX || PLATFORM_APPLE
+#include "hope-io/net/nix/tcp_stream.h"
+#include <cerrno>
+#include <sys/socket.h>
+#elif PLATFORM_WINDOWS
+#include "hope-io/net/win/tcp_stream.h"
+#endif
+#include "hope-io/net/tls/tcp_tls_stream.h"
+#include "hope-io/net/stream.h"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace hope::io::http {
+
+    struct pool_options final {
+        std::size_t max_idle_per_host = 4;
+        // Kept below common server keep-alive timeouts (nginx 75 s, Apache 5 s are the
+        // extremes); a connection the server dropped earlier is caught on reuse anyway
+        std::chrono::milliseconds idle_timeout = std::chrono::seconds(15);
+        stream_options stream;
+    };
+
+    // Idle keep-alive connections per scheme://host:port. New TLS connections resume through
+    // tls_session_cache instead of running a full handshake.
+    class connection_pool final {
+    public:
+        struct connection final {
+            std::unique_ptr<hope::io::stream> stream;
+            std::string key;
+            bool reused = false;    // came from the idle list, the server may have closed it since
+        };
+
+        struct stats final {
+            uint64_t connects = 0;
+            uint64_t reuses = 0;
+            uint64_t resumed = 0;   // TLS connects that skipped the full handshake
+        };
+
+        explicit connection_pool(pool_options options = {})
+            : m_options(std::move(options)) {}
+
+        connection_pool(const connection_pool&) = delete;
+        connection_pool& operator=(const connection_pool&) = delete;
+
+        connection acquire(bool tls, const std::string& host, int port) {
+            connection c;
+            c.key = (tls ? "https://" : "http://") + host + ":" + std::to_string(port);
+            std::vector<idle_connection> stale; // closed after the lock is released
+            {
+                std::lock_guard lock(m_lock);
+                auto& idle = m_idle[c.key];
+                const auto now = clock::now();
+                while (!idle.empty()) {
+                    auto candidate = std::move(idle.back());
+                    idle.pop_back();
+                    if (now - candidate.since < m_options.idle_timeout && alive(*candidate.s, tls)) {
+                        ++m_stats.reuses;
+                        c.stream = std::move(candidate.s);
+                        c.reused = true;
+                        return c;
+                    }
+                    stale.push_back(std::move(candidate));
+                }
+            }
+
+            if (!tls) {
+                c.stream = std::make_unique<tcp_stream>(static_cast<unsigned long long>(-1), m_options.stream);
+                c.stream->connect(host, (std::size_t)port);
+            } else {
+                auto s = std::make_unique<tcp_tls_stream>(nullptr, m_options.stream);
+                s->connect(host, (std::size_t)port);
+                if (s->session_reused()) {
+                    std::lock_guard lock(m_lock);
+                    ++m_stats.resumed;
+                }
+                c.stream = std::move(s);
+            }
+            std::lock_guard lock(m_lock);
+            ++m_stats.connects;
+            return c;
+        }
+
+        // keep_alive: the response was read completely and the server did not ask to close
+        void release(connection&& c, bool keep_alive) {
+            if (!c.stream || !keep_alive) return;
+            std::lock_guard lock(m_lock);
+            auto& idle = m_idle[c.key];
+            if (idle.size() >= m_options.max_idle_per_host) {
+                idle.erase(idle.begin()); // the oldest is the likeliest to be timed out by the server
+            }
+            idle.push_back({ std::move(c.stream), clock::now() });
+        }
+
+        // Closes idle connections; TLS sessions stay in tls_session_cache
+        void clear() {
+            std::unordered_map<std::string, std::vector<idle_connection>> dropped;
+            std::lock_guard lock(m_lock);
+            dropped.swap(m_idle);
+        }
+
+        stats get_stats() const {
+            std::lock_guard lock(m_lock);
+            return m_stats;
+        }
+
+        // Behind hope::io::http::get/post/upload_file
+        static connection_pool& shared() {
+            static connection_pool instance;
+            return instance;
+        }
+
+    private:
+        using clock = std::chrono::steady_clock;
+
+        struct idle_connection final {
+            std::unique_ptr<hope::io::stream> s;
+            clock::time_point since;
+        };
+
+        // An idle HTTP connection has nothing to read: EOF means the server closed it and
+        // stray bytes would desync the next response. TLS may still hold post-handshake
+        // records (session tickets), so there only EOF counts.
+        static bool alive(hope::io::stream& s, bool tls) {
+#if PLATFORM_LINUX || PLATFORM_APPLE
+            char probe;
+            const auto n = ::recv(s.platform_socket(), &probe, 1, MSG_PEEK | MSG_DONTWAIT);
+            if (n == 0) return false;
+            if (n < 0) return errno == EAGAIN || errno == EWOULDBLOCK;
+            return tls;
+#else
+            (void)s; (void)tls;
+            return true;
+#endif
+        }
+
+        pool_options m_options;
+        std::unordered_map<std::string, std::vector<idle_connection>> m_idle;
+        stats m_stats;
+        mutable std::mutex m_lock;
+    };
+
+}
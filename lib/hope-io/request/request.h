@@ -18,12 +18,17 @@
 #endif
 #include "hope-io/net/tls/tcp_tls_stream.h"
 #include "hope-io/net/stream.h"
+#include "hope-io/request/connection_pool.h"
+#include "hope-io/request/response_parser.h"
+#include <algorithm>
 #include <format>
-#include <fstream>
+#include <span>
 #include <string>
+#include <string_view>
 #include <regex>
 #include <stdexcept>
 #include <utility>
+#include <vector>
 #include <sstream>
 
 namespace hope::io::http {
@@ -70,20 +75,130 @@ namespace hope::io::http {
         return parts;
     }
 
+    // Parsed response whose body went to the caller's sink (empty body) or was collected
+    struct response final {
+        int status = 0;
+        std::vector<std::pair<std::string, std::string>> headers;
+        std::string body;
+
+        // First header with this name, case-insensitive
+        [[nodiscard]] const std::string* header(std::string_view name) const {
+            for (auto& [k, v] : headers) {
+                if (iequals(k, name)) return &v;
+            }
+            return nullptr;
+        }
+    };
+
+    namespace detail {
+
+        // Reads one response off s into parser, body spans go to on_body straight from the
+        // read buffer. received turns true with the first byte. Returns true if the
+        // connection can carry the next request.
+        template <typename TOnBody>
+        bool read_response(hope::io::stream& s, response_parser& parser, TOnBody&& on_body, bool& received) {
+            char chunk[16 * 1024];
+            bool overrun = false;
+            while (!parser.done()) {
+                const auto n = s.read_once(chunk, sizeof(chunk));
+                if (n == 0) {
+                    if (parser.finish()) break;
+                    throw std::runtime_error(!received ? "hope-io/http: connection closed before response"
+                                                       : "hope-io/http: connection closed inside response");
+                }
+                received = true;
+                // Nothing is pipelined, bytes past the response mean the stream is out of sync
+                overrun = parser.feed({ chunk, n }, on_body) < n;
+            }
+            return parser.keep_alive() && !overrun;
+        }
+
+        // Sends a request over a pooled connection and parses the response. A reused connection
+        // that the server closed while it sat idle fails before any response byte arrives;
+        // the request then goes out again on a new connection. no_body: a HEAD request.
+        template <typename TSend, typename TOnBody>
+        void perform(const url_t& url, TSend&& send, response_parser& parser, TOnBody&& on_body,
+                     bool no_body = false) {
+            auto& pool = connection_pool::shared();
+            while (true) {
+                auto c = pool.acquire(url.protocol != "http", url.hostname, url.port);
+                parser.reset(no_body);
+                bool received = false;
+                try {
+                    send(*c.stream);
+                    const auto keep_alive = read_response(*c.stream, parser, on_body, received);
+                    pool.release(std::move(c), keep_alive);
+                    return;
+                } catch (const std::exception&) {
+                    if (!c.reused || received) throw;
+                }
+            }
+        }
+
+        // Status line and headers as received followed by the de-chunked body, what
+        // get/post/upload_file return
+        template <typename TSend>
+        std::string perform_raw(const url_t& url, TSend&& send) {
+            response_parser parser;
+            std::string body;
+            perform(url, send, parser, [&](std::span<const char> part) { body.append(part.data(), part.size()); });
+            body.insert(0, parser.head());
+            return body;
+        }
+    }
+
+    // method to endpoint with payload as the body (none if empty). The body goes to
+    // on_body(std::span<const char>) piece by piece as it arrives, so memory stays bounded
+    // by the read buffer however large the response is.
+    template <typename TOnBody>
+    response fetch(std::string_view method, const std::string& endpoint, std::string_view payload,
+        const std::string& header_data, TOnBody&& on_body) {
+        auto url = extract_url(endpoint);
+        auto request_header = std::format("{} {} HTTP/1.1\r\n"
+                                          "Host: {}\r\n"
+                                          "Connection: keep-alive\r\n",
+                                          method,
+                                          url.path,
+                                          url.hostname);
+        if (!payload.empty()) {
+            request_header += "Content-Length: " + std::to_string(payload.size()) + "\r\n";
+        }
+        request_header += header_data;
+        request_header += "\r\n";
+
+        response_parser parser;
+        detail::perform(url, [&](hope::io::stream& stream) {
+            std::span<const char> parts[] = { request_header, payload };
+            stream.write_v({ parts, payload.empty() ? 1u : 2u });
+        }, parser, on_body, method == "HEAD");
+
+        response out;
+        out.status = parser.status();
+        out.headers.reserve(parser.headers().size());
+        for (auto& h : parser.headers()) {
+            out.headers.emplace_back(h.name, h.value);
+        }
+        return out;
+    }
+
+    // fetch with the body collected into response::body
+    inline response fetch(std::string_view method, const std::string& endpoint, std::string_view payload = {},
+        const std::string& header_data = {}) {
+        std::string body;
+        auto out = fetch(method, endpoint, payload, header_data,
+            [&](std::span<const char> part) { body.append(part.data(), part.size()); });
+        out.body = std::move(body);
+        return out;
+    }
+
     inline std::string post(const std::string& endpoint, const std::string& payload, 
         const std::string& header_data = {}) {
         auto url = extract_url(endpoint);
-        hope::io::stream* stream = nullptr;
-        if (url.protocol == "http") {
-            stream = new hope::io::tcp_stream();
-        } else {
-            stream = new hope::io::tcp_tls_stream();
-        }
         auto request_header = std::format("POST {} HTTP/1.1\r\n"
                                              "Host: {}\r\n"
                                              "Content-Type: application/json;charset=UTF-8\r\n"
                                              "Content-Length: {}\r\n"
-                                             "Connection: close\r\n",
+                                             "Connection: keep-alive\r\n",
                                              url.path,
                                              url.hostname,
                                              std::to_string(payload.size()));
@@ -92,25 +207,15 @@ namespace hope::io::http {
             request_header += header_data;
         }
         request_header += "\r\n";
-        stream->connect(url.hostname, url.port);
-        stream->write(request_header.data(), request_header.size());
-        stream->write(payload.data(), payload.size());
-        std::string buffer;
-        stream->stream_in(buffer);
-        stream->disconnect();
-        delete stream;
-        return buffer;
+        return detail::perform_raw(url, [&](hope::io::stream& stream) {
+            stream.write(request_header.data(), request_header.size());
+            stream.write(payload.data(), payload.size());
+        });
     }
 
     inline std::string get(const std::string& endpoint, const std::vector<std::pair<std::string, std::string>>& params, 
         const std::string& header_data = {}) {
         auto url = extract_url(endpoint);
-        hope::io::stream* stream = nullptr;
-        if (url.protocol == "http") {
-            stream = new hope::io::tcp_stream();
-        } else {
-            stream = new hope::io::tcp_tls_stream();
-        }
         std::string body;
         for (auto&& [k, v] : params) {
             body+= k;
@@ -124,14 +229,10 @@ namespace hope::io::http {
             "GET " + url.path + "?" + body +  " HTTP/1.1\r\n" +
             "Host: " + url.hostname + "\r\n" +
             header_data + 
-            "Connection: close\r\n\r\n";
-        stream->connect(url.hostname, url.port);
-        stream->write(request.data(), request.size());
-        std::string buffer;
-        stream->stream_in(buffer);
-        stream->disconnect();
-        delete stream;
-        return buffer;
+            "Connection: keep-alive\r\n\r\n";
+        return detail::perform_raw(url, [&](hope::io::stream& stream) {
+            stream.write(request.data(), request.size());
+        });
     }
 
     inline std::string build_http_request(
@@ -161,7 +262,7 @@ namespace hope::io::http {
         request << "Host: " << host << "\r\n";
         request << "Content-Type: multipart/form-data; boundary=" << boundary << "\r\n";
         request << "Content-Length: " << body.size() << "\r\n";
-        request << "Connection: close\r\n\r\n";
+        request << "Connection: keep-alive\r\n\r\n";
         request << body;
 
         return request.str(); // ready to be sent over socket
@@ -170,21 +271,10 @@ namespace hope::io::http {
     inline std::string upload_file(const std::string& endpoint, std::string_view payload,
         const std::string& file_name) {
         auto url = extract_url(endpoint);
-        hope::io::stream* stream = nullptr;
-        if (url.protocol == "http") {
-            stream = new hope::io::tcp_stream();
-        } else {
-            stream = new hope::io::tcp_tls_stream();
-        }
         auto req = build_http_request(url.path, url.hostname, file_name, payload);
-        stream->connect(url.hostname, url.port);
-        stream->write(req.data(), req.size());
-   
-        std::string buffer;
-        stream->stream_in(buffer);
-        stream->disconnect();
-        delete stream;
-        return buffer;
+        return detail::perform_raw(url, [&](hope::io::stream& stream) {
+            stream.write(req.data(), req.size());
+        });
     }
 
     inline std::string upload_file_2(const std::string& endpoint, const std::string& path , const std::string& file_name) {
@@ -192,12 +282,6 @@ namespace hope::io::http {
             throw std::runtime_error("File not found: " + file_name);
         }
         auto url = extract_url(endpoint);
-        hope::io::stream* stream = nullptr;
-        if (url.protocol == "http") {
-            stream = new hope::io::tcp_stream();
-        } else {
-            stream = new hope::io::tcp_tls_stream();
-        }
 
         const std::string boundary = "----MyBoundary7d7b3d"; // can be more random
         std::string body_part1;
@@ -223,7 +307,7 @@ namespace hope::io::http {
             body_part2 = bodystream.str();
         }
 
-        const auto file_size = std::filesystem::file_size(file_name);
+        const auto file_size = std::filesystem::file_size(path);
         const auto body_size = body_part1.size() + body_part2.size() + file_size;
 
         std::string request_header;
@@ -233,32 +317,16 @@ namespace hope::io::http {
             request << "Host: " << url.hostname << "\r\n";
             request << "Content-Type: multipart/form-data; boundary=" << boundary << "\r\n";
             request << "Content-Length: " << body_size << "\r\n";
-            request << "Connection: close\r\n\r\n";
+            request << "Connection: keep-alive\r\n\r\n";
             request_header = request.str();
         }
 
-        stream->connect(url.hostname, url.port);
-        stream->write(request_header.data(), request_header.size());
-        stream->write(body_part1.data(), body_part1.size());
-
-        {
-            std::ifstream in(path, std::ios::binary);
-            std::size_t read_size = 0;
-            constexpr auto buffer_size = 655360;
-            char buffer[buffer_size];
-            while (read_size < file_size) {
-                in.read(buffer, buffer_size);
-                const auto current_read = in.gcount();
-                stream->write(buffer, current_read);
-                read_size += current_read;
-            }
-        }
-        stream->write(body_part2.data(), body_part2.size());
+        return detail::perform_raw(url, [&](hope::io::stream& stream) {
+            stream.write(request_header.data(), request_header.size());
+            stream.write(body_part1.data(), body_part1.size());
 
-        std::string buffer;
-        stream->stream_in(buffer);
-        stream->disconnect();
-        delete stream;
-        return buffer;
+            stream.write_file(path, 0, file_size);
+            stream.write(body_part2.data(), body_part2.size());
+        });
     }
 }
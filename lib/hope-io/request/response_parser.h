@@ -0,0 +1,289 @@
+/* Copyright (C) 2026 Gleb Bezborodov - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: bezborodoff.gleb@gmail.com, or visit : https://github.com/glensand/hope-io
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace hope::io::http {
+
+    struct header final {
+        std::string_view name;
+        std::string_view value;
+    };
+
+    inline bool iequals(std::string_view a, std::string_view b) {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(),
+            [](unsigned char l, unsigned char r) { return std::tolower(l) == std::tolower(r); });
+    }
+
+    // Comma separated header value (Connection, Transfer-Encoding) lists token
+    inline bool has_token(std::string_view value, std::string_view token) {
+        while (!value.empty()) {
+            auto comma = value.find(',');
+            auto item = value.substr(0, comma);
+            while (!item.empty() && std::isspace((unsigned char)item.front())) item.remove_prefix(1);
+            while (!item.empty() && std::isspace((unsigned char)item.back())) item.remove_suffix(1);
+            if (iequals(item, token)) return true;
+            if (comma == std::string_view::npos) break;
+            value.remove_prefix(comma + 1);
+        }
+        return false;
+    }
+
+    // Incremental HTTP/1.1 response parser. Bytes go in as they arrive, in pieces of any size;
+    // the status line and headers are kept (they are small) and exposed as views, the body is
+    // handed to on_body as spans into the caller's buffer, chunked framing already removed.
+    // Malformed input throws std::runtime_error.
+    class response_parser final {
+    public:
+        explicit response_parser(std::size_t max_header_size = 64 * 1024)
+            : m_max_header_size(max_header_size) {}
+
+        // headers() and reason() point into the parser
+        response_parser(const response_parser&) = delete;
+        response_parser& operator=(const response_parser&) = delete;
+
+        // Consumes bytes of the current response and returns how many. Fewer than data.size()
+        // only once done(): the rest was sent after the response ended.
+        template <typename TOnBody>
+        std::size_t feed(std::span<const char> data, TOnBody&& on_body) {
+            std::size_t pos = 0;
+            while (pos < data.size() && m_state != state::done) {
+                auto rest = data.subspan(pos);
+                switch (m_state) {
+                case state::head:
+                    pos += feed_head(rest);
+                    break;
+                case state::fixed: {
+                    auto n = (std::size_t)std::min<uint64_t>(m_remaining, rest.size());
+                    on_body(rest.first(n));
+                    pos += n;
+                    m_remaining -= n;
+                    if (m_remaining == 0) m_state = state::done;
+                    break;
+                }
+                case state::until_close:
+                    on_body(rest);
+                    pos = data.size();
+                    break;
+                case state::chunk_size:
+                case state::trailer:
+                    pos += feed_line(rest);
+                    break;
+                case state::chunk_data: {
+                    auto n = (std::size_t)std::min<uint64_t>(m_remaining, rest.size());
+                    on_body(rest.first(n));
+                    pos += n;
+                    m_remaining -= n;
+                    if (m_remaining == 0) m_state = state::chunk_end;
+                    break;
+                }
+                case state::chunk_end:
+                    // CRLF after the chunk data, possibly split between two reads
+                    if (rest[0] != (m_remaining == 0 ? '\r' : '\n')) fail("missing CRLF after chunk");
+                    ++pos;
+                    if (m_remaining++ == 1) {
+                        m_remaining = 0;
+                        m_state = state::chunk_size;
+                    }
+                    break;
+                case state::done:
+                    break;
+                }
+            }
+            return pos;
+        }
+
+        // The peer closed the connection. Completes a body delimited by the close, returns
+        // false if the response was cut short.
+        bool finish() {
+            if (m_state == state::until_close) m_state = state::done;
+            return m_state == state::done;
+        }
+
+        // Ready for the next response on the same connection. no_body: the response answers
+        // a HEAD request, it ends with the headers whatever Content-Length says
+        void reset(bool no_body = false) {
+            m_head.clear();
+            m_line.clear();
+            m_headers.clear();
+            m_reason = {};
+            m_state = state::head;
+            m_scanned = 0;
+            m_remaining = 0;
+            m_status = 0;
+            m_close = false;
+            m_chunked = false;
+            m_no_body = no_body;
+            m_content_length.reset();
+        }
+
+        [[nodiscard]] bool headers_done() const noexcept { return m_state != state::head; }
+        [[nodiscard]] bool done() const noexcept { return m_state == state::done; }
+
+        // The connection can carry the next request: the body had its own framing and the
+        // server did not ask to close
+        [[nodiscard]] bool keep_alive() const noexcept { return done() && !m_close; }
+
+        [[nodiscard]] int status() const noexcept { return m_status; }
+        [[nodiscard]] std::string_view reason() const noexcept { return m_reason; }
+        [[nodiscard]] const std::vector<header>& headers() const noexcept { return m_headers; }
+        [[nodiscard]] std::optional<uint64_t> content_length() const noexcept { return m_content_length; }
+        [[nodiscard]] bool chunked() const noexcept { return m_chunked; }
+
+        // Status line and headers as received, final CRLFCRLF included
+        [[nodiscard]] std::string_view head() const noexcept { return m_head; }
+
+        // First header with this name, case-insensitive
+        [[nodiscard]] std::optional<std::string_view> find(std::string_view name) const {
+            for (auto& h : m_headers) {
+                if (iequals(h.name, name)) return h.value;
+            }
+            return std::nullopt;
+        }
+
+    private:
+        enum class state : uint8_t {
+            head,
+            fixed,          // Content-Length
+            until_close,    // no framing, the body ends with the connection
+            chunk_size,
+            chunk_data,
+            chunk_end,
+            trailer,
+            done,
+        };
+
+        [[noreturn]] static void fail(const char* what) {
+            throw std::runtime_error(std::string("hope-io/http: ") + what);
+        }
+
+        std::size_t feed_head(std::span<const char> data) {
+            const auto before = m_head.size();
+            m_head.append(data.data(), data.size());
+            const auto end = m_head.find("\r\n\r\n", m_scanned);
+            if (end == std::string::npos) {
+                if (m_head.size() > m_max_header_size) fail("response headers too large");
+                m_scanned = m_head.size() < 3 ? 0 : m_head.size() - 3;
+                return data.size();
+            }
+            m_head.resize(end + 4);
+            const auto used = m_head.size() - before;
+            parse_head();
+            if (m_status >= 100 && m_status < 200 && m_status != 101) {
+                // Interim response (100 Continue, 103 Early Hints), the real one follows
+                reset(m_no_body);
+            }
+            return used;
+        }
+
+        void parse_head() {
+            std::string_view head(m_head);
+            head.remove_suffix(4);
+            auto eol = head.find("\r\n");
+            auto status_line = head.substr(0, eol);
+            if (status_line.size() < 12 || !status_line.starts_with("HTTP/1.") || status_line[8] != ' ') {
+                fail("malformed status line");
+            }
+            auto [p, ec] = std::from_chars(status_line.data() + 9, status_line.data() + 12, m_status);
+            if (ec != std::errc{} || p != status_line.data() + 12) fail("malformed status code");
+            m_reason = status_line.size() > 13 ? status_line.substr(13) : std::string_view{};
+            m_close = status_line[7] == '0'; // HTTP/1.0 closes unless asked otherwise
+
+            head.remove_prefix(eol == std::string_view::npos ? head.size() : eol + 2);
+            while (!head.empty()) {
+                eol = head.find("\r\n");
+                auto line = head.substr(0, eol);
+                head.remove_prefix(eol == std::string_view::npos ? head.size() : eol + 2);
+                auto colon = line.find(':');
+                if (colon == std::string_view::npos) continue;
+                auto value = line.substr(colon + 1);
+                while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) value.remove_prefix(1);
+                while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) value.remove_suffix(1);
+                m_headers.push_back({ line.substr(0, colon), value });
+            }
+
+            for (auto& h : m_headers) {
+                if (iequals(h.name, "content-length")) {
+                    uint64_t length = 0;
+                    auto [end, err] = std::from_chars(h.value.data(), h.value.data() + h.value.size(), length);
+                    if (err != std::errc{} || end != h.value.data() + h.value.size()) fail("malformed Content-Length");
+                    m_content_length = length;
+                } else if (iequals(h.name, "transfer-encoding")) {
+                    m_chunked = has_token(h.value, "chunked");
+                } else if (iequals(h.name, "connection")) {
+                    if (has_token(h.value, "close")) m_close = true;
+                    else if (has_token(h.value, "keep-alive")) m_close = false;
+                }
+            }
+
+            // Transfer-Encoding overrides Content-Length (RFC 9112 6.3)
+            if (m_no_body || m_status == 204 || m_status == 304 || (m_status >= 100 && m_status < 200)) {
+                m_state = state::done;
+            } else if (m_chunked) {
+                m_state = state::chunk_size;
+            } else if (m_content_length) {
+                m_remaining = *m_content_length;
+                m_state = m_remaining == 0 ? state::done : state::fixed;
+            } else {
+                m_close = true;
+                m_state = state::until_close;
+            }
+        }
+
+        // Chunk size and trailer lines, which may arrive split over several reads
+        std::size_t feed_line(std::span<const char> data) {
+            constexpr std::size_t max_line = 4096;
+            auto nl = std::find(data.begin(), data.end(), '\n');
+            const auto used = (std::size_t)(nl - data.begin()) + (nl != data.end() ? 1 : 0);
+            m_line.append(data.data(), used);
+            if (m_line.size() > max_line) fail("chunk line too long");
+            if (nl == data.end()) return used;
+
+            std::string_view line(m_line);
+            line.remove_suffix(1);
+            if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+            if (m_state == state::chunk_size) {
+                uint64_t size = 0;
+                auto [p, ec] = std::from_chars(line.data(), line.data() + line.size(), size, 16);
+                if (ec != std::errc{} || p == line.data()) fail("malformed chunk size");
+                m_remaining = size;
+                m_state = size == 0 ? state::trailer : state::chunk_data;
+            } else if (line.empty()) {
+                m_state = state::done; // blank line ends the trailers
+            }
+            m_line.clear();
+            return used;
+        }
+
+        std::string m_head;
+        std::string m_line;
+        std::vector<header> m_headers;      // views into m_head
+        std::string_view m_reason;
+        std::optional<uint64_t> m_content_length;
+        std::size_t m_max_header_size;
+        std::size_t m_scanned = 0;
+        uint64_t m_remaining = 0;           // body or chunk bytes left; CRLF bytes seen in chunk_end
+        int m_status = 0;
+        state m_state = state::head;
+        bool m_close = false;
+        bool m_chunked = false;
+        bool m_no_body = false;
+    };
+
+}
@@ -11,12 +11,20 @@
 #include "hope-io/net/nix/tcp_stream.h"
 #include "hope-io/net/nix/event_loop_impl.h"
 #include "hope-io/net/linux/event_loop_impl.h"
+#include "hope-io/net/linux/sharded_event_loop.h"
+#include "hope-io/net/async_stream.h"
+#include "hope-io/net/timer_wheel.h"
 #include "hope-io/net/init.h"
 #include <thread>
 #include <chrono>
 #include <atomic>
 #include <vector>
 
+#if PLATFORM_LINUX
+#include <fcntl.h>
+#include <netinet/tcp.h>
+#endif
+
 using namespace std::chrono_literals;
 using namespace hope::io::el;
 
@@ -134,13 +142,648 @@ TEST_F(EventLoopTest, ConnectionHandling) {
 }
 #endif
 
+// Test sharded event loop: every shard echoes on its own SO_REUSEPORT listener (Linux only)
+#if PLATFORM_LINUX
+TEST_F(EventLoopTest, ShardedEcho) {
+    std::atomic<int> connections_accepted{0};
+
+    config cfg;
+    cfg.port = test_port;
+    cfg.max_mutual_connections = 16;
+    cfg.epoll_temeout = 100;
+    cfg.num_shards = 2;
+
+    auto on_connect = [&connections_accepted](connection&) {
+        connections_accepted++;
+        return el_connection_state::read;
+    };
+    auto on_read = [](connection&) { return el_connection_state::write; };
+    auto on_write = [](connection&) { return el_connection_state::read; };
+    auto on_err = [](connection&, const std::string&) { return el_connection_state::die; };
+
+    sharded_event_loop_t loop(
+        std::move(on_connect), std::move(on_read), std::move(on_write), std::move(on_err)
+    );
+    std::thread loop_thread([&loop, &cfg]() { loop.run(cfg); });
+
+    std::this_thread::sleep_for(100ms);
+
+    constexpr int clients_count = 8;
+    const std::string test_message = "Hello from sharded event loop test";
+    for (int i = 0; i < clients_count; ++i) {
+        hope::io::tcp_stream client;
+        client.connect("127.0.0.1", test_port);
+        client.write(test_message.c_str(), test_message.length());
+
+        std::string response(test_message.size(), '\0');
+        client.read(response.data(), response.size());
+        EXPECT_EQ(response, test_message);
+    }
+
+    loop.stop();
+    loop_thread.join();
+
+    EXPECT_EQ(connections_accepted.load(), clients_count);
+}
+
+// Full duplex: replies go to the tx ring while the rx ring keeps reading pipelined requests
+TEST_F(EventLoopTest, FullDuplexPipelinedEcho) {
+    config cfg;
+    cfg.port = test_port;
+    cfg.max_mutual_connections = 4;
+    cfg.epoll_temeout = 100;
+    cfg.full_duplex = true;
+
+    auto on_connect = [](connection&) { return el_connection_state::read_write; };
+    auto on_read = [](connection& c) {
+        c.buffer->consume_used([&](const void* data, std::size_t size) {
+            return c.tx_buffer->write(data, size);
+        });
+        return el_connection_state::read_write;
+    };
+    auto on_write = [](connection&) { return el_connection_state::read_write; };
+    auto on_err = [](connection&, const std::string&) { return el_connection_state::die; };
+
+    event_loop_impl_t loop(
+        std::move(on_connect), std::move(on_read), std::move(on_write), std::move(on_err)
+    );
+    std::thread loop_thread([&loop, &cfg]() { loop.run(cfg); });
+
+    std::this_thread::sleep_for(100ms);
+
+    constexpr int requests_count = 64;
+    std::string request(1024, '\0');
+    hope::io::tcp_stream client;
+    client.connect("127.0.0.1", test_port);
+    for (int i = 0; i < requests_count; ++i) {
+        std::fill(request.begin(), request.end(), char('a' + i % 26));
+        client.write(request.data(), request.size());
+    }
+    for (int i = 0; i < requests_count; ++i) {
+        std::string response(request.size(), '\0');
+        client.read(response.data(), response.size());
+        EXPECT_EQ(response, std::string(request.size(), char('a' + i % 26)));
+    }
+    client.disconnect();
+
+    loop.stop();
+    loop_thread.join();
+}
+
+// Producer threads publish into a connection through the loop's post queue
+TEST_F(EventLoopTest, CrossThreadPost) {
+    std::atomic<int32_t> subscriber{-1};
+
+    config cfg;
+    cfg.port = test_port;
+    cfg.max_mutual_connections = 4;
+    cfg.epoll_temeout = 100;
+    cfg.full_duplex = true;
+
+    auto on_connect = [&subscriber](connection& c) {
+        subscriber = c.descriptor;
+        return el_connection_state::read;
+    };
+    auto on_read = [](connection& c) {
+        c.buffer->reset();
+        return el_connection_state::read;
+    };
+    auto on_write = [](connection&) { return el_connection_state::read; };
+    auto on_err = [](connection&, const std::string&) { return el_connection_state::die; };
+
+    event_loop_impl_t loop(
+        std::move(on_connect), std::move(on_read), std::move(on_write), std::move(on_err)
+    );
+    std::thread loop_thread([&loop, &cfg]() { loop.run(cfg); });
+
+    std::this_thread::sleep_for(100ms);
+
+    hope::io::tcp_stream client;
+    client.connect("127.0.0.1", test_port);
+    for (int i = 0; i < 100 && subscriber.load() == -1; ++i) {
+        std::this_thread::sleep_for(10ms);
+    }
+    ASSERT_NE(subscriber.load(), -1);
+
+    std::atomic<bool> fn_ran{false};
+    constexpr int messages_count = 100;
+    std::thread producer([&] {
+        for (int i = 0; i < messages_count; ++i) {
+            auto text = std::to_string(1000 + i);
+            loop.post(subscriber.load(), std::vector<unsigned char>(text.begin(), text.end()));
+        }
+        loop.post([&fn_ran] { fn_ran = true; });
+    });
+    producer.join();
+
+    std::string expected;
+    for (int i = 0; i < messages_count; ++i) expected += std::to_string(1000 + i);
+    std::string received(expected.size(), '\0');
+    client.read(received.data(), received.size());
+    EXPECT_EQ(received, expected);
+
+    for (int i = 0; i < 100 && !fn_ran.load(); ++i) {
+        std::this_thread::sleep_for(10ms);
+    }
+    EXPECT_TRUE(fn_ran.load());
+    client.disconnect();
+
+    loop.stop();
+    loop_thread.join();
+}
+
+// Zero-copy segments keep their place between ring bytes and are released after sending
+TEST_F(EventLoopTest, ZeroCopySendOrdering) {
+    std::atomic<int32_t> subscriber{-1};
+
+    config cfg;
+    cfg.port = test_port;
+    cfg.max_mutual_connections = 4;
+    cfg.epoll_temeout = 100;
+    cfg.full_duplex = true;
+
+    auto on_connect = [&subscriber](connection& c) {
+        subscriber = c.descriptor;
+        return el_connection_state::read;
+    };
+    auto on_read = [](connection& c) {
+        c.buffer->reset();
+        return el_connection_state::read;
+    };
+    auto on_write = [](connection&) { return el_connection_state::read; };
+    auto on_err = [](connection&, const std::string&) { return el_connection_state::die; };
+
+    event_loop_impl_t loop(
+        std::move(on_connect), std::move(on_read), std::move(on_write), std::move(on_err)
+    );
+    std::thread loop_thread([&loop, &cfg]() { loop.run(cfg); });
+
+    std::this_thread::sleep_for(100ms);
+
+    hope::io::tcp_stream client;
+    client.connect("127.0.0.1", test_port);
+    for (int i = 0; i < 100 && subscriber.load() == -1; ++i) {
+        std::this_thread::sleep_for(10ms);
+    }
+    ASSERT_NE(subscriber.load(), -1);
+
+    std::vector<unsigned char> snapshot(1024 * 1024);
+    for (std::size_t i = 0; i < snapshot.size(); ++i) snapshot[i] = (unsigned char)('a' + i % 26);
+    auto big = zc_buffer::from(snapshot);
+    std::weak_ptr<const void> big_owner = big.owner;
+    auto small = zc_buffer::from({ 's', 'm', 'a', 'l', 'l' });
+
+    auto fd = subscriber.load();
+    loop.post(fd, { 'h', 'e', 'a', 'd' });
+    loop.post([&loop, fd, big = std::move(big), small = std::move(small)]() mutable {
+        loop.send_zero_copy(fd, std::move(big));
+        loop.send_zero_copy(fd, std::move(small));
+    });
+    loop.post(fd, { 't', 'a', 'i', 'l' });
+
+    std::string expected = "head" + std::string(snapshot.begin(), snapshot.end()) + "small" + "tail";
+    std::string received(expected.size(), '\0');
+    client.read(received.data(), received.size());
+    EXPECT_TRUE(received == expected);
+
+    // The loop holds the last reference until the kernel reports completion
+    for (int i = 0; i < 100 && !big_owner.expired(); ++i) {
+        std::this_thread::sleep_for(10ms);
+    }
+    EXPECT_TRUE(big_owner.expired());
+    client.disconnect();
+
+    loop.stop();
+    loop_thread.join();
+}
+
+// A connection removed with zero-copy bytes in flight keeps their owner until the
+// kernel reports completion, the peer still receives everything followed by EOF
+TEST_F(EventLoopTest, ZeroCopyOwnerOutlivesRemoval) {
+    std::atomic<int32_t> subscriber{-1};
+
+    config cfg;
+    cfg.port = test_port;
+    cfg.max_mutual_connections = 4;
+    cfg.epoll_temeout = 100;
+    cfg.full_duplex = true;
+
+    auto on_connect = [&subscriber](connection& c) {
+        subscriber = c.descriptor;
+        return el_connection_state::read;
+    };
+    auto on_read = [](connection&) { return el_connection_state::die; };
+    auto on_write = [](connection&) { return el_connection_state::read; };
+    auto on_err = [](connection&, const std::string&) { return el_connection_state::die; };
+
+    event_loop_impl_t loop(
+        std::move(on_connect), std::move(on_read), std::move(on_write), std::move(on_err)
+    );
+    std::thread loop_thread([&loop, &cfg]() { loop.run(cfg); });
+
+    std::this_thread::sleep_for(100ms);
+
+    hope::io::tcp_stream client;
+    client.connect("127.0.0.1", test_port);
+    for (int i = 0; i < 100 && subscriber.load() == -1; ++i) {
+        std::this_thread::sleep_for(10ms);
+    }
+    ASSERT_NE(subscriber.load(), -1);
+
+    std::vector<unsigned char> snapshot(256 * 1024);
+    for (std::size_t i = 0; i < snapshot.size(); ++i) snapshot[i] = (unsigned char)('a' + i % 26);
+    auto payload = zc_buffer::from(snapshot);
+    std::weak_ptr<const void> owner = payload.owner;
+
+    auto fd = subscriber.load();
+    loop.post([&loop, fd, payload = std::move(payload)]() mutable {
+        loop.send_zero_copy(fd, std::move(payload));
+    });
+    std::this_thread::sleep_for(50ms);
+
+    // Any input makes the server drop the connection, the payload is still unread
+    client.write("q", 1);
+
+    std::string received;
+    client.stream_in(received);
+    EXPECT_TRUE(received == std::string(snapshot.begin(), snapshot.end()));
+
+    for (int i = 0; i < 100 && !owner.expired(); ++i) {
+        std::this_thread::sleep_for(10ms);
+    }
+    EXPECT_TRUE(owner.expired());
+    client.disconnect();
+
+    loop.stop();
+    loop_thread.join();
+}
+
+// Request/response echo completes inline, the read interest is never re-armed
+TEST_F(EventLoopTest, EchoSkipsRedundantEpollMod) {
+    config cfg;
+    cfg.port = test_port;
+    cfg.max_mutual_connections = 4;
+    cfg.epoll_temeout = 100;
+
+    auto on_connect = [](connection&) { return el_connection_state::read; };
+    auto on_read = [](connection&) { return el_connection_state::write; };
+    auto on_write = [](connection&) { return el_connection_state::read; };
+    auto on_err = [](connection&, const std::string&) { return el_connection_state::die; };
+
+    event_loop_impl_t loop(
+        std::move(on_connect), std::move(on_read), std::move(on_write), std::move(on_err)
+    );
+    std::thread loop_thread([&loop, &cfg]() { loop.run(cfg); });
+
+    std::this_thread::sleep_for(100ms);
+
+    constexpr int round_trips = 50;
+    hope::io::tcp_stream client;
+    client.connect("127.0.0.1", test_port);
+    for (int i = 0; i < round_trips; ++i) {
+        char ping[] = "ping";
+        client.write(ping, sizeof(ping));
+        char pong[sizeof(ping)] = {};
+        client.read(pong, sizeof(pong));
+        ASSERT_STREQ(pong, "ping");
+    }
+    client.disconnect();
+
+    loop.stop();
+    loop_thread.join();
+
+    EXPECT_GE(loop.stats().ctl_mod_skipped, (uint64_t)round_trips);
+    EXPECT_LT(loop.stats().ctl_mod, (uint64_t)round_trips / 2);
+}
+
+// accept4 flags and options inherited from the listener reach every accepted socket
+TEST_F(EventLoopTest, AcceptedSocketOptions) {
+    std::atomic<int> keepalive{-1};
+    std::atomic<int> nodelay{-1};
+    std::atomic<int> fd_flags{0};
+    std::atomic<int> fd_cloexec{0};
+
+    config cfg;
+    cfg.port = test_port;
+    cfg.max_mutual_connections = 4;
+    cfg.epoll_temeout = 100;
+    cfg.accepted_stream_options.keepalive = true;
+    cfg.accepted_stream_options.tcp_nodelay = true;
+
+    auto on_connect = [&](connection& c) {
+        int value = 0;
+        socklen_t len = sizeof(value);
+        getsockopt(c.descriptor, SOL_SOCKET, SO_KEEPALIVE, &value, &len);
+        keepalive = value;
+        len = sizeof(value);
+        getsockopt(c.descriptor, IPPROTO_TCP, TCP_NODELAY, &value, &len);
+        nodelay = value;
+        fd_flags = fcntl(c.descriptor, F_GETFL, 0);
+        fd_cloexec = fcntl(c.descriptor, F_GETFD, 0);
+        return el_connection_state::read;
+    };
+    auto on_read = [](connection&) { return el_connection_state::write; };
+    auto on_write = [](connection&) { return el_connection_state::read; };
+    auto on_err = [](connection&, const std::string&) { return el_connection_state::die; };
+
+    event_loop_impl_t loop(
+        std::move(on_connect), std::move(on_read), std::move(on_write), std::move(on_err)
+    );
+    std::thread loop_thread([&loop, &cfg]() { loop.run(cfg); });
+
+    std::this_thread::sleep_for(100ms);
+
+    hope::io::tcp_stream client;
+    client.connect("127.0.0.1", test_port);
+    for (int i = 0; i < 100 && keepalive.load() == -1; ++i) {
+        std::this_thread::sleep_for(10ms);
+    }
+    client.disconnect();
+
+    loop.stop();
+    loop_thread.join();
+
+    EXPECT_EQ(keepalive.load(), 1);
+    EXPECT_NE(nodelay.load(), 0);
+    EXPECT_TRUE(fd_flags.load() & O_NONBLOCK);
+    EXPECT_TRUE(fd_cloexec.load() & FD_CLOEXEC);
+}
+
+// Length-prefixed echo written as a coroutine; handlers end when their peer disconnects
+TEST_F(EventLoopTest, CoroutineEcho) {
+    std::atomic<int> handled{0};
+    std::atomic<int> finished{0};
+
+    config cfg;
+    cfg.port = test_port;
+    cfg.max_mutual_connections = 8;
+    cfg.epoll_temeout = 100;
+    cfg.full_duplex = true;
+
+    co::scheduler sched;
+    auto loop = co::make_loop<event_loop_impl_t>(sched);
+
+    struct echo {
+        static co::task<> serve(std::shared_ptr<co::async_stream> s, std::atomic<int>& handled,
+                                std::atomic<int>& finished) {
+            try {
+                while (true) {
+                    uint32_t size = 0;
+                    co_await s->read(std::span((unsigned char*)&size, sizeof(size)));
+                    auto body = co_await s->read(size);
+                    co_await s->write(std::span((const unsigned char*)&size, sizeof(size)));
+                    co_await s->write(body);
+                    handled++;
+                }
+            } catch (const std::exception&) {
+                finished++;
+            }
+        }
+
+        static co::task<> accept_all(co::scheduler& sched, std::atomic<int>& handled, std::atomic<int>& finished) {
+            while (true) {
+                co::spawn(serve(co_await sched.accept(), handled, finished));
+            }
+        }
+    };
+    co::spawn(echo::accept_all(sched, handled, finished));
+
+    std::thread loop_thread([&loop, &cfg]() { loop->run(cfg); });
+    std::this_thread::sleep_for(100ms);
+
+    constexpr int clients_count = 3;
+    constexpr int messages_count = 4;
+    for (int c = 0; c < clients_count; ++c) {
+        hope::io::tcp_stream client;
+        client.connect("127.0.0.1", test_port);
+        for (int i = 0; i < messages_count; ++i) {
+            std::string message(100 * 1000 * i + 10, char('a' + i)); // up to 300 KB, longer than a ring class
+            client.write((uint32_t)message.size());
+            client.write(message.data(), message.size());
+
+            auto size = client.read<uint32_t>();
+            ASSERT_EQ(size, message.size());
+            std::string reply(size, '\0');
+            client.read(reply.data(), reply.size());
+            EXPECT_TRUE(reply == message);
+        }
+        client.disconnect();
+    }
+
+    for (int i = 0; i < 100 && finished.load() < clients_count; ++i) {
+        std::this_thread::sleep_for(10ms);
+    }
+    loop->stop();
+    loop_thread.join();
+
+    EXPECT_EQ(handled.load(), clients_count * messages_count);
+    EXPECT_EQ(finished.load(), clients_count);
+}
+
+// One client-mode loop drives many outbound connections through the same callbacks
+TEST_F(EventLoopTest, OutboundConnect) {
+    constexpr int clients = 64;
+    const uint64_t refused_tag = 1000;
+
+    config server_cfg;
+    server_cfg.port = test_port;
+    server_cfg.max_mutual_connections = 128;
+    server_cfg.epoll_temeout = 100;
+
+    auto s_connect = [](connection&) { return el_connection_state::read; };
+    auto s_read = [](connection&) { return el_connection_state::write; };
+    auto s_write = [](connection&) { return el_connection_state::read; };
+    auto s_err = [](connection&, const std::string&) { return el_connection_state::die; };
+    event_loop_impl_t server(std::move(s_connect), std::move(s_read), std::move(s_write), std::move(s_err));
+    std::thread server_thread([&server, &server_cfg]() { server.run(server_cfg); });
+
+    std::this_thread::sleep_for(100ms);
+
+    std::atomic<int> echoed{0};
+    std::atomic<int> mismatched{0};
+    std::atomic<uint64_t> failed_tag{0};
+    std::atomic<int32_t> failed_descriptor{0};
+
+    config client_cfg;
+    client_cfg.listen = false;
+    client_cfg.max_mutual_connections = 128;
+    client_cfg.epoll_temeout = 100;
+    client_cfg.outbound_stream_options.tcp_nodelay = true;
+
+    auto on_connect = [](connection& c) {
+        auto msg = "ping" + std::to_string(c.tag);
+        c.buffer->write(msg.data(), msg.size());
+        return el_connection_state::write;
+    };
+    auto on_write = [](connection&) { return el_connection_state::read; };
+    auto on_read = [&](connection& c) {
+        auto expected = "ping" + std::to_string(c.tag);
+        if (c.buffer->count() < expected.size()) return el_connection_state::read;
+        std::string got(c.buffer->count(), '\0');
+        c.buffer->read(got.data(), got.size());
+        if (got == expected) echoed++;
+        else mismatched++;
+        return el_connection_state::die;
+    };
+    auto on_err = [&](connection& c, const std::string&) {
+        if (c.descriptor == -1) {
+            failed_descriptor = c.descriptor;
+            failed_tag = c.tag;
+        }
+        return el_connection_state::die;
+    };
+    event_loop_impl_t client(std::move(on_connect), std::move(on_read), std::move(on_write), std::move(on_err));
+    std::thread client_thread([&client, &client_cfg]() { client.run(client_cfg); });
+
+    for (int i = 1; i <= clients; ++i) {
+        client.connect("127.0.0.1", (uint16_t)test_port, (uint64_t)i);
+    }
+    // Nobody listens there
+    client.connect("127.0.0.1", (uint16_t)(test_port + 1000), refused_tag);
+
+    for (int i = 0; i < 200 && (echoed.load() < clients || failed_tag.load() == 0); ++i) {
+        std::this_thread::sleep_for(10ms);
+    }
+
+    client.stop();
+    client_thread.join();
+    server.stop();
+    server_thread.join();
+
+    EXPECT_EQ(echoed.load(), clients);
+    EXPECT_EQ(mismatched.load(), 0);
+    EXPECT_EQ(failed_tag.load(), refused_tag);
+    EXPECT_EQ(failed_descriptor.load(), -1);
+}
+
+// An IPv6 listener on a specific address, served by the same callbacks
+TEST_F(EventLoopTest, BindAddressIPv6) {
+    config cfg;
+    cfg.port = test_port;
+    cfg.max_mutual_connections = 4;
+    cfg.epoll_temeout = 100;
+    cfg.bind_address = "::1";
+    cfg.ipv6_only = true;
+
+    auto on_connect = [](connection&) { return el_connection_state::read; };
+    auto on_read = [](connection&) { return el_connection_state::write; };
+    auto on_write = [](connection&) { return el_connection_state::read; };
+    auto on_err = [](connection&, const std::string&) { return el_connection_state::die; };
+
+    event_loop_impl_t loop(
+        std::move(on_connect), std::move(on_read), std::move(on_write), std::move(on_err)
+    );
+    std::thread loop_thread([&loop, &cfg]() { loop.run(cfg); });
+
+    std::this_thread::sleep_for(100ms);
+
+    hope::io::tcp_stream client;
+    client.connect("::1", test_port);
+    const std::string ping = "ping";
+    client.write(ping.data(), ping.size());
+    std::string pong(ping.size(), '\0');
+    client.read(pong.data(), pong.size());
+    EXPECT_EQ(pong, ping);
+    client.disconnect();
+
+    hope::io::tcp_stream v4;
+    EXPECT_THROW(v4.connect("127.0.0.1", test_port), std::exception);
+
+    loop.stop();
+    loop_thread.join();
+}
+
+// Dead clients are closed once idle_timeout_ms passes without traffic
+TEST_F(EventLoopTest, IdleTimeoutClosesConnection) {
+    std::atomic<int> timeouts{0};
+
+    config cfg;
+    cfg.port = test_port;
+    cfg.max_mutual_connections = 4;
+    cfg.epoll_temeout = 1000;
+    cfg.idle_timeout_ms = 150;
+
+    auto on_connect = [](connection&) { return el_connection_state::read; };
+    auto on_read = [](connection&) { return el_connection_state::write; };
+    auto on_write = [](connection&) { return el_connection_state::read; };
+    auto on_err = [&timeouts](connection&, const std::string& what) {
+        if (what.find("idle timeout") != std::string::npos) timeouts++;
+        return el_connection_state::die;
+    };
+
+    event_loop_impl_t loop(
+        std::move(on_connect), std::move(on_read), std::move(on_write), std::move(on_err)
+    );
+    std::thread loop_thread([&loop, &cfg]() { loop.run(cfg); });
+
+    std::this_thread::sleep_for(100ms);
+
+    hope::io::tcp_stream client;
+    client.connect("127.0.0.1", test_port);
+    // Traffic keeps the connection alive past the timeout
+    const std::string ping = "ping";
+    for (int i = 0; i < 4; ++i) {
+        client.write(ping.data(), ping.size());
+        std::string pong(ping.size(), '\0');
+        client.read(pong.data(), pong.size());
+        std::this_thread::sleep_for(60ms);
+    }
+    EXPECT_EQ(timeouts.load(), 0);
+
+    // epoll_temeout is 1 s, the timer has to shorten the wait
+    std::this_thread::sleep_for(400ms);
+    EXPECT_EQ(timeouts.load(), 1);
+
+    loop.stop();
+    loop_thread.join();
+}
+#endif
+
+// Test timer wheel ordering, cancellation and cascading from the upper levels
+TEST_F(EventLoopTest, TimerWheel) {
+    auto t0 = timer_wheel::clock::now();
+    timer_wheel wheel;
+    std::vector<int> fired;
+
+    wheel.schedule(30ms, [&] { fired.push_back(30); });
+    wheel.schedule(10ms, [&] { fired.push_back(10); });
+    auto cancelled = wheel.schedule(20ms, [&] { fired.push_back(20); });
+    wheel.schedule(5000ms, [&] { fired.push_back(5000); });
+    wheel.schedule(300000ms, [&] { fired.push_back(300000); });
+    EXPECT_EQ(wheel.size(), 5u);
+    EXPECT_TRUE(wheel.cancel(cancelled));
+    EXPECT_FALSE(wheel.cancel(cancelled));
+
+    wheel.advance(t0 + 5ms);
+    EXPECT_TRUE(fired.empty());
+    EXPECT_LE(wheel.next_timeout_ms(1000), 10);
+
+    wheel.advance(t0 + 100ms);
+    EXPECT_EQ(fired, (std::vector<int>{ 10, 30 }));
+
+    // Callbacks may reschedule from inside advance()
+    wheel.schedule(1ms, [&] { wheel.schedule(1ms, [&] { fired.push_back(-1); }); });
+    wheel.advance(t0 + 4000ms);
+    EXPECT_EQ(fired, (std::vector<int>{ 10, 30, -1 }));
+
+    wheel.advance(t0 + 5100ms);
+    EXPECT_EQ(fired.back(), 5000);
+    wheel.advance(t0 + 299000ms);
+    EXPECT_EQ(fired.back(), 5000);
+    wheel.advance(t0 + 300100ms);
+    EXPECT_EQ(fired.back(), 300000);
+    EXPECT_EQ(wheel.size(), 0u);
+    EXPECT_EQ(wheel.next_timeout_ms(1000), 1000);
+}
+
 // Test event loop fixed_size_buffer
 TEST_F(EventLoopTest, FixedSizeBuffer) {
     fixed_size_buffer buffer;
 
     EXPECT_TRUE(buffer.is_empty());
     EXPECT_EQ(buffer.count(), 0u);
-    EXPECT_EQ(buffer.free_space(), fixed_size_buffer::buffer_size);
+    EXPECT_EQ(buffer.capacity(), tiered_buffer::min_capacity);
+    EXPECT_EQ(buffer.free_space(), buffer.capacity());
 
     const std::string test_data = "Test data";
     size_t written = buffer.write(test_data.c_str(), test_data.length());
@@ -171,6 +814,48 @@ TEST_F(EventLoopTest, BufferShrink) {
     EXPECT_EQ(buffer.count(), test_data.length() - 5);
 }
 
+// Test tiered buffer growth keeps wrapped data in order and shrinks back after quiet drains
+TEST_F(EventLoopTest, TieredBufferGrowShrink) {
+    tiered_buffer buffer;
+
+    // Wrap the head/tail around the smallest class before growing
+    std::vector<char> pad(3000, 'p');
+    buffer.write(pad.data(), pad.size());
+    std::vector<char> sink(pad.size());
+    EXPECT_EQ(buffer.read(sink.data(), sink.size()), pad.size());
+
+    std::vector<char> payload(10000);
+    for (std::size_t i = 0; i < payload.size(); ++i) payload[i] = char(i * 31);
+    EXPECT_EQ(buffer.write(payload.data(), payload.size()), payload.size());
+    EXPECT_EQ(buffer.capacity(), tiered_buffer::size_classes[1]);
+    EXPECT_EQ(buffer.count(), payload.size());
+
+    std::vector<char> out(payload.size());
+    EXPECT_EQ(buffer.read(out.data(), out.size()), out.size());
+    EXPECT_EQ(out, payload);
+
+    // Large buffers step down only after shrink_epochs drains that fit the lower class
+    const std::string small = "ping";
+    char tmp[16];
+    for (std::size_t i = 0; i + 1 < tiered_buffer::shrink_epochs; ++i) {
+        buffer.write(small.data(), small.size());
+        buffer.read(tmp, sizeof(tmp));
+        EXPECT_EQ(buffer.capacity(), tiered_buffer::size_classes[1]);
+    }
+    buffer.write(small.data(), small.size());
+    buffer.read(tmp, sizeof(tmp));
+    EXPECT_EQ(buffer.capacity(), tiered_buffer::min_capacity);
+
+    // The largest class is a hard limit
+    std::vector<char> big(tiered_buffer::max_capacity + 100, 'b');
+    EXPECT_EQ(buffer.write(big.data(), big.size()), tiered_buffer::max_capacity);
+    EXPECT_EQ(buffer.free_space(), 0u);
+
+    buffer.reset();
+    buffer.shrink_to_fit();
+    EXPECT_EQ(buffer.capacity(), tiered_buffer::min_capacity);
+}
+
 // Test event loop connection state
 TEST_F(EventLoopTest, ConnectionState) {
     connection conn(123);
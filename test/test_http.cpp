@@ -0,0 +1,351 @@
+/* Copyright (C) 2026 Gleb Bezborodov - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: bezborodoff.gleb@gmail.com, or visit : https://github.com/glensand/hope-io
+ */
+
+#include <gtest/gtest.h>
+#include "hope-io/coredefs.h"
+
+#if PLATFORM_LINUX
+
+#include "hope-io/request/request.h"
+#include "hope-io/net/nix/tcp_acceptor.h"
+#include "hope-io/net/tls/tls_acceptor_impl.h"
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+class HttpTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        static std::atomic<int> port_counter{22000};
+        test_port = port_counter.fetch_add(1);
+        hope::io::http::connection_pool::shared().clear();
+        before = hope::io::http::connection_pool::shared().get_stats();
+    }
+
+    void TearDown() override {
+        // Idle pooled connections keep the server threads reading
+        hope::io::http::connection_pool::shared().clear();
+        for (auto& t : threads) t.join();
+        if (acceptor) acceptor->close();
+    }
+
+    // Accepts `connections` connections; each answers up to max_requests requests with
+    // respond(), then closes without saying so (what a server idle timeout looks like)
+    void serve(int connections, int max_requests, std::function<std::string()> respond) {
+        if (!acceptor) {
+            acceptor = std::make_unique<hope::io::tcp_acceptor>();
+            acceptor->open(test_port);
+        }
+        threads.emplace_back([this, connections, max_requests, respond] {
+            std::vector<std::thread> sessions;
+            for (int i = 0; i < connections; ++i) {
+                auto* conn = acceptor->accept();
+                ++accepted;
+                sessions.emplace_back([this, conn, max_requests, respond] {
+                    std::unique_ptr<hope::io::stream> owned(conn);
+                    answer(*conn, max_requests, respond);
+                });
+            }
+            for (auto& t : sessions) t.join();
+        });
+    }
+
+    void answer(hope::io::stream& conn, int max_requests, const std::function<std::string()>& respond) {
+        std::string in;
+        char buf[4096];
+        for (int served = 0; served < max_requests; ++served) {
+            std::size_t end;
+            while ((end = in.find("\r\n\r\n")) == std::string::npos) {
+                auto n = conn.read_once(buf, sizeof(buf));
+                if (n == 0) return;
+                in.append(buf, n);
+            }
+            std::size_t length = 0;
+            if (auto cl = in.find("Content-Length: "); cl != std::string::npos && cl < end) {
+                length = std::stoul(in.substr(cl + 16));
+            }
+            while (in.size() < end + 4 + length) {
+                auto n = conn.read_once(buf, sizeof(buf));
+                if (n == 0) return;
+                in.append(buf, n);
+            }
+            {
+                std::lock_guard lock(requests_lock);
+                last_request = in.substr(0, end + 4 + length);
+            }
+            in.erase(0, end + 4 + length);
+            auto response = respond();
+            conn.write(response.data(), response.size());
+        }
+    }
+
+    std::string url(const std::string& scheme = "http") const {
+        return scheme + "://127.0.0.1:" + std::to_string(test_port) + "/api";
+    }
+
+    hope::io::http::connection_pool::stats delta() const {
+        auto now = hope::io::http::connection_pool::shared().get_stats();
+        return { now.connects - before.connects, now.reuses - before.reuses, now.resumed - before.resumed };
+    }
+
+    std::size_t test_port = 0;
+    std::unique_ptr<hope::io::acceptor> acceptor;
+    std::vector<std::thread> threads;
+    std::atomic<int> accepted{0};
+    std::mutex requests_lock;
+    std::string last_request;
+    hope::io::http::connection_pool::stats before;
+};
+
+TEST_F(HttpTest, KeepAliveReusesConnection) {
+    serve(1, 100, [] { return std::string("HTTP/1.1 200 OK\r\nContent-Length: 11\r\n\r\n{\"ok\":true}"); });
+
+    for (int i = 0; i < 5; ++i) {
+        auto resp = hope::io::http::post(url(), "{}");
+        ASSERT_TRUE(resp.starts_with("HTTP/1.1 200 OK\r\n"));
+        EXPECT_TRUE(resp.ends_with("\r\n\r\n{\"ok\":true}"));
+    }
+    EXPECT_EQ(accepted.load(), 1);
+    EXPECT_EQ(delta().connects, 1u);
+    EXPECT_EQ(delta().reuses, 4u);
+}
+
+TEST_F(HttpTest, ChunkedBodyIsDecoded) {
+    serve(1, 100, [] {
+        return std::string("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n"
+                           "4\r\nWiki\r\n5;ext=1\r\npedia\r\nE\r\n in\r\n\r\nchunks.\r\n0\r\nX-Trailer: 1\r\n\r\n");
+    });
+
+    for (int i = 0; i < 3; ++i) {
+        auto resp = hope::io::http::get(url(), { { "q", "1" } });
+        EXPECT_TRUE(resp.ends_with("\r\n\r\nWikipedia in\r\n\r\nchunks.")) << resp;
+    }
+    EXPECT_EQ(accepted.load(), 1);
+}
+
+TEST_F(HttpTest, ConnectionCloseIsNotPooled) {
+    serve(2, 1, [] { return std::string("HTTP/1.1 200 OK\r\nConnection: close\r\nContent-Length: 2\r\n\r\nok"); });
+
+    EXPECT_TRUE(hope::io::http::post(url(), "a").ends_with("ok"));
+    EXPECT_TRUE(hope::io::http::post(url(), "b").ends_with("ok"));
+    EXPECT_EQ(accepted.load(), 2);
+    EXPECT_EQ(delta().reuses, 0u);
+}
+
+TEST_F(HttpTest, ServerClosedIdleConnection) {
+    // Keep-alive is promised but every connection is dropped after one response
+    serve(3, 1, [] { return std::string("HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok"); });
+
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_TRUE(hope::io::http::post(url(), "x").ends_with("ok"));
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    EXPECT_EQ(accepted.load(), 3);
+}
+
+TEST_F(HttpTest, ReadToCloseWithoutLength) {
+    serve(1, 1, [] { return std::string("HTTP/1.0 200 OK\r\n\r\nuntil close"); });
+    EXPECT_TRUE(hope::io::http::post(url(), "x").ends_with("\r\n\r\nuntil close"));
+    EXPECT_EQ(delta().reuses, 0u);
+}
+
+TEST_F(HttpTest, TlsSessionIsResumed) {
+    std::string key_path;
+    for (auto* p : { "../test/certs/key.pem", "../../test/certs/key.pem", "test/certs/key.pem" }) {
+        if (fs::exists(p)) {
+            key_path = p;
+            break;
+        }
+    }
+    if (key_path.empty()) GTEST_SKIP() << "TLS test certificates not available";
+    auto cert_path = key_path.substr(0, key_path.find("key.pem")) + "cert.pem";
+
+    acceptor = std::make_unique<hope::io::tls_acceptor_impl>(key_path, cert_path);
+    acceptor->open(test_port);
+    serve(2, 100, [] { return std::string("HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok"); });
+
+    EXPECT_TRUE(hope::io::http::post(url("https"), "x").ends_with("ok"));
+    EXPECT_TRUE(hope::io::http::post(url("https"), "x").ends_with("ok"));
+    EXPECT_EQ(delta().reuses, 1u);
+
+    // A new connection offers the session of the previous one
+    hope::io::http::connection_pool::shared().clear();
+    EXPECT_TRUE(hope::io::http::post(url("https"), "x").ends_with("ok"));
+    EXPECT_EQ(accepted.load(), 2);
+    EXPECT_EQ(delta().connects, 2u);
+    EXPECT_EQ(delta().resumed, 1u);
+}
+
+TEST_F(HttpTest, UploadFileSendsFromDisk) {
+    const auto path = fs::temp_directory_path() / ("hope-io-upload-" + std::to_string(test_port));
+    std::string content;
+    for (int i = 0; content.size() < 3 * 1024 * 1024 + 17; ++i) content += std::to_string(i) + ",";
+    std::ofstream(path, std::ios::binary) << content;
+
+    serve(1, 100, [] { return std::string("HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok"); });
+    for (int i = 0; i < 2; ++i) {
+        auto resp = hope::io::http::upload_file_2(url(), path.string(), "artifact.bin");
+        EXPECT_TRUE(resp.ends_with("ok"));
+        std::lock_guard lock(requests_lock);
+        auto body_at = last_request.find("\r\n\r\n", last_request.find("filename=\"artifact.bin\""));
+        ASSERT_NE(body_at, std::string::npos);
+        EXPECT_EQ(last_request.compare(body_at + 4, content.size(), content), 0);
+        EXPECT_TRUE(last_request.ends_with("--\r\n"));
+    }
+    EXPECT_EQ(accepted.load(), 1);
+    fs::remove(path);
+}
+
+// ── response_parser ──────────────────────────────────────────
+
+namespace {
+    // Feeds text in pieces of `step` bytes and returns the collected body
+    std::string feed_in_steps(hope::io::http::response_parser& p, std::string_view text, std::size_t step) {
+        std::string body;
+        for (std::size_t i = 0; i < text.size() && !p.done(); i += step) {
+            auto piece = text.substr(i, step);
+            p.feed({ piece.data(), piece.size() }, [&](std::span<const char> b) { body.append(b.data(), b.size()); });
+        }
+        return body;
+    }
+}
+
+TEST(HttpParserTest, ChunkedInAnySplit) {
+    const std::string text = "HTTP/1.1 200 OK\r\nTransfer-Encoding: gzip, chunked\r\nX-Id:  42 \r\n\r\n"
+                             "4\r\nWiki\r\n5;name=val\r\npedia\r\nE\r\n in\r\n\r\nchunks.\r\n0\r\nTrailer: x\r\n\r\n";
+    for (std::size_t step : { 1u, 2u, 3u, 7u, 64u, 4096u }) {
+        hope::io::http::response_parser p;
+        EXPECT_EQ(feed_in_steps(p, text, step), "Wikipedia in\r\n\r\nchunks.") << "step " << step;
+        EXPECT_TRUE(p.done());
+        EXPECT_TRUE(p.keep_alive());
+        EXPECT_TRUE(p.chunked());
+        EXPECT_EQ(p.status(), 200);
+        EXPECT_EQ(p.reason(), "OK");
+        EXPECT_EQ(p.find("x-id"), "42");
+        EXPECT_FALSE(p.find("content-length"));
+    }
+}
+
+TEST(HttpParserTest, BodyIsNotCopied) {
+    const std::string text = "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nhello";
+    hope::io::http::response_parser p;
+    const char* body_at = nullptr;
+    auto used = p.feed({ text.data(), text.size() }, [&](std::span<const char> b) { body_at = b.data(); });
+    EXPECT_EQ(used, text.size());
+    EXPECT_EQ(body_at, text.data() + text.size() - 5);
+}
+
+TEST(HttpParserTest, StopsAtResponseEnd) {
+    const std::string text = "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nokHTTP/1.1 200 OK\r\n";
+    hope::io::http::response_parser p;
+    auto used = p.feed({ text.data(), text.size() }, [](std::span<const char>) {});
+    EXPECT_TRUE(p.done());
+    EXPECT_EQ(used, text.find("okHTTP") + 2);
+}
+
+TEST(HttpParserTest, InterimAndBodylessResponses) {
+    hope::io::http::response_parser p;
+    const std::string text = "HTTP/1.1 100 Continue\r\n\r\nHTTP/1.1 204 No Content\r\nConnection: close\r\n\r\n";
+    EXPECT_EQ(feed_in_steps(p, text, 5), "");
+    EXPECT_EQ(p.status(), 204);
+    EXPECT_TRUE(p.done());
+    EXPECT_FALSE(p.keep_alive());
+    EXPECT_TRUE(p.head().starts_with("HTTP/1.1 204"));
+}
+
+TEST(HttpParserTest, HeadResponseHasNoBody) {
+    const std::string text = "HTTP/1.1 100 Continue\r\n\r\n"
+                             "HTTP/1.1 200 OK\r\nContent-Length: 1234\r\n\r\nHTTP/1.1 200 OK\r\n";
+    hope::io::http::response_parser p;
+    p.reset(true);
+    std::string body;
+    auto used = p.feed({ text.data(), text.size() }, [&](std::span<const char> b) { body.append(b.data(), b.size()); });
+    EXPECT_TRUE(p.done());
+    EXPECT_TRUE(p.keep_alive());
+    EXPECT_EQ(p.status(), 200);
+    EXPECT_EQ(p.find("content-length"), "1234");
+    EXPECT_EQ(body, "");
+    EXPECT_EQ(used, text.rfind("HTTP/1.1"));
+
+    // Without the flag the same head waits for 1234 bytes
+    p.reset();
+    p.feed({ text.data(), used }, [](std::span<const char>) {});
+    EXPECT_FALSE(p.done());
+}
+
+TEST(HttpParserTest, ReadToClose) {
+    hope::io::http::response_parser p;
+    EXPECT_EQ(feed_in_steps(p, "HTTP/1.1 200 OK\r\n\r\nall of it", 4), "all of it");
+    EXPECT_FALSE(p.done());
+    EXPECT_TRUE(p.finish());
+    EXPECT_FALSE(p.keep_alive());
+
+    hope::io::http::response_parser cut;
+    feed_in_steps(cut, "HTTP/1.1 200 OK\r\nContent-Length: 10\r\n\r\nshort", 64);
+    EXPECT_FALSE(cut.finish());
+}
+
+TEST(HttpParserTest, MalformedInputThrows) {
+    auto parse = [](std::string_view text, std::size_t max_header = 64 * 1024) {
+        hope::io::http::response_parser p(max_header);
+        p.feed({ text.data(), text.size() }, [](std::span<const char>) {});
+    };
+    EXPECT_THROW(parse("SMTP 220 hello\r\n\r\n"), std::runtime_error);
+    EXPECT_THROW(parse("HTTP/1.1 2x0 OK\r\n\r\n"), std::runtime_error);
+    EXPECT_THROW(parse("HTTP/1.1 200 OK\r\nContent-Length: 1O\r\n\r\n"), std::runtime_error);
+    EXPECT_THROW(parse("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n"), std::runtime_error);
+    EXPECT_THROW(parse("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n2\r\nokXX"), std::runtime_error);
+    EXPECT_THROW(parse("HTTP/1.1 200 OK\r\nX-Big: " + std::string(256, 'a'), 128), std::runtime_error);
+}
+
+TEST_F(HttpTest, FetchHeadDoesNotWaitForBody) {
+    serve(1, 100, [] { return std::string("HTTP/1.1 200 OK\r\nContent-Length: 1048576\r\n\r\n"); });
+    for (int i = 0; i < 2; ++i) {
+        auto resp = hope::io::http::fetch("HEAD", url());
+        EXPECT_EQ(resp.status, 200);
+        EXPECT_TRUE(resp.body.empty());
+    }
+    EXPECT_EQ(accepted.load(), 1);
+}
+
+TEST_F(HttpTest, FetchStreamsBody) {
+    std::string payload(1 << 20, 'x');
+    for (std::size_t i = 0; i < payload.size(); i += 997) payload[i] = (char)('a' + i % 26);
+    serve(1, 100, [&payload] {
+        return "HTTP/1.1 201 Created\r\nContent-Length: " + std::to_string(payload.size()) +
+               "\r\nX-Request: 7\r\n\r\n" + payload;
+    });
+
+    std::size_t pieces = 0;
+    std::string got;
+    auto resp = hope::io::http::fetch("PUT", url(), "data", "X-Client: test\r\n", [&](std::span<const char> part) {
+        ++pieces;
+        got.append(part.data(), part.size());
+    });
+    EXPECT_EQ(resp.status, 201);
+    ASSERT_NE(resp.header("x-request"), nullptr);
+    EXPECT_EQ(*resp.header("x-request"), "7");
+    EXPECT_TRUE(resp.body.empty());
+    EXPECT_EQ(got, payload);
+    EXPECT_GT(pieces, 1u);
+
+    auto collected = hope::io::http::fetch("GET", url());
+    EXPECT_EQ(collected.body, payload);
+    EXPECT_EQ(accepted.load(), 1);
+}
+
+#endif
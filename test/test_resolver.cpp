@@ -0,0 +1,228 @@
+/* Copyright (C) 2026 Gleb Bezborodov - All Rights Reserved
+ * You may use, distribute and modify this code under the
+ * terms of the MIT license.
+ *
+ * You should have received a copy of the MIT license with
+ * this file. If not, please write to: bezborodoff.gleb@gmail.com, or visit : https://github.com/glensand/hope-io
+ */
+
+#include <gtest/gtest.h>
+#include "hope-io/coredefs.h"
+
+#if PLATFORM_LINUX
+
+#include "hope-io/net/resolver.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <netdb.h>
+
+using namespace std::chrono_literals;
+
+class ResolverTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        hosts_path = "/tmp/hope-io-hosts-" + std::to_string(getpid());
+        std::ofstream out(hosts_path);
+        out << "# local stand-in for DNS\n"
+            << "10.1.2.3    Service.Test svc    # inline comment\n"
+            << "::1         v6only.test\n"
+            << "127.0.0.1   dual.test\n"
+            << "::1         dual.test\n"
+            << "not-an-ip   broken.test\n";
+    }
+
+    void TearDown() override {
+        std::remove(hosts_path.c_str());
+    }
+
+    hope::io::resolver_options options() const {
+        hope::io::resolver_options o;
+        o.hosts_file = hosts_path;
+        return o;
+    }
+
+    std::string hosts_path;
+};
+
+TEST_F(ResolverTest, HostsFileNames) {
+    hope::io::resolver res(options());
+
+    auto r = res.resolve("service.test", 8080);
+    ASSERT_EQ(r.addresses.size(), 1u);
+    EXPECT_EQ(r.addresses[0].host(), "10.1.2.3");
+    EXPECT_EQ(r.addresses[0].port(), 8080);
+
+    // Names are case-insensitive and a trailing dot is the same name
+    EXPECT_EQ(res.resolve("SERVICE.TEST.", 1).addresses.size(), 1u);
+    EXPECT_EQ(res.resolve("svc", 1).addresses.size(), 1u);
+    EXPECT_EQ(res.resolve("dual.test", 1).addresses.size(), 2u);
+
+    auto s = res.get_stats();
+    EXPECT_EQ(s.hits, 4u);
+    EXPECT_EQ(s.misses, 0u);
+}
+
+TEST_F(ResolverTest, MissingHostsFileThrows) {
+    hope::io::resolver_options o;
+    o.hosts_file = "/nonexistent/hosts";
+    EXPECT_THROW(hope::io::resolver{o}, std::exception);
+}
+
+TEST_F(ResolverTest, NumericBypassesCache) {
+    hope::io::resolver res(options());
+    auto r = res.resolve("::1", 443);
+    ASSERT_EQ(r.addresses.size(), 1u);
+    EXPECT_EQ(r.addresses[0].family(), AF_INET6);
+    EXPECT_EQ(r.addresses[0].port(), 443);
+    EXPECT_EQ(res.resolve("127.0.0.1", 1).addresses[0].family(), AF_INET);
+
+    auto s = res.get_stats();
+    EXPECT_EQ(s.hits + s.misses + s.negative_hits, 0u);
+}
+
+TEST_F(ResolverTest, PickFamily) {
+    hope::io::resolver res(options());
+    hope::io::endpoint ep;
+
+    auto v4 = res.resolve("service.test", 9);
+    ASSERT_TRUE(v4.pick(AF_INET, ep));
+    EXPECT_EQ(ep.family(), AF_INET);
+    ASSERT_TRUE(v4.pick(AF_INET6, ep)); // reachable as ::ffff:10.1.2.3
+    EXPECT_EQ(ep.family(), AF_INET6);
+    EXPECT_EQ(ep.host(), "10.1.2.3");
+    EXPECT_EQ(ep.port(), 9);
+
+    auto v6 = res.resolve("v6only.test", 9);
+    EXPECT_FALSE(v6.pick(AF_INET, ep));
+    ASSERT_TRUE(v6.pick(AF_UNSPEC, ep));
+    EXPECT_EQ(ep.host(), "::1");
+}
+
+TEST_F(ResolverTest, NegativeCaching) {
+    auto o = options();
+    o.negative_ttl = 100ms;
+    hope::io::resolver res(o);
+
+    // An empty label is refused before any query goes out: a lasting failure even without
+    // a reachable DNS server, whose absence (EAI_AGAIN) is not cached
+    auto first = res.resolve("nothing..here.invalid", 80);
+    EXPECT_TRUE(first.addresses.empty());
+    EXPECT_NE(first.error, 0);
+
+    auto second = res.resolve("nothing..here.invalid", 80);
+    EXPECT_TRUE(second.addresses.empty());
+    EXPECT_EQ(second.error, first.error);
+
+    auto s = res.get_stats();
+    EXPECT_EQ(s.misses, 1u);
+    EXPECT_EQ(s.negative_hits, 1u);
+
+    std::this_thread::sleep_for(150ms);
+    res.resolve("nothing..here.invalid", 80);
+    EXPECT_EQ(res.get_stats().misses, 2u);
+}
+
+TEST_F(ResolverTest, TemporaryFailureNotCached) {
+    hope::io::resolver res(options());
+
+    auto first = res.resolve("nothing-here.invalid", 80);
+    if (first.error != EAI_AGAIN) GTEST_SKIP() << "DNS answers here, no temporary failure";
+    res.resolve("nothing-here.invalid", 80);
+    auto s = res.get_stats();
+    EXPECT_EQ(s.misses, 2u);
+    EXPECT_EQ(s.negative_hits, 0u);
+}
+
+TEST_F(ResolverTest, PositiveTtlExpires) {
+    auto o = options();
+    o.ttl = 100ms;
+    hope::io::resolver res(o);
+
+    auto first = res.resolve("localhost", 80);
+    if (first.addresses.empty()) GTEST_SKIP() << "localhost does not resolve here";
+    res.resolve("LOCALHOST", 81);
+    EXPECT_EQ(res.get_stats().misses, 1u);
+    EXPECT_EQ(res.get_stats().hits, 1u);
+
+    std::this_thread::sleep_for(150ms);
+    res.resolve("localhost", 80);
+    EXPECT_EQ(res.get_stats().misses, 2u);
+
+    res.clear();
+    res.resolve("localhost", 80);
+    EXPECT_EQ(res.get_stats().misses, 3u);
+}
+
+TEST_F(ResolverTest, AsyncCoalescesMisses) {
+    hope::io::resolver res(options());
+
+    constexpr int callers = 16;
+    std::mutex lock;
+    std::condition_variable done;
+    int answered = 0;
+    std::atomic<int> failed{0};
+    for (int i = 0; i < callers; ++i) {
+        res.resolve_async("nothing..here.invalid", (uint16_t)(1000 + i), [&](const hope::io::resolver::result& r) {
+            if (!r.addresses.empty() || r.error == 0) ++failed;
+            std::lock_guard g(lock);
+            ++answered;
+            done.notify_one();
+        });
+    }
+    {
+        std::unique_lock g(lock);
+        ASSERT_TRUE(done.wait_for(g, 10s, [&] { return answered == callers; }));
+    }
+    EXPECT_EQ(failed.load(), 0);
+    EXPECT_EQ(res.get_stats().misses, 1u);
+
+    // Now cached: the callback runs inline on this thread
+    bool inline_call = false;
+    res.resolve_async("nothing..here.invalid", 1, [&](const hope::io::resolver::result&) { inline_call = true; });
+    EXPECT_TRUE(inline_call);
+
+    auto caller = std::this_thread::get_id();
+    std::thread::id called_on;
+    res.resolve_async("svc", 7, [&](const hope::io::resolver::result& r) {
+        called_on = std::this_thread::get_id();
+        ASSERT_EQ(r.addresses.size(), 1u);
+        EXPECT_EQ(r.addresses[0].port(), 7);
+    });
+    EXPECT_EQ(called_on, caller);
+}
+
+TEST_F(ResolverTest, ShutdownCompletesQueuedLookups) {
+    std::atomic<bool> busy{false};
+    std::atomic<int> queued_calls{0};
+    int queued_error = 0;
+    {
+        auto o = options();
+        o.workers = 1;
+        hope::io::resolver res(o);
+
+        // Hold the only worker in a callback while a second name is queued behind it
+        res.resolve_async("first.invalid", 1, [&](const hope::io::resolver::result&) {
+            busy = true;
+            std::this_thread::sleep_for(200ms);
+        });
+        for (int i = 0; i < 1000 && !busy; ++i) {
+            std::this_thread::sleep_for(1ms);
+        }
+        ASSERT_TRUE(busy.load());
+        res.resolve_async("second.invalid", 2, [&](const hope::io::resolver::result& r) {
+            queued_error = r.addresses.empty() ? r.error : 0;
+            ++queued_calls;
+        });
+    }
+    EXPECT_EQ(queued_calls.load(), 1);
+    EXPECT_EQ(queued_error, EAI_AGAIN);
+}
+
+#endif
@@ -170,6 +170,50 @@ TEST_F(TcpAcceptorTest, OptionsAppliedToAcceptedConnections) {
     delete acceptor;
 }
 
+#if PLATFORM_LINUX || PLATFORM_APPLE
+// The default listener is dual-stack: IPv6 and IPv4 clients, peers print in their own family
+TEST_F(TcpAcceptorTest, DualStackAcceptsBothFamilies) {
+    hope::io::tcp_acceptor acceptor;
+    acceptor.open(test_port);
+
+    for (const std::string host : { "::1", "127.0.0.1" }) {
+        std::thread client_thread([this, host]() {
+            hope::io::tcp_stream client;
+            client.connect(host, test_port);
+            std::this_thread::sleep_for(50ms);
+        });
+        std::unique_ptr<hope::io::stream> conn(acceptor.accept());
+        EXPECT_EQ(conn->get_endpoint(), host);
+        client_thread.join();
+    }
+}
+
+// bind_address narrows the listener to one address and family
+TEST_F(TcpAcceptorTest, BindAddress) {
+    hope::io::stream_options opts;
+    opts.bind_address = "127.0.0.1";
+    hope::io::tcp_acceptor acceptor(opts);
+    acceptor.open(test_port);
+
+    hope::io::tcp_stream v6;
+    EXPECT_THROW(v6.connect("::1", test_port), std::exception);
+
+    std::thread client_thread([this]() {
+        hope::io::tcp_stream client;
+        client.connect("127.0.0.1", test_port);
+        std::this_thread::sleep_for(50ms);
+    });
+    std::unique_ptr<hope::io::stream> conn(acceptor.accept());
+    EXPECT_EQ(conn->get_endpoint(), "127.0.0.1");
+    client_thread.join();
+
+    hope::io::stream_options bad;
+    bad.bind_address = "not-an-address";
+    hope::io::tcp_acceptor rejected(bad);
+    EXPECT_THROW(rejected.open(test_port + 1000), std::exception);
+}
+#endif
+
 // Test acceptor open on already used port (should fail)
 TEST_F(TcpAcceptorTest, OpenOnUsedPort) {
     auto* acceptor1 = new hope::io::tcp_acceptor();
@@ -18,8 +18,17 @@
 #include <cstring>
 #include <vector>
 #include <functional>
+#include <fstream>
+#include <cstdio>
 #include <atomic>
 
+#if PLATFORM_LINUX
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
 using namespace std::chrono_literals;
 
 class TcpStreamTest : public ::testing::Test {
@@ -150,6 +159,112 @@ TEST_F(TcpStreamTest, ConnectionToClosedPort) {
     delete client;
 }
 
+#if PLATFORM_LINUX
+// A listener whose accept queue is full drops further SYNs, the handshake never completes:
+// connection_timeout has to cut it short instead of the kernel SYN retries
+TEST_F(TcpStreamTest, ConnectTimeoutEnforced) {
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_NE(listener, -1);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(bind(listener, (sockaddr*)&addr, sizeof(addr)), 0);
+    ASSERT_EQ(listen(listener, 0), 0);
+    socklen_t len = sizeof(addr);
+    getsockname(listener, (sockaddr*)&addr, &len);
+
+    std::vector<int> fillers;
+    for (int i = 0; i < 4; ++i) {
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        ::connect(fd, (sockaddr*)&addr, sizeof(addr));
+        fillers.push_back(fd);
+    }
+    std::this_thread::sleep_for(50ms);
+
+    hope::io::stream_options opts;
+    opts.connection_timeout = 200;
+    hope::io::tcp_stream client(static_cast<unsigned long long>(-1), opts);
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_THROW(client.connect("127.0.0.1", ntohs(addr.sin_port)), std::exception);
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    EXPECT_GE(elapsed, 150);
+    EXPECT_LE(elapsed, 1000);
+
+    for (auto fd : fillers) ::close(fd);
+    ::close(listener);
+}
+
+// Names with several addresses race them; a refused address hands over at once
+TEST_F(TcpStreamTest, ConnectByHostName) {
+    std::thread server_thread([this]() {
+        auto* conn = acceptor->accept();
+        delete conn;
+    });
+    std::this_thread::sleep_for(50ms);
+
+    hope::io::tcp_stream client;
+    auto start = std::chrono::steady_clock::now();
+    ASSERT_NO_THROW(client.connect("localhost", test_port));
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    EXPECT_LE(elapsed, 200);
+    EXPECT_EQ(client.get_endpoint(), "127.0.0.1");
+    client.disconnect();
+
+    server_thread.join();
+}
+#endif
+
+TEST_F(TcpStreamTest, StreamInReadsToClose) {
+    const std::string payload(100000, 'z');
+    std::thread server_thread([this, &payload]() {
+        auto* conn = acceptor->accept();
+        conn->write(payload.data(), payload.size());
+        delete conn;
+    });
+
+    hope::io::tcp_stream client;
+    client.connect("127.0.0.1", test_port);
+    std::string received;
+    client.stream_in(received);
+    EXPECT_EQ(received, payload);
+
+    server_thread.join();
+}
+
+#if PLATFORM_LINUX || PLATFORM_APPLE
+TEST_F(TcpStreamTest, WriteFileSendsRange) {
+    const std::string path = "/tmp/hope-io-write-file-" + std::to_string(test_port);
+    std::string content(1 << 20, '\0');
+    for (std::size_t i = 0; i < content.size(); ++i) content[i] = (char)(i * 131 % 251);
+    {
+        std::ofstream out(path, std::ios::binary);
+        out.write(content.data(), (std::streamsize)content.size());
+    }
+
+    std::string received;
+    std::thread server_thread([this, &received]() {
+        auto* conn = acceptor->accept();
+        conn->stream_in(received);
+        delete conn;
+    });
+
+    {
+        hope::io::tcp_stream client;
+        client.connect("127.0.0.1", test_port);
+        client.write_file(path, 4097, content.size() - 5000);
+        EXPECT_THROW(client.write_file(path, content.size() - 10, 11), std::exception);
+        EXPECT_THROW(client.write_file(path + ".missing", 0, 1), std::exception);
+    }
+    server_thread.join();
+    // The range, then the 10 bytes the short request got out before it hit EOF
+    const auto expected = content.substr(4097, content.size() - 5000) + content.substr(content.size() - 10);
+    EXPECT_TRUE(received == expected);
+    std::remove(path.c_str());
+}
+#endif
+
 // Test that read timeout is actually enforced (Unix only, Windows applies during connect)
 #if PLATFORM_LINUX || PLATFORM_APPLE
 TEST_F(TcpStreamTest, ReadTimeoutEnforced) {
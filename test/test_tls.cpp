@@ -19,7 +19,9 @@
 #include <fstream>
 #include <sstream>
 #include <atomic>
+#include <cstdio>
 #include <filesystem>
+#include <memory>
 namespace fs = std::filesystem;
 
 using namespace std::chrono_literals;
@@ -122,6 +124,247 @@ TEST_F(TlsTest, KtlsFlagDoesNotBreakStream) {
     delete tls;
 }
 
+// RFC 8448 3: server handshake and application traffic secrets of the simple 1-RTT handshake
+TEST_F(TlsTest, KtlsTls13KeysFromTrafficSecret) {
+    auto from_hex = [](std::string_view hex) {
+        std::vector<uint8_t> out;
+        for (std::size_t i = 0; i + 1 < hex.size(); i += 2) {
+            out.push_back((uint8_t)std::stoi(std::string(hex.substr(i, 2)), nullptr, 16));
+        }
+        return out;
+    };
+    struct vector_t { const char* secret; const char* key; const char* iv; };
+    const vector_t vectors[] = {
+        { "b67b7d690cc16c4e75e54213cb2d37b4e9c912bcded9105d42befd59d391ad38",
+          "3fce516009c21727d0f2e4e86ee403bc", "5d313eb2671276ee13000b30" },
+        { "a11af9f05531f856ad47116b45a950328204b4f44bfb6b3a4b4f1f3fcb631643",
+          "9f02283b6c9c07efc26bb9f2ac92e356", "cf782b88dd83549aadf1e984" },
+    };
+    for (auto& v : vectors) {
+        const auto secret = from_hex(v.secret);
+        std::vector<uint8_t> key(16), iv(12);
+        ASSERT_TRUE(hope::io::derive_tls13_traffic_keys(EVP_sha256(), secret, key, iv));
+        EXPECT_EQ(key, from_hex(v.key));
+        EXPECT_EQ(iv, from_hex(v.iv));
+    }
+
+    // AES-256-GCM / ChaCha20 keys are 32 bytes, still one SHA-256 block; more is refused
+    const auto secret = from_hex(vectors[0].secret);
+    std::vector<uint8_t> key(32), iv(12), too_long(33);
+    EXPECT_TRUE(hope::io::derive_tls13_traffic_keys(EVP_sha256(), secret, key, iv));
+    EXPECT_FALSE(hope::io::derive_tls13_traffic_keys(EVP_sha256(), secret, too_long, iv));
+}
+
+// Every attempt lands in ktls_stats, whichever record layer the connection ends up on
+#if PLATFORM_LINUX
+TEST_F(TlsTest, KtlsAttemptIsCounted) {
+    if (!hasTestCertificates()) {
+        GTEST_SKIP() << "TLS test certificates not available";
+    }
+    std::string key_path;
+    for (auto* p : { "../test/certs/key.pem", "../../test/certs/key.pem", "test/certs/key.pem" }) {
+        if (fs::exists(p)) {
+            key_path = p;
+            break;
+        }
+    }
+    const auto cert_path = key_path.substr(0, key_path.find("key.pem")) + "cert.pem";
+
+    hope::io::tls_acceptor_impl acceptor(key_path, cert_path);
+    acceptor.set_ktls_enabled(true);
+    acceptor.open(test_port);
+
+    const auto before = hope::io::ktls_stats();
+    std::string received(5, '\0');
+    std::thread server([&] {
+        std::unique_ptr<hope::io::stream> conn(acceptor.accept());
+        conn->read(received.data(), received.size());
+        conn->write("world", 5);
+    });
+
+    hope::io::tcp_tls_stream client;
+    client.set_ktls_enabled(true);
+    client.connect("127.0.0.1", test_port);
+    client.write("hello", 5);
+    char reply[5];
+    client.read(reply, sizeof(reply));
+    server.join();
+
+    EXPECT_EQ(received, "hello");
+    EXPECT_EQ(std::string_view(reply, sizeof(reply)), "world");
+    const auto after = hope::io::ktls_stats();
+    const auto attempts = [](const hope::io::ktls_counters& c) { return c.kernel + c.unsupported + c.refused + c.broken; };
+    EXPECT_EQ(attempts(after) - attempts(before), 2u);  // server and client
+    acceptor.close();
+}
+#endif
+
+// write_file: mmap + SSL_write, or sendfile when kTLS came up on the connection
+#if PLATFORM_LINUX
+TEST_F(TlsTest, WriteFileOverTls) {
+    if (!hasTestCertificates()) {
+        GTEST_SKIP() << "TLS test certificates not available";
+    }
+    std::string key_path;
+    for (auto* p : { "../test/certs/key.pem", "../../test/certs/key.pem", "test/certs/key.pem" }) {
+        if (fs::exists(p)) {
+            key_path = p;
+            break;
+        }
+    }
+    const auto cert_path = key_path.substr(0, key_path.find("key.pem")) + "cert.pem";
+
+    const std::string path = "/tmp/hope-io-tls-file-" + std::to_string(test_port);
+    std::string content(40 * 1024 * 1024 + 123, '\0'); // spans several mmap windows
+    for (std::size_t i = 0; i < content.size(); i += 4093) content[i] = (char)(i % 251);
+    {
+        std::ofstream out(path, std::ios::binary);
+        out.write(content.data(), (std::streamsize)content.size());
+    }
+    const std::size_t offset = 5000;
+    const auto length = content.size() - offset;
+
+    for (bool ktls : { false, true }) {
+        hope::io::tls_acceptor_impl acceptor(key_path, cert_path);
+        acceptor.set_ktls_enabled(ktls);
+        acceptor.open(test_port);
+
+        std::string received(length, '\0');
+        std::thread server([&] {
+            std::unique_ptr<hope::io::stream> conn(acceptor.accept());
+            conn->read(received.data(), received.size());
+        });
+
+        {
+            hope::io::tcp_tls_stream client;
+            client.set_ktls_enabled(ktls);
+            client.connect("127.0.0.1", test_port);
+            client.write_file(path, offset, length);
+            EXPECT_THROW(client.write_file(path, content.size() - 1, 2), std::exception);
+            server.join();
+        }
+        EXPECT_TRUE(received == std::string_view(content).substr(offset)) << "ktls requested: " << ktls;
+        acceptor.close();
+        ++test_port;
+    }
+    std::remove(path.c_str());
+}
+#endif
+
+// Reconnects resume through tls_session_cache, keyed by host:port
+#if PLATFORM_LINUX
+TEST_F(TlsTest, ReconnectResumesSession) {
+    if (!hasTestCertificates()) {
+        GTEST_SKIP() << "TLS test certificates not available";
+    }
+    std::string key_path;
+    for (auto* p : { "../test/certs/key.pem", "../../test/certs/key.pem", "test/certs/key.pem" }) {
+        if (fs::exists(p)) {
+            key_path = p;
+            break;
+        }
+    }
+    const auto cert_path = key_path.substr(0, key_path.find("key.pem")) + "cert.pem";
+
+    constexpr int connections = 4;
+    hope::io::tls_acceptor_impl acceptor(key_path, cert_path);
+    acceptor.open(test_port);
+    std::string early_seen;
+    std::thread server([&] {
+        for (int i = 0; i < connections; ++i) {
+            std::unique_ptr<hope::io::stream> conn(acceptor.accept());
+            conn->write("x", 1);
+            char request[5] = {};
+            conn->read(request, 4);
+            if (i == connections - 1) early_seen = request;
+        }
+    });
+
+    hope::io::tls_session_cache cache;
+    auto round_trip = [&](hope::io::tcp_tls_stream& client) {
+        char c;
+        client.read(&c, 1); // a TLS 1.3 ticket arrives after the handshake, with the first read
+        client.write("ping", 4);
+        client.disconnect();
+    };
+
+    hope::io::tcp_tls_stream client;
+    client.set_session_cache(&cache);
+    client.connect("127.0.0.1", test_port);
+    EXPECT_FALSE(client.session_reused());
+    round_trip(client);
+    EXPECT_GT(cache.size(), 0u);
+
+    client.connect("127.0.0.1", test_port);
+    EXPECT_TRUE(client.session_reused());
+    round_trip(client);
+
+    // Another endpoint key has nothing to offer
+    hope::io::tcp_tls_stream uncached;
+    uncached.set_session_cache(nullptr);
+    uncached.connect("127.0.0.1", test_port);
+    EXPECT_FALSE(uncached.session_reused());
+    round_trip(uncached);
+
+    // Without 0-RTT on the server the request still arrives, after the handshake
+    hope::io::tcp_tls_stream early;
+    early.set_session_cache(&cache);
+    const std::string request = "GET!";
+    EXPECT_FALSE(early.connect_early("127.0.0.1", test_port, request));
+    char c;
+    early.read(&c, 1);
+    server.join();
+    EXPECT_EQ(early_seen, request);
+    acceptor.close();
+}
+#endif
+
+// A kTLS client still reads the TLS 1.3 ticket through SSL, so the next connect resumes
+#if PLATFORM_LINUX
+TEST_F(TlsTest, ReconnectResumesSessionWithKtls) {
+    if (!hasTestCertificates()) {
+        GTEST_SKIP() << "TLS test certificates not available";
+    }
+    std::string key_path;
+    for (auto* p : { "../test/certs/key.pem", "../../test/certs/key.pem", "test/certs/key.pem" }) {
+        if (fs::exists(p)) {
+            key_path = p;
+            break;
+        }
+    }
+    const auto cert_path = key_path.substr(0, key_path.find("key.pem")) + "cert.pem";
+
+    constexpr int connections = 2;
+    hope::io::tls_acceptor_impl acceptor(key_path, cert_path);
+    acceptor.set_ktls_enabled(true);
+    acceptor.open(test_port);
+    std::thread server([&] {
+        for (int i = 0; i < connections; ++i) {
+            std::unique_ptr<hope::io::stream> conn(acceptor.accept());
+            conn->write("x", 1);
+            char request[4];
+            conn->read(request, sizeof(request));
+        }
+    });
+
+    hope::io::tls_session_cache cache;
+    hope::io::tcp_tls_stream client;
+    client.set_session_cache(&cache);
+    for (int i = 0; i < connections; ++i) {
+        client.set_ktls_enabled(true);
+        client.connect("127.0.0.1", test_port);
+        EXPECT_EQ(client.session_reused(), i > 0);
+        char c;
+        client.read(&c, 1);
+        client.write("ping", 4);
+        client.disconnect();
+        EXPECT_GT(cache.size(), 0u);
+    }
+    server.join();
+    acceptor.close();
+}
+#endif
+
 // ── KTLS Event Loop Integration ───────────────────────────────────────
 
 // Test that setting enable_ktls in tls_config doesn't break the event loop.
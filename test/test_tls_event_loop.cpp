@@ -14,13 +14,21 @@
 #include "hope-io/net/nix/tls_event_loop_impl.h"
 #include "hope-io/net/linux/tls_event_loop_impl.h"
 #include "hope-io/net/tls/tcp_tls_stream.h"
+#include "hope-io/net/linux/tls_key_offload.h"
 #include "hope-io/net/init.h"
+#if PLATFORM_LINUX && __has_include(<liburing.h>)
+#include "hope-io/net/uring/uring_tls_event_loop.h"
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
 #include <thread>
 #include <chrono>
 #include <atomic>
 #include <fstream>
 #include <sstream>
 #include <vector>
+#include <poll.h>
 
 using namespace std::chrono_literals;
 using namespace hope::io::el;
@@ -477,4 +485,596 @@ TEST_F(TlsEventLoopTest, KtlsStreamFlagDoesNotBreakConnect) {
     delete tls;
 }
 
+// ── Handshake key offload ──────────────────────────────────────────────
+
+#if PLATFORM_LINUX
+
+// A client trickling its ClientHello does not extend the handshake deadline
+TEST_F(TlsEventLoopTest, TlsHandshakeDeadlineDropsSlowClient) {
+    if (!certs_available()) {
+        GTEST_SKIP() << "TLS certificates not available";
+    }
+
+    std::atomic<int> timeouts{0};
+    std::atomic<int> connect_count{0};
+    auto on_connect = [&connect_count](connection&) {
+        connect_count++;
+        return el_connection_state::read;
+    };
+    auto on_read = [](connection&) { return el_connection_state::write; };
+    auto on_write = [](connection&) { return el_connection_state::read; };
+    auto on_err = [&timeouts](connection&, const std::string& msg) {
+        if (msg.find("handshake timeout") != std::string::npos) timeouts++;
+        return el_connection_state::die;
+    };
+
+    auto cfg = make_tls_config(test_port, cert_path(), key_path());
+    cfg.handshake_timeout_ms = 300;
+    auto guard = make_tls_guard(cfg, std::move(on_connect), std::move(on_read),
+                                std::move(on_write), std::move(on_err));
+    std::this_thread::sleep_for(100ms);
+
+    hope::io::tcp_stream slow;
+    slow.connect("127.0.0.1", test_port);
+    const uint8_t record_header[] = { 0x16, 0x03, 0x01 }; // handshake record, never completed
+    for (auto byte : record_header) {
+        slow.write(&byte, 1);
+        std::this_thread::sleep_for(80ms);
+    }
+    const auto deadline = std::chrono::steady_clock::now() + 2s;
+    while (timeouts.load() == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(20ms);
+    }
+    EXPECT_EQ(timeouts.load(), 1);
+
+    // The loop is still serving handshakes
+    hope::io::tcp_tls_stream tls;
+    tls.connect("127.0.0.1", test_port);
+    tls.disconnect();
+    std::this_thread::sleep_for(100ms);
+    EXPECT_EQ(connect_count.load(), 1);
+}
+
+TEST_F(TlsEventLoopTest, KeyOffloadSignsOnWorkers) {
+    if (!certs_available()) {
+        GTEST_SKIP() << "TLS certificates not available";
+    }
+
+    SSL_CTX* ctx = SSL_CTX_new(TLS_server_method());
+    ASSERT_EQ(SSL_CTX_use_certificate_file(ctx, cert_path().c_str(), SSL_FILETYPE_PEM), 1);
+    ASSERT_EQ(SSL_CTX_use_PrivateKey_file(ctx, key_path().c_str(), SSL_FILETYPE_PEM), 1);
+    EVP_PKEY* key = SSL_CTX_get0_privatekey(ctx);
+
+    constexpr uint16_t rsa_pss_rsae_sha256 = 0x0804;
+    const std::string message = "server certificate verify input";
+    constexpr int handshakes = 16;
+    {
+        tls_key_offload offload(key, 2, 4);
+        offload.install(ctx);
+
+        std::vector<SSL*> ssls;
+        for (int i = 0; i < handshakes; ++i) {
+            ssls.push_back(SSL_new(ctx));
+            EXPECT_EQ(offload.start(ssls.back(), true, rsa_pss_rsae_sha256,
+                                    (const uint8_t*)message.data(), message.size()), ssl_private_key_retry);
+        }
+        // Freed with its job queued or running: the worker drops it
+        SSL* dropped = SSL_new(ctx);
+        offload.start(dropped, true, rsa_pss_rsae_sha256, (const uint8_t*)message.data(), message.size());
+        SSL_free(dropped);
+
+        uint8_t sig[512];
+        std::size_t sig_len = 0;
+        EXPECT_EQ(offload.complete(ssls[0], sig, &sig_len, sizeof(sig)), ssl_private_key_retry);
+
+        std::vector<SSL*> resumed;
+        const auto deadline = std::chrono::steady_clock::now() + 5s;
+        while ((int)resumed.size() < handshakes && std::chrono::steady_clock::now() < deadline) {
+            pollfd p{ offload.fd(), POLLIN, 0 };
+            if (poll(&p, 1, 100) > 0) {
+                offload.drain([&](SSL* ssl) { resumed.push_back(ssl); });
+            }
+        }
+        ASSERT_EQ((int)resumed.size(), handshakes);
+        const auto stats = offload.get_stats();
+        EXPECT_GE(stats.operations, (uint64_t)handshakes);
+        EXPECT_LE(stats.batches, stats.operations);
+        EXPECT_EQ(stats.failures, 0u);
+
+        for (auto* ssl : resumed) {
+            ASSERT_EQ(offload.complete(ssl, sig, &sig_len, sizeof(sig)), ssl_private_key_success);
+            EVP_MD_CTX* md = EVP_MD_CTX_new();
+            EVP_PKEY_CTX* pctx = nullptr;
+            ASSERT_EQ(EVP_DigestVerifyInit(md, &pctx, EVP_sha256(), nullptr, key), 1);
+            EVP_PKEY_CTX_set_rsa_padding(pctx, RSA_PKCS1_PSS_PADDING);
+            EXPECT_EQ(EVP_DigestVerify(md, sig, sig_len, (const uint8_t*)message.data(), message.size()), 1);
+            EVP_MD_CTX_free(md);
+        }
+        for (auto* ssl : ssls) {
+            SSL_free(ssl);
+        }
+    }
+    SSL_CTX_free(ctx);
+}
+
+TEST_F(TlsEventLoopTest, TlsEchoWithHandshakeWorkers) {
+    if (!certs_available()) {
+        GTEST_SKIP() << "TLS certificates not available";
+    }
+
+    std::atomic<int> error_count{0};
+    auto on_connect = [](connection&) { return el_connection_state::read; };
+    auto on_read = [](connection&) { return el_connection_state::write; };
+    auto on_write = [](connection&) { return el_connection_state::read; };
+    auto on_err = [&error_count](connection&, const std::string&) {
+        error_count++;
+        return el_connection_state::die;
+    };
+
+    auto cfg = make_tls_config(test_port, cert_path(), key_path());
+    cfg.handshake_workers = 2;
+    auto guard = make_tls_guard(cfg, std::move(on_connect), std::move(on_read),
+                                std::move(on_write), std::move(on_err));
+    std::this_thread::sleep_for(100ms);
+
+    for (int i = 0; i < 3; ++i) {
+        hope::io::tcp_tls_stream tls;
+        tls.connect("127.0.0.1", test_port);
+        const std::string msg = "offloaded handshake " + std::to_string(i);
+        tls.write(msg.data(), msg.size());
+        std::string reply(msg.size(), '\0');
+        std::size_t total = 0;
+        while (total < msg.size()) {
+            auto n = tls.read_once(reply.data() + total, msg.size() - total);
+            if (n == 0) break;
+            total += n;
+        }
+        EXPECT_EQ(reply, msg);
+        tls.disconnect();
+    }
+    std::this_thread::sleep_for(100ms);
+    EXPECT_EQ(error_count.load(), 0);
+}
+
+
+#if __has_include(<liburing.h>)
+
+// ── io_uring TLS loop ──────────────────────────────────────────────────
+
+template<typename TOnRead, typename TOnWrite, typename TOnError, typename TConnected>
+auto make_uring_tls_guard(tls_config& cfg,
+                          TConnected&& on_connect, TOnRead&& on_read, TOnWrite&& on_write, TOnError&& on_error) {
+    using loop_t = uring_tls_event_loop<TOnRead, TOnWrite, TOnError, TConnected>;
+    TlsEventLoopGuard<loop_t> guard;
+    guard.start(new loop_t(std::forward<TConnected>(on_connect), std::forward<TOnRead>(on_read),
+                           std::forward<TOnWrite>(on_write), std::forward<TOnError>(on_error)), cfg);
+    return guard;
+}
+
+// TLS client over memory BIOs on a plain socket: the test decides what leaves in one segment
+struct segment_tls_client {
+    int fd = -1;
+    SSL_CTX* ctx = nullptr;
+    SSL* ssl = nullptr;
+    BIO* rbio = nullptr;
+    BIO* wbio = nullptr;
+
+    explicit segment_tls_client(std::size_t port) {
+        fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons((uint16_t)port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (::connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+            ::close(fd);
+            fd = -1;
+        }
+        ctx = SSL_CTX_new(TLS_client_method());
+        ssl = SSL_new(ctx);
+        rbio = BIO_new(BIO_s_mem());
+        wbio = BIO_new(BIO_s_mem());
+        BIO_set_mem_eof_return(rbio, -1);
+        SSL_set_bio(ssl, rbio, wbio);
+        SSL_set_connect_state(ssl);
+    }
+
+    ~segment_tls_client() {
+        SSL_free(ssl);
+        SSL_CTX_free(ctx);
+        if (fd != -1) ::close(fd);
+    }
+
+    // Everything SSL produced so far in one send()
+    bool flush() {
+        std::vector<char> out(BIO_ctrl_pending(wbio));
+        if (out.empty()) return true;
+        BIO_read(wbio, out.data(), (int)out.size());
+        return ::send(fd, out.data(), out.size(), MSG_NOSIGNAL) == (ssize_t)out.size();
+    }
+
+    bool fill() {
+        char in[16 * 1024];
+        auto n = ::recv(fd, in, sizeof(in), 0);
+        if (n <= 0) return false;
+        BIO_write(rbio, in, (int)n);
+        return true;
+    }
+
+    // TLS 1.3: the client Finished is the last handshake flight, early leaves in its segment
+    bool handshake(const std::string& early = {}) {
+        while (true) {
+            int ret = SSL_do_handshake(ssl);
+            if (ret == 1) break;
+            if (SSL_get_error(ssl, ret) != SSL_ERROR_WANT_READ || !flush() || !fill()) return false;
+        }
+        if (!early.empty() && SSL_write(ssl, early.data(), (int)early.size()) <= 0) return false;
+        return flush();
+    }
+
+    bool write(const std::string& data) {
+        return SSL_write(ssl, data.data(), (int)data.size()) > 0 && flush();
+    }
+
+    std::string read(std::size_t n) {
+        std::string out(n, '\0');
+        std::size_t got = 0;
+        while (got < n) {
+            int r = SSL_read(ssl, out.data() + got, (int)(n - got));
+            if (r > 0) {
+                got += (std::size_t)r;
+            } else if (SSL_get_error(ssl, r) != SSL_ERROR_WANT_READ || !fill()) {
+                break;
+            }
+        }
+        out.resize(got);
+        return out;
+    }
+
+    // RST instead of FIN
+    void reset() {
+        linger l{ 1, 0 };
+        setsockopt(fd, SOL_SOCKET, SO_LINGER, &l, sizeof(l));
+        ::close(fd);
+        fd = -1;
+    }
+};
+
+std::string tls_round_trip(std::size_t port, const std::string& msg) {
+    hope::io::tcp_tls_stream tls;
+    tls.connect("127.0.0.1", port);
+    tls.write(msg.data(), msg.size());
+    std::string reply(msg.size(), '\0');
+    std::size_t total = 0;
+    while (total < msg.size()) {
+        auto n = tls.read_once(reply.data() + total, msg.size() - total);
+        if (n == 0) break;
+        total += n;
+    }
+    reply.resize(total);
+    tls.disconnect();
+    return reply;
+}
+
+TEST_F(TlsEventLoopTest, UringTlsEcho) {
+    if (!certs_available()) {
+        GTEST_SKIP() << "TLS certificates not available";
+    }
+
+    for (bool ktls : { false, true }) {
+        std::atomic<int> error_count{0};
+        auto on_connect = [](connection&) { return el_connection_state::read; };
+        auto on_read = [](connection&) { return el_connection_state::write; };
+        auto on_write = [](connection&) { return el_connection_state::read; };
+        auto on_err = [&error_count](connection&, const std::string&) {
+            error_count++;
+            return el_connection_state::die;
+        };
+
+        const auto port = test_port + (ktls ? 500 : 0);
+        auto cfg = make_tls_config(port, cert_path(), key_path());
+        cfg.enable_ktls = ktls;
+        auto guard = make_uring_tls_guard(cfg, std::move(on_connect), std::move(on_read),
+                                          std::move(on_write), std::move(on_err));
+        std::this_thread::sleep_for(100ms);
+
+        for (int i = 0; i < 3; ++i) {
+            const std::string msg = "uring echo " + std::to_string(i);
+            EXPECT_EQ(tls_round_trip(port, msg), msg) << "ktls " << ktls;
+        }
+        std::this_thread::sleep_for(100ms);
+        EXPECT_EQ(error_count.load(), 0) << "ktls " << ktls;
+    }
+}
+
+// A handler that asks to write with nothing queued gets on_write right away, the
+// connection must not sit there with neither RECV nor SEND armed
+TEST_F(TlsEventLoopTest, UringTlsWriteOnEmptyBufferCallsOnWrite) {
+    if (!certs_available()) {
+        GTEST_SKIP() << "TLS certificates not available";
+    }
+
+    std::atomic<int> write_count{0};
+    auto on_connect = [](connection&) { return el_connection_state::write; };
+    auto on_read = [](connection&) { return el_connection_state::write; };
+    auto on_write = [&write_count](connection&) {
+        write_count++;
+        return el_connection_state::read;
+    };
+    auto on_err = [](connection&, const std::string&) { return el_connection_state::die; };
+
+    auto cfg = make_tls_config(test_port, cert_path(), key_path());
+    cfg.enable_ktls = true;
+    auto guard = make_uring_tls_guard(cfg, std::move(on_connect), std::move(on_read),
+                                      std::move(on_write), std::move(on_err));
+    std::this_thread::sleep_for(100ms);
+
+    segment_tls_client client(test_port);
+    ASSERT_NE(client.fd, -1);
+    ASSERT_TRUE(client.handshake());
+    std::this_thread::sleep_for(100ms);
+    EXPECT_EQ(write_count.load(), 1);
+
+    ASSERT_TRUE(client.write("echo"));
+    EXPECT_EQ(client.read(4), "echo");
+    EXPECT_EQ(write_count.load(), 2);
+}
+
+// The request shares a segment with the client Finished: it sits in rbio once the
+// handshake completes, nothing would ever RECV it again
+TEST_F(TlsEventLoopTest, UringTlsAppDataWithClientFinished) {
+    if (!certs_available()) {
+        GTEST_SKIP() << "TLS certificates not available";
+    }
+
+    auto on_connect = [](connection&) { return el_connection_state::read; };
+    auto on_read = [](connection&) { return el_connection_state::write; };
+    auto on_write = [](connection&) { return el_connection_state::read; };
+    auto on_err = [](connection&, const std::string&) { return el_connection_state::die; };
+
+    auto cfg = make_tls_config(test_port, cert_path(), key_path());
+    cfg.enable_ktls = true;
+    auto guard = make_uring_tls_guard(cfg, std::move(on_connect), std::move(on_read),
+                                      std::move(on_write), std::move(on_err));
+    std::this_thread::sleep_for(100ms);
+
+    segment_tls_client client(test_port);
+    ASSERT_NE(client.fd, -1);
+    const std::string msg = "right behind Finished";
+    ASSERT_TRUE(client.handshake(msg));
+    EXPECT_EQ(client.read(msg.size()), msg);
+
+    // Later requests keep working on whichever record layer took over
+    ASSERT_TRUE(client.write("second"));
+    EXPECT_EQ(client.read(6), "second");
+}
+
+// A reply far bigger than the socket buffers leaves in many SENDs, each picking up
+// where the short one before it stopped
+TEST_F(TlsEventLoopTest, UringTlsLargeWriteSpansSends) {
+    if (!certs_available()) {
+        GTEST_SKIP() << "TLS certificates not available";
+    }
+
+    static constexpr std::size_t total = 8 * 1024 * 1024;
+    static constexpr std::size_t chunk = 256 * 1024;
+    auto pattern = [](std::size_t i) { return (char)((i * 31 + 7) & 0xff); };
+    std::size_t produced = 0;
+
+    auto fill = [&produced, pattern](connection& c) {
+        std::vector<char> data(std::min(chunk, total - produced));
+        for (auto& b : data) b = pattern(produced++);
+        c.buffer->write(data.data(), data.size());
+    };
+    auto on_connect = [](connection&) { return el_connection_state::read; };
+    auto on_read = [fill](connection& c) {
+        c.buffer->reset();
+        fill(c);
+        return el_connection_state::write;
+    };
+    auto on_write = [fill, &produced](connection& c) {
+        if (produced == total) return el_connection_state::read;
+        fill(c);
+        return el_connection_state::write;
+    };
+    auto on_err = [](connection&, const std::string&) { return el_connection_state::die; };
+
+    auto cfg = make_tls_config(test_port, cert_path(), key_path());
+    auto guard = make_uring_tls_guard(cfg, std::move(on_connect), std::move(on_read),
+                                      std::move(on_write), std::move(on_err));
+    std::this_thread::sleep_for(100ms);
+
+    segment_tls_client client(test_port);
+    ASSERT_NE(client.fd, -1);
+    int rcvbuf = 16 * 1024;
+    setsockopt(client.fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    ASSERT_TRUE(client.handshake());
+    ASSERT_TRUE(client.write("go"));
+    // Let the server run into a full socket before anything is read
+    std::this_thread::sleep_for(200ms);
+
+    auto reply = client.read(total);
+    ASSERT_EQ(reply.size(), total);
+    std::size_t mismatch = total;
+    for (std::size_t i = 0; i < total && mismatch == total; ++i) {
+        if (reply[i] != pattern(i)) mismatch = i;
+    }
+    EXPECT_EQ(mismatch, total);
+}
+
+// RST while the server waits on a RECV, and while its SEND is stuck on a full socket:
+// both complete with an error, the connection goes, the loop keeps serving
+TEST_F(TlsEventLoopTest, UringTlsPeerResetWithOpsInFlight) {
+    if (!certs_available()) {
+        GTEST_SKIP() << "TLS certificates not available";
+    }
+
+    std::atomic<int> connect_count{0};
+    int flood_left = 0;
+    auto refill = [](connection& c) {
+        std::vector<char> big(512 * 1024, 'x');
+        c.buffer->write(big.data(), big.size());
+    };
+    auto on_connect = [&connect_count](connection&) {
+        connect_count++;
+        return el_connection_state::read;
+    };
+    auto on_read = [&flood_left, refill](connection& c) {
+        // "flood" asks for a reply far beyond what the socket buffers hold
+        auto [data, size] = c.buffer->peek_used();
+        if (size != 0 && *(const char*)data == 'f') {
+            c.buffer->reset();
+            flood_left = 32;
+            refill(c);
+        }
+        return el_connection_state::write;
+    };
+    auto on_write = [&flood_left, refill](connection& c) {
+        if (flood_left == 0) return el_connection_state::read;
+        --flood_left;
+        refill(c);
+        return el_connection_state::write;
+    };
+    auto on_err = [](connection&, const std::string&) { return el_connection_state::die; };
+
+    auto cfg = make_tls_config(test_port, cert_path(), key_path());
+    auto guard = make_uring_tls_guard(cfg, std::move(on_connect), std::move(on_read),
+                                      std::move(on_write), std::move(on_err));
+    std::this_thread::sleep_for(100ms);
+
+    {
+        segment_tls_client idle(test_port);
+        ASSERT_TRUE(idle.handshake());
+        std::this_thread::sleep_for(50ms);
+        idle.reset();
+    }
+    {
+        segment_tls_client flood(test_port);
+        int rcvbuf = 4 * 1024;
+        setsockopt(flood.fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+        ASSERT_TRUE(flood.handshake());
+        ASSERT_TRUE(flood.write("flood"));
+        std::this_thread::sleep_for(100ms);
+        flood.reset();
+    }
+    std::this_thread::sleep_for(100ms);
+
+    EXPECT_EQ(tls_round_trip(test_port, "still serving"), "still serving");
+    EXPECT_EQ(connect_count.load(), 3);
+}
+
+TEST_F(TlsEventLoopTest, UringTlsEchoWithHandshakeWorkers) {
+    if (!certs_available()) {
+        GTEST_SKIP() << "TLS certificates not available";
+    }
+
+    std::atomic<int> error_count{0};
+    auto on_connect = [](connection&) { return el_connection_state::read; };
+    auto on_read = [](connection&) { return el_connection_state::write; };
+    auto on_write = [](connection&) { return el_connection_state::read; };
+    auto on_err = [&error_count](connection&, const std::string&) {
+        error_count++;
+        return el_connection_state::die;
+    };
+
+    auto cfg = make_tls_config(test_port, cert_path(), key_path());
+    cfg.handshake_workers = 2;
+    auto guard = make_uring_tls_guard(cfg, std::move(on_connect), std::move(on_read),
+                                      std::move(on_write), std::move(on_err));
+    std::this_thread::sleep_for(100ms);
+
+    for (int i = 0; i < 3; ++i) {
+        const std::string msg = "offloaded handshake " + std::to_string(i);
+        EXPECT_EQ(tls_round_trip(test_port, msg), msg);
+    }
+    std::this_thread::sleep_for(100ms);
+    EXPECT_EQ(error_count.load(), 0);
+}
+
+TEST_F(TlsEventLoopTest, UringTlsHandshakeAndIdleTimeouts) {
+    if (!certs_available()) {
+        GTEST_SKIP() << "TLS certificates not available";
+    }
+
+    std::atomic<int> handshake_timeouts{0};
+    std::atomic<int> idle_timeouts{0};
+    auto on_connect = [](connection&) { return el_connection_state::read; };
+    auto on_read = [](connection&) { return el_connection_state::write; };
+    auto on_write = [](connection&) { return el_connection_state::read; };
+    auto on_err = [&](connection&, const std::string& msg) {
+        if (msg.find("handshake timeout") != std::string::npos) handshake_timeouts++;
+        if (msg.find("idle timeout") != std::string::npos) idle_timeouts++;
+        return el_connection_state::die;
+    };
+
+    auto cfg = make_tls_config(test_port, cert_path(), key_path());
+    cfg.handshake_timeout_ms = 300;
+    cfg.idle_timeout_ms = 400;
+    auto guard = make_uring_tls_guard(cfg, std::move(on_connect), std::move(on_read),
+                                      std::move(on_write), std::move(on_err));
+    std::this_thread::sleep_for(100ms);
+
+    hope::io::tcp_stream slow;
+    slow.connect("127.0.0.1", test_port);
+    const uint8_t record_header[] = { 0x16, 0x03, 0x01 }; // handshake record, never completed
+    for (auto byte : record_header) {
+        slow.write(&byte, 1);
+        std::this_thread::sleep_for(80ms);
+    }
+
+    // Traffic keeps an established connection alive past the idle timeout
+    segment_tls_client client(test_port);
+    ASSERT_TRUE(client.handshake());
+    for (int i = 0; i < 4; ++i) {
+        std::this_thread::sleep_for(200ms);
+        ASSERT_TRUE(client.write("ping"));
+        EXPECT_EQ(client.read(4), "ping");
+    }
+    EXPECT_EQ(handshake_timeouts.load(), 1);
+    EXPECT_EQ(idle_timeouts.load(), 0);
+
+    const auto deadline = std::chrono::steady_clock::now() + 2s;
+    while (idle_timeouts.load() == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(20ms);
+    }
+    EXPECT_EQ(idle_timeouts.load(), 1);
+    EXPECT_EQ(client.read(1), ""); // closed by the server
+}
+
+// An application that keeps asking for more without draining fails the connection once
+// the buffer is at its largest, instead of stalling it or queueing ciphertext without bound
+TEST_F(TlsEventLoopTest, UringTlsReadBufferFullFailsConnection) {
+    if (!certs_available()) {
+        GTEST_SKIP() << "TLS certificates not available";
+    }
+
+    std::atomic<int> full_count{0};
+    auto on_connect = [](connection&) { return el_connection_state::read; };
+    auto on_read = [](connection&) { return el_connection_state::read; };
+    auto on_write = [](connection&) { return el_connection_state::read; };
+    auto on_err = [&full_count](connection&, const std::string& msg) {
+        if (msg.find("buffer full") != std::string::npos) full_count++;
+        return el_connection_state::die;
+    };
+
+    auto cfg = make_tls_config(test_port, cert_path(), key_path());
+    auto guard = make_uring_tls_guard(cfg, std::move(on_connect), std::move(on_read),
+                                      std::move(on_write), std::move(on_err));
+    std::this_thread::sleep_for(100ms);
+
+    segment_tls_client client(test_port);
+    ASSERT_TRUE(client.handshake());
+    const std::string block(16 * 1024, 'b');
+    for (std::size_t sent = 0; sent < tiered_buffer::max_capacity + block.size() && client.write(block); sent += block.size()) {}
+
+    const auto deadline = std::chrono::steady_clock::now() + 2s;
+    while (full_count.load() == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(20ms);
+    }
+    EXPECT_EQ(full_count.load(), 1);
+}
+
+#endif
+
+#endif
+
 #endif